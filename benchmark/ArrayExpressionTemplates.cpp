@@ -9,6 +9,7 @@
 // 2. Using clad arrays but creating temporaries manually.
 // 3. Using loops on clad arrays.
 // 4. Using loops on native arrays.
+// The expression evaluation itself is also compared with and without SIMD.
 
 // Benchmark expression templates.
 static void BM_ExpressionTemplates(benchmark::State& state) {
@@ -100,5 +101,69 @@ static void BM_LoopsOnNativeArrays(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopsOnNativeArrays);
 
+// Benchmark materializing the expression with the packet-at-a-time (SIMD)
+// evaluation used by clad::array against the element by element evaluation,
+// for a varying number of elements.
+template <bool UseSIMD>
+static void BM_ExpressionEvaluation(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  clad::array<double> x(n);
+  clad::array<double> y(n);
+  clad::array<double> z(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = i + 1;
+    y[i] = i + 2;
+    z[i] = i + 3;
+  }
+
+  clad::array<double> res(n);
+  for (auto _ : state) {
+    if (UseSIMD)
+      clad::simd::evaluate<clad::simd::AssignOp>(res.ptr(),
+                                                 x * y + y * z + z * x, n);
+    else
+      clad::simd::evaluate_scalar<clad::simd::AssignOp>(
+          res.ptr(), x * y + y * z + z * x, n);
+    benchmark::DoNotOptimize(res.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_TEMPLATE(BM_ExpressionEvaluation, false)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Name("BM_ExpressionEvaluation_Scalar");
+BENCHMARK_TEMPLATE(BM_ExpressionEvaluation, true)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Name("BM_ExpressionEvaluation_SIMD");
+
+// Benchmark compound assignment of an expression, as in the accumulation of
+// derivatives in vector mode.
+template <bool UseSIMD>
+static void BM_ExpressionCompoundAssign(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  clad::array<double> x(n, 1.0);
+  clad::array<double> y(n, 2.0);
+
+  clad::array<double> res(n);
+  for (auto _ : state) {
+    if (UseSIMD)
+      clad::simd::evaluate<clad::BinaryAdd>(res.ptr(), x * 0.5 + y / 3.0, n);
+    else
+      clad::simd::evaluate_scalar<clad::BinaryAdd>(res.ptr(),
+                                                   x * 0.5 + y / 3.0, n);
+    benchmark::DoNotOptimize(res.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_TEMPLATE(BM_ExpressionCompoundAssign, false)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Name("BM_ExpressionCompoundAssign_Scalar");
+BENCHMARK_TEMPLATE(BM_ExpressionCompoundAssign, true)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15)
+    ->Name("BM_ExpressionCompoundAssign_SIMD");
+
 // Define our main.
 BENCHMARK_MAIN();
\ No newline at end of file
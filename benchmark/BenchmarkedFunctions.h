@@ -46,4 +46,99 @@ inline double weightedSum(const double p[], const double w[], int n) {
   for (int i = 0; i < n; i++)
     sum += p[i] * w[i];
   return sum;
-}
\ No newline at end of file
+}
+///\returns a cubic polynomial coupling each of the 8 parameters with its
+/// neighbours, which has a dense hessian.
+inline double coupledCubic(double x0, double x1, double x2, double x3,
+                           double x4, double x5, double x6, double x7) {
+  return x0 * x0 * x1 + x1 * x1 * x2 + x2 * x2 * x3 + x3 * x3 * x4 +
+         x4 * x4 * x5 + x5 * x5 * x6 + x6 * x6 * x7 + x7 * x7 * x0 +
+         x0 * x2 * x4 * x6 + x1 * x3 * x5 * x7;
+}
+
+///\returns the chained Rosenbrock function of the \p n elements in \p x, whose
+/// hessian is tridiagonal.
+inline double chainedRosenbrock(const double* x, int n) {
+  double r = 0;
+  for (int i = 0; i < n - 1; i++) {
+    double a = x[i + 1] - x[i] * x[i];
+    double b = 1 - x[i];
+    r += 100 * a * a + b * b;
+  }
+  return r;
+}
+
+///\returns the sum of the squares of the elements in \p arr, which are
+/// overwritten by their squares.
+inline double squareInPlace(double* arr, int n) {
+  double sum = 0;
+  for (int i = 0; i < n; i++) {
+    arr[i] *= arr[i];
+    sum += arr[i];
+  }
+  return sum;
+}
+
+///\returns the sum of the elements in \p arr squared and raised to the fourth
+/// power in place by nested calls. The gradient of the function stores the
+/// elements in a clad::restore_tracker before each call.
+inline double nestedSquareInPlace(double* arr, int n) {
+  double res = 0;
+  res += squareInPlace(arr, n);
+  res += squareInPlace(arr, n);
+  return res;
+}
+
+///\returns the position of a damped oscillator with stiffness \p k, released
+/// at \p x, after \p n explicit Euler steps. The state of every step depends
+/// on the previous one, thus the steps cannot be recomputed independently.
+inline double timeStepping(double x, double k, int n) {
+  double u = x;
+  double v = 0;
+  for (int i = 0; i < n; ++i) {
+    double a = -k * u - 0.1 * v;
+    u += 0.01 * v;
+    v += 0.01 * a;
+  }
+  return u;
+}
+
+/// Same as timeStepping, but its gradient recomputes each step from the
+/// initial state instead of storing the intermediate values.
+inline double timeSteppingRecompute(double x, double k, int n) {
+  double u = x;
+  double v = 0;
+#pragma clad checkpoint loop snapshots(1)
+  for (int i = 0; i < n; ++i) {
+    double a = -k * u - 0.1 * v;
+    u += 0.01 * v;
+    v += 0.01 * a;
+  }
+  return u;
+}
+
+/// Same as timeStepping, but its gradient stores at most 64 states of the loop
+/// and recomputes the steps in between them (binomial checkpointing).
+inline double timeSteppingRevolve(double x, double k, int n) {
+  double u = x;
+  double v = 0;
+#pragma clad checkpoint loop snapshots(64)
+  for (int i = 0; i < n; ++i) {
+    double a = -k * u - 0.1 * v;
+    u += 0.01 * v;
+    v += 0.01 * a;
+  }
+  return u;
+}
+
+/// A loss summed over samples by an OpenMP parallel loop. Its gradient runs
+/// the reverse pass of the loop in parallel too.
+inline double parallelLoss(const double* x, const double* y, double w, int n) {
+  double loss = 0;
+#pragma omp parallel for reduction(+ : loss)
+  for (int i = 0; i < n; ++i) {
+    double r = w * x[i] - y[i];
+    loss += r * r;
+  }
+  return loss;
+}
@@ -43,5 +43,104 @@ static void BM_HessianDiagonalComputation(benchmark::State& state) {
 }
 BENCHMARK(BM_HessianDiagonalComputation);
 
+// Benchmark the hessian of a function of 8 scalar parameters computed with one
+// second derivative per parameter.
+static void BM_HessianPerParameter(benchmark::State& state) {
+  auto hess = clad::hessian(coupledCubic);
+  double hessianMatrix[64] = {};
+  for (auto _ : state) {
+    hess.execute(1, 2, 3, 4, 5, 6, 7, 8, hessianMatrix);
+    benchmark::DoNotOptimize(hessianMatrix);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_HessianPerParameter);
+
+// Benchmark the same hessian computed with a single vector forward mode pass
+// over the gradient.
+static void BM_HessianVectorMode(benchmark::State& state) {
+  auto hess = clad::hessian<clad::opts::vector_mode>(coupledCubic);
+  double hessianMatrix[64] = {};
+  for (auto _ : state) {
+    hess.execute(1, 2, 3, 4, 5, 6, 7, 8, hessianMatrix);
+    benchmark::DoNotOptimize(hessianMatrix);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_HessianVectorMode);
+
+// Benchmark the product of the hessian with a vector, computed by forming the
+// dense hessian and multiplying it with the vector.
+static void BM_DenseHessianTimesVector(benchmark::State& state) {
+  auto hess = clad::hessian(coupledCubic);
+  double v[8] = {1, -1, 2, -2, 3, -3, 4, -4};
+  double hessianMatrix[64] = {};
+  double hvp[8] = {};
+  for (auto _ : state) {
+    // The hessian accumulates into its output.
+    for (double& h : hessianMatrix)
+      h = 0;
+    hess.execute(1, 2, 3, 4, 5, 6, 7, 8, hessianMatrix);
+    for (int i = 0; i < 8; i++) {
+      hvp[i] = 0;
+      for (int j = 0; j < 8; j++)
+        hvp[i] += hessianMatrix[i * 8 + j] * v[j];
+    }
+    benchmark::DoNotOptimize(hvp);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DenseHessianTimesVector);
+
+// Benchmark the same product computed directly with a single forward mode pass
+// over the gradient, without forming the hessian.
+static void BM_HessianVectorProduct(benchmark::State& state) {
+  auto hvp_fn = clad::hessian_vector_product(coupledCubic);
+  double v[8] = {1, -1, 2, -2, 3, -3, 4, -4};
+  double hvp[8] = {};
+  for (auto _ : state) {
+    hvp_fn.execute(1, 2, 3, 4, 5, 6, 7, 8, v, hvp);
+    benchmark::DoNotOptimize(hvp);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_HessianVectorProduct);
+
+// Benchmark the dense hessian of a function with a tridiagonal hessian.
+static void BM_DenseHessianChain(benchmark::State& state) {
+  auto hess = clad::hessian(chainedRosenbrock, "x[0:31]");
+  double x[32];
+  for (int i = 0; i < 32; i++)
+    x[i] = 1 + 0.1 * i;
+  double hessianMatrix[32 * 32] = {};
+  for (auto _ : state) {
+    // The hessian accumulates into its output.
+    for (double& h : hessianMatrix)
+      h = 0;
+    hess.execute(x, 32, hessianMatrix);
+    benchmark::DoNotOptimize(hessianMatrix);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DenseHessianChain);
+
+// Benchmark the same hessian computed in the compressed sparse row format. The
+// sparsity pattern is traced at the first call, then each call costs one
+// hessian vector product per color of the star coloring, 3 for a tridiagonal
+// hessian.
+static void BM_SparseHessianChain(benchmark::State& state) {
+  auto hess = clad::sparse_hessian(chainedRosenbrock, "x");
+  double x[32];
+  for (int i = 0; i < 32; i++)
+    x[i] = 1 + 0.1 * i;
+  clad::csr_matrix<double> hessianMatrix(32, 32);
+  for (auto _ : state) {
+    hess.execute(x, 32, &hessianMatrix);
+    benchmark::DoNotOptimize(hessianMatrix);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_SparseHessianChain);
+
 // Define our main.
 BENCHMARK_MAIN();
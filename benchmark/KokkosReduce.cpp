@@ -0,0 +1,78 @@
+#include "benchmark/benchmark.h"
+
+#include <Kokkos_Core.hpp>
+
+#include "clad/Differentiator/Differentiator.h"
+#include "clad/Differentiator/KokkosBuiltins.h"
+
+// The energy of a cell, summed over the cells by Kokkos::parallel_reduce.
+template <typename View> struct CellEnergy {
+  View c;
+
+  CellEnergy(View _c) : c(_c) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int& i, double& energy) const {
+    energy += c(i) * c(i) * c(i);
+  }
+};
+
+double kokkosEnergy(double x, int n) {
+  Kokkos::View<double*, Kokkos::HostSpace> c("c", n);
+  Kokkos::deep_copy(c, x);
+
+  CellEnergy<Kokkos::View<double*, Kokkos::HostSpace>> f(c);
+  double r = 0;
+
+  f(0, r); // FIXME: this is a workaround to put CellEnergy::operator() into
+           // the differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_reduce(
+      "energy", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, n),
+      f, r);
+
+  return r;
+}
+
+// The reduction on the default host execution space, e.g. the OpenMP or the
+// Serial backend.
+static void BM_KokkosReduce(benchmark::State& state) {
+  int n = state.range(0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(kokkosEnergy(2, n));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["threads"] =
+      Kokkos::DefaultHostExecutionSpace().concurrency();
+}
+BENCHMARK(BM_KokkosReduce)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 20)
+    ->UseRealTime();
+
+// Its gradient, whose adjoint loop is a parallel_for over the same policy.
+static void BM_KokkosReduceGradient(benchmark::State& state) {
+  int n = state.range(0);
+  auto grad = clad::gradient(kokkosEnergy, "x");
+  for (auto _ : state) {
+    double dx = 0;
+    grad.execute(2, n, &dx);
+    benchmark::DoNotOptimize(dx);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["threads"] =
+      Kokkos::DefaultHostExecutionSpace().concurrency();
+}
+BENCHMARK(BM_KokkosReduceGradient)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 20)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+  Kokkos::ScopeGuard kokkos(argc, argv);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
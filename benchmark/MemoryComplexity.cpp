@@ -2,6 +2,10 @@
 
 #include "clad/Differentiator/Differentiator.h"
 
+#include <numeric>
+#include <thread>
+#include <vector>
+
 namespace {
   struct MemoryManager : public benchmark::MemoryManager {
     size_t cur_num_allocs = 0;
@@ -98,6 +102,125 @@ static void BM_TapeMemory_Templated(benchmark::State& state) {
 REGISTER_TAPE_BENCHMARK(64, 1024);
 REGISTER_TAPE_BENCHMARK(32, 512);
 
+// Accesses every element of the tape through operator[] in a scattered order.
+static void BM_TapeRandomAccess(benchmark::State& state) {
+  std::size_t n = state.range(0);
+  clad::tape<double> t;
+  for (std::size_t i = 0; i < n; i++)
+    clad::push<double>(t, i);
+  // Stepping by a stride coprime with n visits every index exactly once.
+  std::size_t stride = 7919;
+  while (n && std::gcd(stride, n) != 1)
+    stride++;
+  for (auto _ : state) {
+    std::size_t idx = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      benchmark::DoNotOptimize(t[idx]);
+      idx = (idx + stride) % n;
+    }
+  }
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_TapeRandomAccess)
+    ->RangeMultiplier(4)
+    ->Range(1024, 1 << 20)
+    ->Complexity(benchmark::oN);
+
+// Iterates over the whole tape using tape_iterator.
+static void BM_TapeIteration(benchmark::State& state) {
+  std::size_t n = state.range(0);
+  clad::tape<double> t;
+  for (std::size_t i = 0; i < n; i++)
+    clad::push<double>(t, i);
+  for (auto _ : state) {
+    double sum = 0;
+    for (double v : t)
+      sum += v;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_TapeIteration)
+    ->RangeMultiplier(4)
+    ->Range(1024, 1 << 20)
+    ->Complexity(benchmark::oN);
+
+// Measures the allocations of repeatedly creating and destroying tapes which
+// outgrow the small buffer, as generated gradients called in a loop do.
+// ColdAllocN is the allocation count of the first tape of a thread, AllocN the
+// count once the thread's slab pool has been populated.
+static void BM_TapeSlabReuse(benchmark::State& state) {
+  int n = state.range(0);
+  std::size_t cold_allocs = 0;
+  std::thread([&]() {
+    mm->cur_num_allocs = 0;
+    {
+      clad::tape<double> t;
+      func<double>(t, 1, n);
+    }
+    cold_allocs = mm->cur_num_allocs;
+  }).join();
+  AddBMCounterRAII MemCounters(*mm.get(), state);
+  for (auto _ : state) {
+    clad::tape<double> t;
+    func<double>(t, 1, n);
+  }
+  state.counters["ColdAllocN"] = cold_allocs;
+}
+BENCHMARK(BM_TapeSlabReuse)->RangeMultiplier(4)->Range(1024, 1 << 16);
+
+/// \returns the number of bytes used to store the elements of the tape.
+template <std::size_t SBO_SIZE, std::size_t SLAB_SIZE>
+static std::size_t
+tapeBytes(const clad::tape_impl<double, SBO_SIZE, SLAB_SIZE>& t) {
+  std::size_t slabs = t.size() > SBO_SIZE
+                          ? (t.size() - SBO_SIZE + SLAB_SIZE - 1) / SLAB_SIZE
+                          : 0;
+  return (SBO_SIZE + slabs * SLAB_SIZE) * sizeof(double);
+}
+static std::size_t tapeBytes(const clad::compressed_tape_impl<double>& t) {
+  return t.memory_usage();
+}
+
+/// Fills \p values with the states of a damped oscillator, which change
+/// slowly between the steps, or with the indices of the steps.
+static void tapeValues(std::vector<double>& values, bool oscillator) {
+  double u = 1;
+  double v = 0;
+  for (std::size_t i = 0; i < values.size(); i++) {
+    double a = -4 * u - 0.1 * v;
+    u += 0.01 * v;
+    v += 0.01 * a;
+    values[i] = oscillator ? u : i;
+  }
+}
+
+// Pushes and pops the values of a loop and reports the bytes per element.
+template <typename Tape>
+static void BM_TapeBytesPerElement(benchmark::State& state) {
+  std::vector<double> values(state.range(0));
+  tapeValues(values, state.range(1));
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    Tape t;
+    for (double v : values)
+      t.emplace_back(v);
+    bytes = tapeBytes(t);
+    for (std::size_t i = 0; i < values.size(); i++) {
+      benchmark::DoNotOptimize(t.back());
+      t.pop_back();
+    }
+  }
+  state.counters["BytesPerElement"] = double(bytes) / values.size();
+  state.SetBytesProcessed(state.iterations() * values.size() * sizeof(double));
+}
+BENCHMARK_TEMPLATE(BM_TapeBytesPerElement, clad::tape_impl<double>)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {0, 1}})
+    ->ArgNames({"n", "oscillator"});
+BENCHMARK_TEMPLATE(BM_TapeBytesPerElement, clad::compressed_tape_impl<double>)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {0, 1}})
+    ->ArgNames({"n", "oscillator"});
+
 #include "BenchmarkedFunctions.h"
 
 static void BM_ReverseGausMemoryP(benchmark::State& state) {
@@ -118,5 +241,73 @@ static void BM_ReverseGausMemoryP(benchmark::State& state) {
 }
 BENCHMARK(BM_ReverseGausMemoryP)->RangeMultiplier(2)->Range(0, 4096);
 
+// Measures the gradient of nested calls modifying an array, where each call
+// stores the elements it overwrites in a clad::restore_tracker.
+static void BM_ReverseNestedRestoreTracker(benchmark::State& state) {
+  auto grad = clad::gradient(nestedSquareInPlace, "arr");
+  int n = state.range(0);
+  std::vector<double> arr(n);
+  std::vector<double> d_arr(n);
+  AddBMCounterRAII MemCounters(*mm.get(), state);
+  for (auto _ : state) {
+    for (int i = 0; i < n; i++) {
+      arr[i] = 1 + 1.0 / (i + 1);
+      d_arr[i] = 0;
+    }
+    grad.execute(arr.data(), n, d_arr.data());
+    benchmark::DoNotOptimize(d_arr.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetComplexityN(n);
+}
+BENCHMARK(BM_ReverseNestedRestoreTracker)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Complexity(benchmark::oN);
+
+// Compares the gradients of a long time-stepping loop which store all the
+// steps on tapes, recompute each step from the initial state, and store a
+// fixed number of snapshots with binomial checkpointing.
+template <typename Gradient>
+static void runTimeStepping(Gradient& grad, benchmark::State& state) {
+  int n = state.range(0);
+  AddBMCounterRAII MemCounters(*mm.get(), state);
+  for (auto _ : state) {
+    double d_x = 0;
+    double d_k = 0;
+    grad.execute(1, 4, n, &d_x, &d_k);
+    benchmark::DoNotOptimize(d_x);
+    benchmark::DoNotOptimize(d_k);
+  }
+  state.SetComplexityN(n);
+}
+
+static void BM_ReverseTimeSteppingTape(benchmark::State& state) {
+  auto grad = clad::gradient(timeStepping, "x, k");
+  runTimeStepping(grad, state);
+}
+BENCHMARK(BM_ReverseTimeSteppingTape)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 16)
+    ->Complexity(benchmark::oN);
+
+static void BM_ReverseTimeSteppingRecompute(benchmark::State& state) {
+  auto grad = clad::gradient(timeSteppingRecompute, "x, k");
+  runTimeStepping(grad, state);
+}
+BENCHMARK(BM_ReverseTimeSteppingRecompute)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 12)
+    ->Complexity(benchmark::oNSquared);
+
+static void BM_ReverseTimeSteppingRevolve(benchmark::State& state) {
+  auto grad = clad::gradient(timeSteppingRevolve, "x, k");
+  runTimeStepping(grad, state);
+}
+BENCHMARK(BM_ReverseTimeSteppingRevolve)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 16)
+    ->Complexity(benchmark::oNLogN);
+
 // Define our main.
 BENCHMARK_MAIN();
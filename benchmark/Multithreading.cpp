@@ -2,11 +2,17 @@
 
 #include "clad/Differentiator/Differentiator.h"
 
+#include "BenchmarkedFunctions.h"
+
 #include <cstddef>
 #include <cstdio>
 #include <thread>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // Benchmarking overhead of locking in a single threaded environment
 template <bool ThreadSafe>
 static void BM_TapeLockOverhead(benchmark::State& state) {
@@ -33,42 +39,145 @@ BENCHMARK_TEMPLATE(BM_TapeLockOverhead, true)
     ->Range(0, 4096)
     ->Name("BM_TapeLockOverhead_Lock");
 
-template <typename T>
+template <typename TapeT, typename T>
 void concurrent_push(T x, size_t n_threads, size_t pushes_per_thread) {
-  clad::tape<T, 64, 1024, true> t = {};
+  TapeT t;
   std::vector<std::thread> threads;
 
   for (size_t i = 0; i < n_threads; ++i) {
     threads.emplace_back([&]() {
       for (size_t j = 0; j < pushes_per_thread; ++j)
         clad::push<T>(t, x);
+      for (size_t j = 0; j < pushes_per_thread; ++j)
+        benchmark::DoNotOptimize(clad::pop<T>(t));
     });
   }
 
   for (auto& thread : threads)
     thread.join();
 
-  size_t expected = n_threads * pushes_per_thread;
-  size_t actual = t.size();
-  if (expected != actual)
-    printf("error: expected size %zu, actual size %zu\n", expected, actual);
+  if (t.size())
+    printf("error: expected empty tape, actual size %zu\n", t.size());
 }
 
 // Benchmarking and testing thread safety with different configurations in
 // multithreaded environment
+template <typename TapeT>
 static void BM_TapeThreadSafety(benchmark::State& state) {
   size_t n_threads = state.range(0);
   size_t pushes_per_thread = state.range(1);
   for (auto _ : state)
-    concurrent_push<double>(/*x=*/1.0, /*n_threads=*/n_threads,
-                            /*pushes_per_thread=*/pushes_per_thread);
+    concurrent_push<TapeT>(/*x=*/1.0, /*n_threads=*/n_threads,
+                           /*pushes_per_thread=*/pushes_per_thread);
+}
+
+// A single tape shared by all threads, guarded by a mutex.
+BENCHMARK_TEMPLATE(BM_TapeThreadSafety, clad::tape<double, 64, 1024, true>)
+    ->ArgsProduct({benchmark::CreateRange(1, 64, /*multi=*/2), {1000, 100000}})
+    ->UseRealTime()
+    ->Name("BM_TapeThreadSafety_Lock");
+
+// A lock-free tape with a separate shard per thread.
+BENCHMARK_TEMPLATE(BM_TapeThreadSafety, clad::sharded_tape<double>)
+    ->ArgsProduct({benchmark::CreateRange(1, 64, /*multi=*/2), {1000, 100000}})
+    ->UseRealTime()
+    ->Name("BM_TapeThreadSafety_Sharded");
+
+// Two sharded tapes used alternately by every thread, like the tapes _t0 and
+// _t1 of a loop storing two values per iteration.
+static void BM_ShardedTapeInterleaved(benchmark::State& state) {
+  std::size_t n_threads = state.range(0);
+  std::size_t pushes_per_thread = state.range(1);
+  for (auto _ : state) {
+    clad::sharded_tape<double> t0;
+    clad::sharded_tape<double> t1;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < n_threads; ++i) {
+      threads.emplace_back([&]() {
+        for (std::size_t j = 0; j < pushes_per_thread; ++j) {
+          clad::push<double>(t0, 1.0);
+          clad::push<double>(t1, 2.0);
+        }
+        for (std::size_t j = 0; j < pushes_per_thread; ++j) {
+          benchmark::DoNotOptimize(clad::pop<double>(t1));
+          benchmark::DoNotOptimize(clad::pop<double>(t0));
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+}
+BENCHMARK(BM_ShardedTapeInterleaved)
+    ->ArgsProduct({benchmark::CreateRange(1, 64, /*multi=*/2), {1000, 100000}})
+    ->UseRealTime();
+
+// The gradient of a Gaussian for every sample of a batch, each sample having
+// its own means and adjoints, executed by a user-written loop.
+static void BM_BatchGradientLoop(benchmark::State& state) {
+  std::size_t n = state.range(0);
+  const int dim = 4;
+  auto grad = clad::gradient(gaus, "p, sigma");
+  std::vector<double> x(n * dim, 1), p(n * dim, 0.5), dp(n * dim), dsigma(n);
+  double sigma = 2;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; i++)
+      grad.execute(&x[i * dim], &p[i * dim], sigma, dim, &dp[i * dim],
+                   &dsigma[i]);
+    benchmark::DoNotOptimize(dp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BatchGradientLoop)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 19)
+    ->UseRealTime();
+
+// The same batch executed by CladFunction::execute_batch on the global thread
+// pool.
+static void BM_BatchGradientExecuteBatch(benchmark::State& state) {
+  std::size_t n = state.range(0);
+  const int dim = 4;
+  auto grad = clad::gradient(gaus, "p, sigma");
+  std::vector<double> x(n * dim, 1), p(n * dim, 0.5), dp(n * dim), dsigma(n);
+  double sigma = 2;
+  for (auto _ : state) {
+    grad.execute_batch(n, clad::batched(x.data(), dim),
+                       clad::batched(p.data(), dim), sigma, dim,
+                       clad::batched(dp.data(), dim),
+                       clad::batched(dsigma.data()));
+    benchmark::DoNotOptimize(dp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["threads"] = clad::thread_pool::global().size();
 }
+BENCHMARK(BM_BatchGradientExecuteBatch)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 19)
+    ->UseRealTime();
 
-BENCHMARK(BM_TapeThreadSafety)
-    ->Args({1, 1000})
-    ->Args({4, 1000})
-    ->Args({8, 1000})
-    ->Args({8, 1000})
-    ->Args({16, 1000});
+#ifdef _OPENMP
+// The gradient of a loss summed by `omp parallel for`, whose reverse pass is
+// a parallel loop too, run by an increasing number of threads.
+static void BM_OpenMPParallelForGradient(benchmark::State& state) {
+  int n = state.range(0);
+  int threads = state.range(1);
+  std::vector<double> x(n, 1), y(n, 2), dx(n);
+  double w = 0.5;
+  auto grad = clad::gradient(parallelLoss, "x, w");
+  int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+  for (auto _ : state) {
+    double dw = 0;
+    grad.execute(x.data(), y.data(), w, n, dx.data(), &dw);
+    benchmark::DoNotOptimize(dw);
+  }
+  omp_set_num_threads(maxThreads);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OpenMPParallelForGradient)
+    ->ArgsProduct({{1 << 16, 1 << 20}, benchmark::CreateRange(1, 16, 2)})
+    ->UseRealTime();
+#endif
 
 BENCHMARK_MAIN();
\ No newline at end of file
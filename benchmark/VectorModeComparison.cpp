@@ -96,5 +96,106 @@ static void BM_VectorForwardModeWeightedSum(benchmark::State& state) {
 }
 BENCHMARK(BM_VectorForwardModeWeightedSum);
 
+// A function of several scalar parameters, for which the number of directions
+// of vector forward mode is known at compile time.
+static double scalarProducts(double x, double y, double z, double w) {
+  double xy = x * y;
+  double zw = z * w;
+  return xy * zw + xy * x + zw * w + x * y * z;
+}
+
+// Benchmark vector forward mode with clad::array direction vectors.
+static void BM_VectorForwardModeScalarParams(benchmark::State& state) {
+  auto vm_grad = clad::differentiate<clad::opts::vector_mode>(scalarProducts);
+  double dx = 0;
+  double dy = 0;
+  double dz = 0;
+  double dw = 0;
+  double sum = 0;
+  for (auto _ : state) {
+    vm_grad.execute(1, 2, 3, 4, &dx, &dy, &dz, &dw);
+    benchmark::DoNotOptimize(sum += dx + dy + dz + dw);
+  }
+}
+BENCHMARK(BM_VectorForwardModeScalarParams);
+
+// Benchmark vector forward mode with fixed-size clad::static_array direction
+// vectors.
+static void BM_VectorForwardModeScalarParamsStatic(benchmark::State& state) {
+  auto vm_grad = clad::differentiate<clad::opts::vector_mode,
+                                     clad::opts::static_directions>(
+      scalarProducts);
+  double dx = 0;
+  double dy = 0;
+  double dz = 0;
+  double dw = 0;
+  double sum = 0;
+  for (auto _ : state) {
+    vm_grad.execute(1, 2, 3, 4, &dx, &dy, &dz, &dw);
+    benchmark::DoNotOptimize(sum += dx + dy + dz + dw);
+  }
+}
+BENCHMARK(BM_VectorForwardModeScalarParamsStatic);
+
+// Benchmark the clad::array temporaries created by vector forward mode code,
+// written in the same shape as the generated derivative of
+// `temp1 = x * y; temp2 = x + y + 1; return temp1 * temp2;`. Direction
+// vectors which fit in the small buffer of clad::array need no allocation.
+static void BM_VectorModeArrayTemporaries(benchmark::State& state) {
+  std::size_t indepVarCount = state.range(0);
+  double x = 3;
+  double y = 4;
+  double sum = 0;
+  for (auto _ : state) {
+    clad::array<double> _d_vector_x =
+        clad::one_hot_vector<double>(indepVarCount, 0);
+    clad::array<double> _d_vector_y =
+        clad::one_hot_vector<double>(indepVarCount, 1);
+    clad::array<double> _d_vector_temp1(_d_vector_x * y + x * _d_vector_y);
+    double temp1 = x * y;
+    clad::array<double> _d_vector_temp2(
+        _d_vector_x + _d_vector_y +
+        clad::zero_vector<double>(indepVarCount));
+    double temp2 = x + y + 1;
+    clad::array<double> _d_vector_return(_d_vector_temp1 * temp2 +
+                                         temp1 * _d_vector_temp2);
+    _d_vector_x = std::move(_d_vector_return);
+    benchmark::DoNotOptimize(sum += _d_vector_x[0] + _d_vector_x[1]);
+  }
+}
+BENCHMARK(BM_VectorModeArrayTemporaries)->RangeMultiplier(2)->Range(2, 64);
+
+// Benchmark the same code written with the fixed-size direction vectors of
+// clad::differentiate<vector_mode, static_directions>, which live on the stack
+// regardless of the number of directions.
+template <std::size_t N>
+static void BM_VectorModeStaticArrayTemporaries(benchmark::State& state) {
+  double x = 3;
+  double y = 4;
+  double sum = 0;
+  for (auto _ : state) {
+    clad::static_array<double, N> _d_vector_x =
+        clad::static_one_hot_vector<double, N>(0);
+    clad::static_array<double, N> _d_vector_y =
+        clad::static_one_hot_vector<double, N>(1);
+    clad::static_array<double, N> _d_vector_temp1(_d_vector_x * y +
+                                                  x * _d_vector_y);
+    double temp1 = x * y;
+    clad::static_array<double, N> _d_vector_temp2(
+        _d_vector_x + _d_vector_y + clad::static_zero_vector<double, N>());
+    double temp2 = x + y + 1;
+    clad::static_array<double, N> _d_vector_return(_d_vector_temp1 * temp2 +
+                                                   temp1 * _d_vector_temp2);
+    _d_vector_x = _d_vector_return;
+    benchmark::DoNotOptimize(sum += _d_vector_x[0] + _d_vector_x[1]);
+  }
+}
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 2);
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 4);
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 8);
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 16);
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 32);
+BENCHMARK_TEMPLATE(BM_VectorModeStaticArrayTemporaries, 64);
+
 // Define our main.
 BENCHMARK_MAIN();
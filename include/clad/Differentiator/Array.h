@@ -2,11 +2,14 @@
 #define CLAD_ARRAY_H
 
 #include "clad/Differentiator/ArrayExpression.h"
+#include "clad/Differentiator/ArrayExpressionSIMD.h"
 #include "clad/Differentiator/CladConfig.h"
 
 #include <assert.h>
+#include <cstddef>
 #include <initializer_list>
 #include <type_traits>
+#include <utility>
 
 namespace clad {
 template <typename T> class array_ref;
@@ -18,47 +21,121 @@ template <typename T> class array_ref;
 #define PUREFUNC __attribute__((pure))
 #endif
 
+#ifndef CLAD_ARRAY_SBO_BYTES
+/// The size in bytes of the inline buffer which clad::array of arithmetic
+/// types uses instead of a heap allocation for short arrays, such as the
+/// direction vectors of vector forward mode with few independent variables.
+#define CLAD_ARRAY_SBO_BYTES 64
+#endif
+
+namespace detail {
+/// Inline storage of N elements used by clad::array for short arrays.
+template <typename T, std::size_t N> struct array_small_buffer {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+  T m_data[N];
+  CUDA_HOST_DEVICE T* data() { return m_data; }
+  CUDA_HOST_DEVICE const T* data() const { return m_data; }
+};
+template <typename T> struct array_small_buffer<T, 0> {
+  CUDA_HOST_DEVICE T* data() { return nullptr; }
+  CUDA_HOST_DEVICE const T* data() const { return nullptr; }
+};
+} // namespace detail
+
 /// This class is not meant to be used by user. It is used by clad internally
 /// only
 
 // NOLINTBEGIN(*-pointer-arithmetic)
 template <typename T> class array {
+  /// The number of elements stored inline. Only arithmetic types use the small
+  /// buffer, since the buffer elements are never constructed or destroyed.
+  static constexpr std::size_t SBO_SIZE =
+      std::is_arithmetic<T>::value ? CLAD_ARRAY_SBO_BYTES / sizeof(T) : 0;
+
 private:
   /// The pointer to the underlying array
   T* m_arr = nullptr;
   /// The size of the array
   std::size_t m_size = 0;
+  /// Inline storage for arrays with at most SBO_SIZE elements.
+  detail::array_small_buffer<T, SBO_SIZE> m_sbo;
+
+  /// Returns storage for size elements, the small buffer if they fit in it.
+  CUDA_HOST_DEVICE T* allocate(std::size_t size) {
+    if (SBO_SIZE && size <= SBO_SIZE)
+      return m_sbo.data();
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    return new T[size];
+  }
+
+  /// Returns zero-initialized storage for size elements.
+  CUDA_HOST_DEVICE T* allocate_zeroed(std::size_t size) {
+    if (SBO_SIZE && size <= SBO_SIZE) {
+      T* data = m_sbo.data();
+      for (std::size_t i = 0; i < size; ++i)
+        data[i] = static_cast<T>(0);
+      return data;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    return new T[size]{static_cast<T>(0)};
+  }
+
+  CUDA_HOST_DEVICE void deallocate() {
+    if (!is_small())
+      delete[] m_arr;
+  }
+
+  CUDA_HOST_DEVICE bool is_small() const {
+    return SBO_SIZE && m_arr == m_sbo.data();
+  }
+
+  /// Takes over the contents of arr, leaving it empty.
+  CUDA_HOST_DEVICE void steal(array<T>& arr) {
+    m_size = arr.m_size;
+    if (arr.is_small()) {
+      m_arr = m_sbo.data();
+      for (std::size_t i = 0; i < m_size; ++i)
+        m_arr[i] = arr.m_arr[i];
+    } else {
+      m_arr = arr.m_arr;
+    }
+    arr.m_arr = nullptr;
+    arr.m_size = 0;
+  }
 
 public:
   /// Default constructor
   array() = default;
   /// Constructor to create an array of the specified size
   CUDA_HOST_DEVICE array(std::size_t size)
-      : m_arr(new T[size]{static_cast<T>(0)}), m_size(size) {}
+      : m_arr(allocate_zeroed(size)), m_size(size) {}
 
   template <typename U>
   CUDA_HOST_DEVICE array(clad::array_ref<U> arr)
-      : m_arr(new T[arr.size()]{static_cast<T>(T())}), m_size(arr.size()) {
+      : m_arr(allocate_zeroed(arr.size())), m_size(arr.size()) {
     (*this) = arr;
   }
 
   template <typename U>
   CUDA_HOST_DEVICE array(U* a, std::size_t size)
-      : m_arr(new T[size]), m_size(size) {
+      : m_arr(allocate(size)), m_size(size) {
     for (std::size_t i = 0; i < size; ++i)
       m_arr[i] = static_cast<T>(a[i]);
   }
 
   CUDA_HOST_DEVICE array(const array<T>& arr) : array(arr.m_arr, arr.m_size) {}
 
+  /// Move constructor. Takes over the heap storage of arr, if any.
+  CUDA_HOST_DEVICE array(array<T>&& arr) noexcept { steal(arr); }
+
   template <typename U>
   CUDA_HOST_DEVICE array(const array<U>& arr)
-      : m_arr(new T[arr.size()]), m_size(arr.size()) {
+      : m_arr(allocate(arr.size())), m_size(arr.size()) {
     (*this) = arr;
   }
 
   CUDA_HOST_DEVICE array(std::size_t size, const clad::array<T>& arr)
-      : m_arr(new T[size]), m_size(size) {
+      : m_arr(allocate(size)), m_size(size) {
     for (std::size_t i = 0; i < size; ++i)
       m_arr[i] = arr[i];
   }
@@ -66,28 +143,26 @@ public:
   template <typename L, typename BinaryOp, typename R>
   CUDA_HOST_DEVICE array(std::size_t size,
                          const array_expression<L, BinaryOp, R>& expression)
-      : m_arr(new T[size]), m_size(size) {
-    for (std::size_t i = 0; i < size; ++i)
-      m_arr[i] = expression[i];
+      : m_arr(allocate(size)), m_size(size) {
+    simd::evaluate<simd::AssignOp>(m_arr, expression, size);
   }
 
   template <typename L, typename BinaryOp, typename R>
   CUDA_HOST_DEVICE array(const array_expression<L, BinaryOp, R>& expression)
-      : m_arr(new T[expression.size()]), m_size(expression.size()) {
-    for (std::size_t i = 0; i < expression.size(); ++i)
-      m_arr[i] = expression[i];
+      : m_arr(allocate(expression.size())), m_size(expression.size()) {
+    simd::evaluate<simd::AssignOp>(m_arr, expression, m_size);
   }
 
   // initializing all entries using the same value
   template <typename U>
   CUDA_HOST_DEVICE array(std::size_t size, U val)
-      : m_arr(new T[size]), m_size(size) {
+      : m_arr(allocate(size)), m_size(size) {
     for (std::size_t i = 0; i < size; ++i)
       m_arr[i] = static_cast<T>(val);
   }
 
   CUDA_HOST_DEVICE array(std::initializer_list<T> arr)
-      : m_arr(new T[arr.size()]{static_cast<T>(T())}), m_size(arr.size()) {
+      : m_arr(allocate_zeroed(arr.size())), m_size(arr.size()) {
     std::size_t i = 0;
     for (const auto& e : arr)
       m_arr[i++] = e;
@@ -95,22 +170,40 @@ public:
 
   CUDA_HOST_DEVICE array<T>& operator=(const array<T>& arr) {
     if (m_size < arr.m_size) {
-      delete[] m_arr;
-      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-      m_arr = new T[arr.m_size];
+      deallocate();
+      m_arr = allocate(arr.m_size);
       m_size = arr.m_size;
     }
     (*this) = arr.m_arr;
     return *this;
   }
 
+  /// Move assignment. Takes over the heap storage of arr, if any.
+  CUDA_HOST_DEVICE array<T>& operator=(array<T>&& arr) noexcept {
+    if (this != &arr) {
+      deallocate();
+      steal(arr);
+    }
+    return *this;
+  }
+
+  /// Returns a copy of a part of the array starting at offset and having the
+  /// specified size.
   CUDA_HOST_DEVICE array<T> slice(std::size_t offset, std::size_t size) const {
     assert(offset + size <= m_size);
     return array<T>(&m_arr[offset], size);
   }
 
+  /// Returns a non-owning view of a part of the array starting at offset and
+  /// having the specified size. Modifying the view modifies the array.
+  CUDA_HOST_DEVICE array_ref<T> slice_view(std::size_t offset,
+                                           std::size_t size) {
+    assert(offset + size <= m_size);
+    return array_ref<T>(&m_arr[offset], size);
+  }
+
   /// Destructor to delete the array.
-  CUDA_HOST_DEVICE ~array() { delete[] m_arr; }
+  CUDA_HOST_DEVICE ~array() { deallocate(); }
 
   /// Returns the size of the underlying array
   CUDA_HOST_DEVICE std::size_t size() const { return m_size; }
@@ -275,8 +368,7 @@ public:
   CUDA_HOST_DEVICE array<T>&
   operator=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] = arr_exp[i];
+    simd::evaluate<simd::AssignOp>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Performs element wise division
@@ -292,8 +384,7 @@ public:
   CUDA_HOST_DEVICE array<T>&
   operator+=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] += arr_exp[i];
+    simd::evaluate<BinaryAdd>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Performs element wise subtraction with array_expression
@@ -301,8 +392,7 @@ public:
   CUDA_HOST_DEVICE array<T>&
   operator-=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] -= arr_exp[i];
+    simd::evaluate<BinarySub>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Performs element wise multiplication with array_expression
@@ -310,8 +400,7 @@ public:
   CUDA_HOST_DEVICE array<T>&
   operator*=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] *= arr_exp[i];
+    simd::evaluate<BinaryMul>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Performs element wise division with array_expression
@@ -319,8 +408,7 @@ public:
   CUDA_HOST_DEVICE array<T>&
   operator/=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] /= arr_exp[i];
+    simd::evaluate<BinaryDiv>(m_arr, arr_exp, m_size);
     return *this;
   }
 
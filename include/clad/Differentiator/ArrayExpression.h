@@ -81,6 +81,9 @@ public:
   }
 
   std::size_t size() const { return std::max(get_size(l), get_size(r)); }
+
+  const LeftExp& left() const { return l; }
+  const RightExp& right() const { return r; }
 };
 
 // A template class to determine whether a given type is array_expression, array
@@ -0,0 +1,273 @@
+#ifndef CLAD_DIFFERENTIATOR_ARRAYEXPRESSIONSIMD_H
+#define CLAD_DIFFERENTIATOR_ARRAYEXPRESSIONSIMD_H
+
+#include "clad/Differentiator/ArrayExpression.h"
+#include "clad/Differentiator/CladConfig.h"
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+// This is a helper to evaluate clad::array_expression trees several elements
+// at a time using SIMD instructions. The instruction set is chosen at compile
+// time: AVX-512, AVX or SSE2 when the target supports them, otherwise a
+// portable fixed-width implementation the compiler is free to vectorize.
+// Define CLAD_NO_SIMD to always evaluate expressions element by element.
+
+#if !defined(__CUDACC__) && !defined(CLAD_NO_SIMD)
+#define CLAD_ARRAY_SIMD 1
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__) ||           \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+#endif
+
+// NOLINTBEGIN(*-pointer-arithmetic)
+namespace clad {
+template <typename T> class array;
+template <typename T> class array_ref;
+
+namespace simd {
+
+/// Operator used to materialize an expression without a compound assignment.
+struct AssignOp {
+  template <typename T, typename U>
+  static const U& apply(const T& /*t*/, const U& u) {
+    return u;
+  }
+};
+
+/// Evaluates `dst[i] = AssignOpT::apply(dst[i], expr[i])` for every i in
+/// [0, n) element by element.
+template <typename AssignOpT, typename T, typename E>
+CUDA_HOST_DEVICE void evaluate_scalar(T* dst, const E& expr, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = AssignOpT::apply(dst[i], expr[i]);
+}
+
+#ifdef CLAD_ARRAY_SIMD
+/// A portable packet of W elements, used when no intrinsics are available.
+template <typename T, std::size_t W> struct generic_packet {
+  static constexpr std::size_t width = W;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+  T v[W];
+
+  static generic_packet load(const T* p) {
+    generic_packet r;
+    for (std::size_t i = 0; i < W; ++i)
+      r.v[i] = p[i];
+    return r;
+  }
+  static generic_packet broadcast(T x) {
+    generic_packet r;
+    for (std::size_t i = 0; i < W; ++i)
+      r.v[i] = x;
+    return r;
+  }
+  void store(T* p) const {
+    for (std::size_t i = 0; i < W; ++i)
+      p[i] = v[i];
+  }
+
+#define CLAD_GENERIC_PACKET_OP(OP)                                             \
+  friend generic_packet operator OP(const generic_packet& a,                   \
+                                    const generic_packet& b) {                 \
+    generic_packet r;                                                          \
+    for (std::size_t i = 0; i < W; ++i)                                        \
+      r.v[i] = a.v[i] OP b.v[i];                                               \
+    return r;                                                                  \
+  }
+  CLAD_GENERIC_PACKET_OP(+)
+  CLAD_GENERIC_PACKET_OP(-)
+  CLAD_GENERIC_PACKET_OP(*)
+  CLAD_GENERIC_PACKET_OP(/)
+#undef CLAD_GENERIC_PACKET_OP
+};
+
+/// Defines a packet type wrapping the intrinsic vector type VEC of W elements
+/// of type T.
+#define CLAD_INTRINSIC_PACKET(NAME, T, VEC, W, PREFIX, SUFFIX)                 \
+  struct NAME {                                                                \
+    static constexpr std::size_t width = W;                                   \
+    VEC v;                                                                     \
+    static NAME load(const T* p) { return {PREFIX##_loadu_##SUFFIX(p)}; }      \
+    static NAME broadcast(T x) { return {PREFIX##_set1_##SUFFIX(x)}; }         \
+    void store(T* p) const { PREFIX##_storeu_##SUFFIX(p, v); }                 \
+    friend NAME operator+(const NAME& a, const NAME& b) {                      \
+      return {PREFIX##_add_##SUFFIX(a.v, b.v)};                                \
+    }                                                                          \
+    friend NAME operator-(const NAME& a, const NAME& b) {                      \
+      return {PREFIX##_sub_##SUFFIX(a.v, b.v)};                                \
+    }                                                                          \
+    friend NAME operator*(const NAME& a, const NAME& b) {                      \
+      return {PREFIX##_mul_##SUFFIX(a.v, b.v)};                                \
+    }                                                                          \
+    friend NAME operator/(const NAME& a, const NAME& b) {                      \
+      return {PREFIX##_div_##SUFFIX(a.v, b.v)};                                \
+    }                                                                          \
+  };
+
+/// Maps an element type to the widest packet type supported by the target,
+/// or to void if expressions of that type are evaluated element by element.
+template <typename T> struct packet_for { using type = void; };
+
+#if defined(__AVX512F__)
+CLAD_INTRINSIC_PACKET(packet_avx512_double, double, __m512d, 8, _mm512, pd)
+CLAD_INTRINSIC_PACKET(packet_avx512_float, float, __m512, 16, _mm512, ps)
+template <> struct packet_for<double> { using type = packet_avx512_double; };
+template <> struct packet_for<float> { using type = packet_avx512_float; };
+#elif defined(__AVX__)
+CLAD_INTRINSIC_PACKET(packet_avx_double, double, __m256d, 4, _mm256, pd)
+CLAD_INTRINSIC_PACKET(packet_avx_float, float, __m256, 8, _mm256, ps)
+template <> struct packet_for<double> { using type = packet_avx_double; };
+template <> struct packet_for<float> { using type = packet_avx_float; };
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+CLAD_INTRINSIC_PACKET(packet_sse2_double, double, __m128d, 2, _mm, pd)
+CLAD_INTRINSIC_PACKET(packet_sse2_float, float, __m128, 4, _mm, ps)
+template <> struct packet_for<double> { using type = packet_sse2_double; };
+template <> struct packet_for<float> { using type = packet_sse2_float; };
+#else
+template <> struct packet_for<double> {
+  using type = generic_packet<double, 4>;
+};
+template <> struct packet_for<float> { using type = generic_packet<float, 8>; };
+#endif
+#undef CLAD_INTRINSIC_PACKET
+
+template <typename T> using remove_cvref_t =
+    typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+
+/// Whether the expression E, whose result is assigned to elements of type T,
+/// can be evaluated with packets of T. This is the case if all leaves are
+/// clad arrays of T or scalars which do not widen the computation.
+template <typename E, typename T, bool = std::is_arithmetic<E>::value>
+struct is_packet_evaluable : std::false_type {};
+
+template <typename E, typename T>
+struct is_packet_evaluable<E, T, /*IsScalar=*/true>
+    : std::is_same<decltype(E() * T()), T> {};
+
+template <typename T>
+struct is_packet_evaluable<array<T>, T, /*IsScalar=*/false>
+    : std::true_type {};
+
+template <typename T>
+struct is_packet_evaluable<array_ref<T>, T, /*IsScalar=*/false>
+    : std::true_type {};
+
+template <typename BinaryOp> struct is_packet_op : std::false_type {};
+template <> struct is_packet_op<BinaryAdd> : std::true_type {};
+template <> struct is_packet_op<BinarySub> : std::true_type {};
+template <> struct is_packet_op<BinaryMul> : std::true_type {};
+template <> struct is_packet_op<BinaryDiv> : std::true_type {};
+
+template <typename L, typename BinaryOp, typename R, typename T>
+struct is_packet_evaluable<array_expression<L, BinaryOp, R>, T,
+                           /*IsScalar=*/false>
+    : std::integral_constant<
+          bool, is_packet_op<BinaryOp>::value &&
+                    is_packet_evaluable<remove_cvref_t<L>, T>::value &&
+                    is_packet_evaluable<remove_cvref_t<R>, T>::value> {};
+
+/// \returns true if the n elements at src and the n elements at dst overlap
+/// without starting at the same address. A packet then reads elements of dst
+/// that the element-by-element loop would already have overwritten.
+template <typename T>
+bool overlaps_shifted(const T* src, const T* dst, std::size_t n) {
+  std::less<const T*> less;
+  return src != dst && less(src, dst + n) && less(dst, src + n);
+}
+
+/// Evaluates a packet-evaluable expression of type E a packet at a time. The
+/// evaluator holds the raw data pointers and broadcast scalars of the
+/// expression by value, so that they are not reloaded through the references
+/// of the expression tree after every store to the destination.
+template <typename P, typename T, typename E,
+          bool = std::is_arithmetic<E>::value>
+struct packet_evaluator {
+  P m_value;
+  explicit packet_evaluator(const E& s)
+      : m_value(P::broadcast(static_cast<T>(s))) {}
+  P packet(std::size_t /*i*/) const { return m_value; }
+  bool overlaps(const T* /*dst*/, std::size_t /*n*/) const { return false; }
+};
+
+template <typename P, typename T>
+struct packet_evaluator<P, T, array<T>, /*IsScalar=*/false> {
+  const T* m_data;
+  explicit packet_evaluator(const array<T>& a) : m_data(a.ptr()) {}
+  P packet(std::size_t i) const { return P::load(m_data + i); }
+  bool overlaps(const T* dst, std::size_t n) const {
+    return overlaps_shifted(m_data, dst, n);
+  }
+};
+
+template <typename P, typename T>
+struct packet_evaluator<P, T, array_ref<T>, /*IsScalar=*/false> {
+  const T* m_data;
+  explicit packet_evaluator(const array_ref<T>& a) : m_data(a.ptr()) {}
+  P packet(std::size_t i) const { return P::load(m_data + i); }
+  bool overlaps(const T* dst, std::size_t n) const {
+    return overlaps_shifted(m_data, dst, n);
+  }
+};
+
+template <typename P, typename T, typename L, typename BinaryOp, typename R>
+struct packet_evaluator<P, T, array_expression<L, BinaryOp, R>,
+                        /*IsScalar=*/false> {
+  packet_evaluator<P, T, remove_cvref_t<L>> m_left;
+  packet_evaluator<P, T, remove_cvref_t<R>> m_right;
+  explicit packet_evaluator(const array_expression<L, BinaryOp, R>& e)
+      : m_left(e.left()), m_right(e.right()) {}
+  P packet(std::size_t i) const {
+    return BinaryOp::apply(m_left.packet(i), m_right.packet(i));
+  }
+  bool overlaps(const T* dst, std::size_t n) const {
+    return m_left.overlaps(dst, n) || m_right.overlaps(dst, n);
+  }
+};
+
+template <typename AssignOpT, typename T, typename E>
+void evaluate_impl(T* dst, const E& expr, std::size_t n, std::true_type) {
+  using P = typename packet_for<T>::type;
+  const packet_evaluator<P, T, E> evaluator(expr);
+  // Views into the same buffer at an offset, e.g. slices, are evaluated
+  // element by element to keep the results of the scalar loop.
+  if (evaluator.overlaps(dst, n)) {
+    evaluate_scalar<AssignOpT>(dst, expr, n);
+    return;
+  }
+  std::size_t i = 0;
+  for (; i + P::width <= n; i += P::width)
+    AssignOpT::apply(P::load(dst + i), evaluator.packet(i)).store(dst + i);
+  for (; i < n; ++i)
+    dst[i] = AssignOpT::apply(dst[i], expr[i]);
+}
+
+template <typename AssignOpT, typename T, typename E>
+void evaluate_impl(T* dst, const E& expr, std::size_t n, std::false_type) {
+  evaluate_scalar<AssignOpT>(dst, expr, n);
+}
+
+/// Evaluates `dst[i] = AssignOpT::apply(dst[i], expr[i])` for every i in
+/// [0, n), a packet at a time when the expression and element type allow it.
+template <typename AssignOpT, typename T, typename E>
+void evaluate(T* dst, const E& expr, std::size_t n) {
+  using packet_t = typename packet_for<T>::type;
+  evaluate_impl<AssignOpT>(
+      dst, expr, n,
+      std::integral_constant<bool, !std::is_void<packet_t>::value &&
+                                       is_packet_evaluable<E, T>::value>());
+}
+#else
+template <typename AssignOpT, typename T, typename E>
+CUDA_HOST_DEVICE void evaluate(T* dst, const E& expr, std::size_t n) {
+  evaluate_scalar<AssignOpT>(dst, expr, n);
+}
+#endif // CLAD_ARRAY_SIMD
+} // namespace simd
+} // namespace clad
+// NOLINTEND(*-pointer-arithmetic)
+
+#endif // CLAD_DIFFERENTIATOR_ARRAYEXPRESSIONSIMD_H
@@ -58,8 +58,7 @@ public:
   CUDA_HOST_DEVICE array_ref<T>&
   operator=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] = arr_exp[i];
+    simd::evaluate<simd::AssignOp>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Returns the size of the underlying array
@@ -128,8 +127,7 @@ public:
   CUDA_HOST_DEVICE array_ref<T>&
   operator*=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] *= arr_exp[i];
+    simd::evaluate<BinaryMul>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Adds the elements of the array_ref by elements of the array
@@ -137,8 +135,7 @@ public:
   CUDA_HOST_DEVICE array_ref<T>&
   operator+=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] += arr_exp[i];
+    simd::evaluate<BinaryAdd>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Subtracts the elements of the array_ref by elements of the array
@@ -146,8 +143,7 @@ public:
   CUDA_HOST_DEVICE array_ref<T>&
   operator-=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] -= arr_exp[i];
+    simd::evaluate<BinarySub>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Divides the elements of the array_ref by elements of the array
@@ -155,8 +151,7 @@ public:
   CUDA_HOST_DEVICE array_ref<T>&
   operator/=(const array_expression<L, BinaryOp, R>& arr_exp) {
     assert(arr_exp.size() == m_size);
-    for (std::size_t i = 0; i < m_size; i++)
-      m_arr[i] /= arr_exp[i];
+    simd::evaluate<BinaryDiv>(m_arr, arr_exp, m_size);
     return *this;
   }
   /// Multiplies the elements of the array_ref by elements of the array
@@ -0,0 +1,180 @@
+#ifndef CLAD_DIFFERENTIATOR_BATCHEXECUTION_H
+#define CLAD_DIFFERENTIATOR_BATCHEXECUTION_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace clad {
+
+/// A sample of a batch column, see clad::batched. It is passed to the
+/// derivative as the element of the column, or as its address if the
+/// parameter is a pointer.
+template <typename T> struct batch_sample_ref {
+  T* m_Ptr;
+  operator T&() const { return *m_Ptr; }
+  operator T*() const { return m_Ptr; }
+};
+
+/// A column of a struct-of-arrays batch of inputs or outputs, see
+/// CladFunction::execute_batch. The sample i of the column starts at
+/// data + i * stride.
+template <typename T> struct batch {
+  T* m_Data;
+  std::size_t m_Stride;
+  batch_sample_ref<T> operator[](std::size_t i) const {
+    return {m_Data + i * m_Stride};
+  }
+};
+
+/// Makes a column of a batch from the array \p data, which holds \p stride
+/// elements per sample. If the derivative takes a pointer, every sample is
+/// passed the address of its elements, e.g. of its adjoint, otherwise the
+/// value of its element.
+template <typename T> batch<T> batched(T* data, std::size_t stride = 1) {
+  return {data, stride};
+}
+
+/// \returns the value passed to the sample \p i for an argument of
+/// CladFunction::execute_batch.
+template <typename T> T& batch_sample(T& arg, std::size_t /*i*/) {
+  return arg;
+}
+template <typename T>
+batch_sample_ref<T> batch_sample(batch<T>& column, std::size_t i) {
+  return column[i];
+}
+template <typename T>
+batch_sample_ref<T> batch_sample(const batch<T>& column, std::size_t i) {
+  return column[i];
+}
+
+/// A pool of threads which run the iterations of a loop, see parallel_for.
+/// The threads live as long as the pool, thus the slabs cached by the tapes
+/// of a thread are reused by the derivatives it executes.
+class thread_pool {
+public:
+  /// The function running the iterations [begin, end) of a loop.
+  using job_t = void (*)(void* context, std::size_t begin, std::size_t end);
+
+private:
+  std::vector<std::thread> m_Workers;
+  /// Serializes the loops run by different threads.
+  std::mutex m_RunMutex;
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;
+  std::condition_variable m_Finished;
+  job_t m_Job = nullptr;
+  void* m_Context = nullptr;
+  std::size_t m_Size = 0;
+  std::size_t m_Grain = 1;
+  /// The first iteration not taken by a thread yet.
+  std::atomic<std::size_t> m_Next{0};
+  /// Incremented for every loop, wakes up the workers.
+  std::size_t m_Generation = 0;
+  /// The number of workers which did not finish the current loop yet.
+  std::size_t m_Active = 0;
+  bool m_Stop = false;
+
+  /// Whether the current thread runs iterations of a loop, in which case
+  /// nested loops are run serially.
+  static bool& in_loop() {
+    static thread_local bool inLoop = false;
+    return inLoop;
+  }
+
+  void run_iterations() {
+    for (;;) {
+      std::size_t begin = m_Next.fetch_add(m_Grain);
+      if (begin >= m_Size)
+        return;
+      m_Job(m_Context, begin, std::min(begin + m_Grain, m_Size));
+    }
+  }
+
+  void work() {
+    in_loop() = true;
+    std::size_t generation = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Wake.wait(lock,
+                    [&]() { return m_Stop || m_Generation != generation; });
+        if (m_Stop)
+          return;
+        generation = m_Generation;
+      }
+      run_iterations();
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (!--m_Active)
+        m_Finished.notify_one();
+    }
+  }
+
+public:
+  /// Creates a pool with \p workers threads in addition to the thread calling
+  /// parallel_for.
+  explicit thread_pool(std::size_t workers) {
+    m_Workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; i++)
+      m_Workers.emplace_back(&thread_pool::work, this);
+  }
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stop = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread& worker : m_Workers)
+      worker.join();
+  }
+
+  /// \returns the pool used by default, with one thread per hardware thread.
+  static thread_pool& global() {
+    static thread_pool pool(
+        std::max(std::thread::hardware_concurrency(), 1U) - 1);
+    return pool;
+  }
+
+  /// \returns the number of threads running the iterations of a loop.
+  std::size_t size() const { return m_Workers.size() + 1; }
+
+  /// Calls \p job for ranges of at most \p grain iterations covering
+  /// [0, \p n), on the threads of the pool and the calling thread. Returns
+  /// once all iterations ran. Allocates no memory.
+  void parallel_for(std::size_t n, std::size_t grain, job_t job,
+                    void* context) {
+    grain = std::max<std::size_t>(grain, 1);
+    if (m_Workers.empty() || in_loop() || n <= grain) {
+      if (n)
+        job(context, 0, n);
+      return;
+    }
+    std::lock_guard<std::mutex> run(m_RunMutex);
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Job = job;
+      m_Context = context;
+      m_Size = n;
+      m_Grain = grain;
+      m_Next = 0;
+      m_Active = m_Workers.size();
+      m_Generation++;
+    }
+    m_Wake.notify_all();
+    in_loop() = true;
+    run_iterations();
+    in_loop() = false;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Finished.wait(lock, [&]() { return !m_Active; });
+  }
+};
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_BATCHEXECUTION_H
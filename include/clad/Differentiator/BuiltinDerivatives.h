@@ -9,6 +9,7 @@
 
 #include "clad/Differentiator/ArrayRef.h"
 #include "clad/Differentiator/CladConfig.h"
+#include "clad/Differentiator/StaticArray.h"
 
 #include <algorithm>
 #include <cmath>
@@ -937,6 +938,11 @@ template <typename T, typename dT> struct AdjOutType<T, clad::array<dT>> {
   using type = clad::array<T>;
 };
 
+template <typename T, typename dT, ::std::size_t N>
+struct AdjOutType<T, clad::static_array<dT, N>> {
+  using type = clad::static_array<T, N>;
+};
+
 template <typename T1, typename T2, typename dT1, typename dT2,
           typename T_out = decltype(::std::pow(T1(), T2())),
           typename dT_out = typename AdjOutType<T_out, dT1>::type>
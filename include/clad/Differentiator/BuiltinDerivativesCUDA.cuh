@@ -29,4 +29,18 @@ __device__ inline void make_float2_pullback(float a, float b, float2 d_y,
   *d_b += d_y.y;
 }
 } // namespace custom_derivatives
+
+/// Adds the sum of \p val over the threads of the block to \p *address with a
+/// single atomicAdd. All the threads of the block must call it.
+template <typename T> __device__ void block_atomic_add(T* address, T val) {
+  __shared__ T sum;
+  bool first = threadIdx.x == 0 && threadIdx.y == 0 && threadIdx.z == 0;
+  if (first)
+    sum = 0;
+  __syncthreads();
+  atomicAdd(&sum, val);
+  __syncthreads();
+  if (first)
+    atomicAdd(address, sum);
+}
 } // namespace clad
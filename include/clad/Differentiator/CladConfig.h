@@ -39,6 +39,9 @@ enum opts : unsigned {
 
   // Specify that we need a constexpr-enabled CladFunction
   immediate_mode = 1 << (ORDER_BITS + 7),
+
+  // Use fixed-size direction vectors in vector forward mode.
+  static_directions = 1 << (ORDER_BITS + 11),
 }; // enum opts
 
 constexpr unsigned GetDerivativeOrder(const unsigned bitmasked_opts) {
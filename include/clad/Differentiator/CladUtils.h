@@ -401,6 +401,13 @@ namespace clad {
     clang::QualType GetCladArrayOfType(clang::Sema& S, clang::QualType T);
     /// Create clad::matrix<T> type.
     clang::QualType GetCladMatrixOfType(clang::Sema& S, clang::QualType T);
+    /// Create clad::static_array<T, N> type.
+    clang::QualType GetCladStaticArrayOfType(clang::Sema& S, clang::QualType T,
+                                             std::size_t N);
+    /// Create the template argument \p N of type std::size_t, e.g. the size of
+    /// clad::static_array<T, N>.
+    clang::TemplateArgument GetSizeTemplateArgument(clang::ASTContext& C,
+                                                    std::size_t N);
     /// Create clad::array_ref<T> type.
     clang::QualType GetCladArrayRefOfType(clang::Sema& S, clang::QualType T);
     /// Returns type clad::Tag<T>
@@ -413,6 +420,10 @@ namespace clad {
 
     clang::QualType GetRestoreTrackerType(clang::Sema& S);
 
+    /// Returns the type clad::ClassName of a non-template class declared in
+    /// the clad namespace.
+    clang::QualType GetCladClassType(clang::Sema& S, llvm::StringRef ClassName);
+
     void SetSwitchCaseSubStmt(clang::SwitchCase* SC, clang::Stmt* subStmt);
 
     bool IsZeroOrNullValue(const clang::Expr* E);
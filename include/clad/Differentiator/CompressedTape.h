@@ -0,0 +1,379 @@
+#ifndef CLAD_DIFFERENTIATOR_COMPRESSEDTAPE_H
+#define CLAD_DIFFERENTIATOR_COMPRESSEDTAPE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clad {
+
+/// A lossless codec for slabs of floating-point values, in the style of the
+/// FPC and Gorilla compressors. Each value is predicted from the two previous
+/// ones, either as the previous value or by extrapolating the difference of
+/// their bit patterns. The prediction is XOR-ed with the value, and only the
+/// bytes between the leading and the trailing zero bytes of the result are
+/// stored, after a header byte holding the predictor, the number of stored
+/// bytes and the number of trailing zero bytes.
+/// Repeated and evenly changing values take a single byte.
+template <typename T> class float_codec {
+  using Bits = typename std::conditional<sizeof(T) == 8, std::uint64_t,
+                                         std::uint32_t>::type;
+  constexpr static unsigned kBytes = sizeof(Bits);
+
+  /// Reads the kBytes bytes at \p in in little-endian order.
+  static Bits load(const void* in) {
+    Bits res = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(&res, in, kBytes);
+#else
+    for (unsigned b = 0; b < kBytes; ++b)
+      res |= static_cast<Bits>(static_cast<const std::uint8_t*>(in)[b])
+             << (8 * b);
+#endif
+    return res;
+  }
+
+  /// Writes the kBytes bytes of \p x to \p out in little-endian order.
+  static void store(std::uint8_t* out, Bits x) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(out, &x, kBytes);
+#else
+    for (unsigned b = 0; b < kBytes; ++b)
+      out[b] = static_cast<std::uint8_t>(x >> (8 * b));
+#endif
+  }
+
+  static unsigned leading_zero_bytes(Bits x) {
+    if (!x)
+      return kBytes;
+#if defined(__GNUC__) || defined(__clang__)
+    if (kBytes == 8)
+      return __builtin_clzll(x) / 8;
+    return __builtin_clz(static_cast<std::uint32_t>(x)) / 8;
+#else
+    unsigned res = 0;
+    while (!((x >> (8 * (kBytes - 1 - res))) & 0xFF))
+      ++res;
+    return res;
+#endif
+  }
+
+  static unsigned trailing_zero_bytes(Bits x) {
+    if (!x)
+      return 0;
+#if defined(__GNUC__) || defined(__clang__)
+    if (kBytes == 8)
+      return __builtin_ctzll(x) / 8;
+    return __builtin_ctz(static_cast<std::uint32_t>(x)) / 8;
+#else
+    unsigned res = 0;
+    while (!((x >> (8 * res)) & 0xFF))
+      ++res;
+    return res;
+#endif
+  }
+
+public:
+  /// Whether values of type T can be compressed.
+  constexpr static bool supported =
+      std::is_floating_point<typename std::remove_cv<T>::type>::value &&
+      (sizeof(T) == 4 || sizeof(T) == 8);
+
+  /// \returns the maximal number of bytes taken by \p n values.
+  constexpr static std::size_t max_size(std::size_t n) {
+    return n * (kBytes + 1);
+  }
+
+  /// The number of bytes decode() may read after the compressed values.
+  constexpr static std::size_t padding = kBytes;
+
+  /// Compresses the \p n values stored in \p data to \p out, which should
+  /// hold max_size(n) bytes. \returns the number of bytes written.
+  static std::size_t encode(const char* data, std::size_t n,
+                            std::uint8_t* out) {
+    std::uint8_t* begin = out;
+    Bits prev = 0;
+    Bits delta = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      Bits cur = load(data + i * sizeof(T));
+      Bits x = cur ^ prev;
+      unsigned lz = leading_zero_bytes(x);
+      unsigned tz = trailing_zero_bytes(x);
+      unsigned predictor = 0;
+      Bits extrapolated = cur ^ (prev + delta);
+      unsigned elz = leading_zero_bytes(extrapolated);
+      unsigned etz = trailing_zero_bytes(extrapolated);
+      if (elz + etz > lz + tz) {
+        x = extrapolated;
+        lz = elz;
+        tz = etz;
+        predictor = 1;
+      }
+      unsigned size = kBytes - lz - tz;
+      *out = static_cast<std::uint8_t>(predictor << 7 | size << 3 | tz);
+      // Writes all kBytes bytes, the ones after the stored bytes are
+      // overwritten by the next value.
+      store(out + 1, x >> (8 * tz));
+      out += 1 + size;
+      delta = cur - prev;
+      prev = cur;
+    }
+    return out - begin;
+  }
+
+  /// Decompresses \p n values from \p in to \p data. \p in should be
+  /// followed by \p padding readable bytes.
+  static void decode(const std::uint8_t* in, std::size_t n, char* data) {
+    Bits prev = 0;
+    Bits delta = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      unsigned header = *in;
+      unsigned size = (header >> 3) & 0xF;
+      unsigned tz = header & 0x7;
+      // Shifting by 8 * kBytes is undefined, thus shift twice.
+      Bits mask = ~Bits(0) >> (4 * (kBytes - size)) >> (4 * (kBytes - size));
+      Bits x = (load(in + 1) & mask) << (8 * tz);
+      in += 1 + size;
+      Bits cur = x ^ (prev + (delta & (Bits(0) - (header >> 7))));
+      std::memcpy(data + i * sizeof(T), &cur, sizeof(Bits));
+      delta = cur - prev;
+      prev = cur;
+    }
+  }
+};
+
+/// A variant of `clad::tape_impl` which compresses the full slabs of
+/// floating-point values with `clad::float_codec`. Only the last slab is kept
+/// uncompressed; the slab before it is decompressed when pop_back reaches it.
+/// The values stored in the tapes of loops often change slowly between the
+/// iterations and compress well, which reduces the memory traffic of the
+/// forward and the reverse pass. Tapes of other types are not compressed.
+template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
+          bool is_multithread = false>
+class compressed_tape_impl {
+  using codec = float_codec<T>;
+  constexpr static bool kCompressible = codec::supported;
+  constexpr static std::size_t kSlabBytes = SLAB_SIZE * sizeof(T);
+
+  struct Slab {
+    alignas(T) char raw_data[SLAB_SIZE * sizeof(T)];
+    T* elements() {
+#if __cplusplus >= 201703L
+      return std::launder(reinterpret_cast<T*>(raw_data));
+#else
+      return reinterpret_cast<T*>(raw_data);
+#endif
+    }
+  };
+
+  /// A full slab, either uncompressed or compressed to m_packed.
+  struct SlabEntry {
+    Slab* m_raw;
+    std::uint8_t* m_packed;
+    std::size_t m_packed_size;
+  };
+
+  alignas(T) char m_static_buffer[SBO_SIZE * sizeof(T)];
+  /// The slabs in chain order. The last one is always uncompressed.
+  std::vector<SlabEntry> m_slabs;
+  /// Emptied slabs kept to avoid an allocation per slab when the tape
+  /// oscillates around a slab boundary.
+  std::vector<Slab*> m_free;
+  /// The buffer slabs are compressed to before their exact size is known.
+  std::vector<std::uint8_t> m_scratch;
+  std::size_t m_size = 0;
+  std::size_t m_packed_bytes = 0;
+  mutable std::mutex m_TapeMutex;
+
+  T* sbo_elements() {
+#if __cplusplus >= 201703L
+    return std::launder(reinterpret_cast<T*>(m_static_buffer));
+#else
+    return reinterpret_cast<T*>(m_static_buffer);
+#endif
+  }
+
+public:
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using value_type = T;
+
+  std::mutex& mutex() const { return m_TapeMutex; }
+
+  compressed_tape_impl() = default;
+#ifdef CLAD_TAPE_INSTRUMENTATION
+  /// The tapes of the derivative functions are named when
+  /// CLAD_TAPE_INSTRUMENTATION is defined, but only `clad::tape_impl` records
+  /// their statistics.
+  compressed_tape_impl(const char* /*function*/, const char* /*name*/)
+      : compressed_tape_impl() {}
+#endif
+  compressed_tape_impl(const compressed_tape_impl&) = delete;
+  compressed_tape_impl& operator=(const compressed_tape_impl&) = delete;
+
+  ~compressed_tape_impl() { clear(); }
+
+  /// Add new value of type T constructed from args to the end of the tape.
+  template <typename... ArgsT> void emplace_back(ArgsT&&... args) {
+    T* elem;
+    if (m_size < SBO_SIZE) {
+      elem = sbo_elements() + m_size;
+    } else {
+      std::size_t index = m_size - SBO_SIZE;
+      if (index % SLAB_SIZE == 0)
+        add_slab();
+      elem = m_slabs.back().m_raw->elements() + index % SLAB_SIZE;
+    }
+    ::new (const_cast<void*>(static_cast<const volatile void*>(elem)))
+        T(std::forward<ArgsT>(args)...);
+    m_size++;
+  }
+
+  std::size_t size() const { return m_size; }
+
+  /// \returns the number of bytes used to store the elements, including the
+  /// small buffer.
+  std::size_t memory_usage() const {
+    std::size_t raw = 0;
+    for (const SlabEntry& entry : m_slabs)
+      raw += entry.m_raw ? kSlabBytes : 0;
+    return sizeof(m_static_buffer) + raw + m_packed_bytes;
+  }
+
+  /// Access last value (must not be empty). The last slab is never compressed.
+  reference back() {
+    assert(m_size);
+    std::size_t index = m_size - 1;
+    if (index < SBO_SIZE)
+      return sbo_elements()[index];
+    return m_slabs.back().m_raw->elements()[(index - SBO_SIZE) % SLAB_SIZE];
+  }
+
+  /// Access the value at \p i. Its slab is decompressed and stays
+  /// uncompressed.
+  reference operator[](std::size_t i) {
+    assert(i < m_size);
+    if (i < SBO_SIZE)
+      return sbo_elements()[i];
+    i -= SBO_SIZE;
+    SlabEntry& entry = m_slabs[i / SLAB_SIZE];
+    if (!entry.m_raw)
+      decompress(entry);
+    return entry.m_raw->elements()[i % SLAB_SIZE];
+  }
+
+  /// Remove the last value from the tape.
+  void pop_back() {
+    assert(m_size);
+    m_size--;
+    if (m_size < SBO_SIZE) {
+      destroy_element(sbo_elements() + m_size);
+      return;
+    }
+    std::size_t index = m_size - SBO_SIZE;
+    destroy_element(m_slabs.back().m_raw->elements() + index % SLAB_SIZE);
+    if (index % SLAB_SIZE)
+      return;
+    // The last slab is empty, make the one before it the last one.
+    release_slab(m_slabs.back().m_raw);
+    m_slabs.pop_back();
+    if (!m_slabs.empty() && !m_slabs.back().m_raw)
+      decompress(m_slabs.back());
+  }
+
+private:
+  /// Compresses the last slab, which is full, and appends an empty one.
+  void add_slab() {
+    if (kCompressible && !m_slabs.empty())
+      compress(m_slabs.back());
+    Slab* slab;
+    if (!m_free.empty()) {
+      slab = m_free.back();
+      m_free.pop_back();
+    } else {
+      slab = new Slab();
+    }
+    m_slabs.push_back({slab, nullptr, 0});
+  }
+
+  void compress(SlabEntry& entry) {
+    if (!entry.m_raw)
+      return;
+    if (m_scratch.empty())
+      m_scratch.resize(codec::max_size(SLAB_SIZE));
+    std::size_t size =
+        codec::encode(entry.m_raw->raw_data, SLAB_SIZE, m_scratch.data());
+    // Incompressible slabs are kept as they are.
+    if (size + codec::padding >= kSlabBytes)
+      return;
+    entry.m_packed = new std::uint8_t[size + codec::padding];
+    std::memcpy(entry.m_packed, m_scratch.data(), size);
+    // decode() loads whole words, which may cover the padding.
+    std::memset(entry.m_packed + size, 0, codec::padding);
+    entry.m_packed_size = size + codec::padding;
+    m_packed_bytes += entry.m_packed_size;
+    release_slab(entry.m_raw);
+    entry.m_raw = nullptr;
+  }
+
+  void decompress(SlabEntry& entry) {
+    Slab* slab;
+    if (!m_free.empty()) {
+      slab = m_free.back();
+      m_free.pop_back();
+    } else {
+      slab = new Slab();
+    }
+    codec::decode(entry.m_packed, SLAB_SIZE, slab->raw_data);
+    delete[] entry.m_packed;
+    m_packed_bytes -= entry.m_packed_size;
+    entry = {slab, nullptr, 0};
+  }
+
+  void release_slab(Slab* slab) {
+    if (m_free.size() < 2)
+      m_free.push_back(slab);
+    else
+      delete slab;
+  }
+
+  /// Destroys all elements and deallocates the slabs.
+  void clear() {
+    // The compressible elements are trivially destructible and the other ones
+    // are never compressed.
+    if (!kCompressible)
+      while (m_size)
+        pop_back();
+    for (SlabEntry& entry : m_slabs) {
+      delete entry.m_raw;
+      delete[] entry.m_packed;
+    }
+    for (Slab* slab : m_free)
+      delete slab;
+    m_slabs.clear();
+    m_free.clear();
+    m_size = 0;
+    m_packed_bytes = 0;
+  }
+
+  template <typename ElTy> void destroy_element(ElTy* elem) { elem->~ElTy(); }
+
+  template <typename ElTy, std::size_t N>
+  void destroy_element(ElTy (*arr)[N]) {
+    for (std::size_t i = 0; i < N; ++i)
+      (*arr)[i].~ElTy();
+  }
+};
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_COMPRESSEDTAPE_H
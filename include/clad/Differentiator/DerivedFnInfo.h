@@ -18,6 +18,8 @@ struct DerivedFnInfo {
   DiffInputVarsInfo m_DiffVarsInfo;
   std::vector<size_t> m_CUDAGlobalArgsIndexes;
   bool m_UsesEnzyme = false;
+  bool m_StaticDirections = false;
+  bool m_VectorHessian = false;
   bool m_DeclarationOnly = false;
 
   DerivedFnInfo() = default;
@@ -12,7 +12,10 @@ enum class DiffMode {
   reverse,
   hessian,
   hessian_diagonal,
+  hessian_vector_product,
+  sparse_hessian,
   jacobian,
+  sparse_jacobian,
   reverse_mode_forward_pass
 };
 
@@ -35,8 +38,14 @@ inline const char* DiffModeToString(DiffMode mode) {
     return "hessian";
   case DiffMode::hessian_diagonal:
     return "hessian_diagonal";
+  case DiffMode::hessian_vector_product:
+    return "hessian_vector_product";
+  case DiffMode::sparse_hessian:
+    return "sparse_hessian";
   case DiffMode::jacobian:
     return "jacobian";
+  case DiffMode::sparse_jacobian:
+    return "sparse_jacobian";
   case DiffMode::reverse_mode_forward_pass:
     return "reverse_forw";
   default:
@@ -42,6 +42,14 @@ using OwnedAnalysisContexts =
     llvm::SmallVector<std::unique_ptr<clang::AnalysisDeclContext>, 4>;
 using ParamSet = std::set<const clang::ParmVarDecl*>;
 using ParamInfo = std::map<const clang::FunctionDecl*, ParamSet>;
+/// A `#pragma clad checkpoint loop` in the function being differentiated.
+struct LoopCheckpoint {
+  /// The number of snapshots of the binomial checkpointing schedule given by
+  /// `snapshots(N)`, or 0 if the loop iterations are recomputed.
+  unsigned Snapshots = 0;
+  /// Whether the pragma was found before a loop.
+  bool Used = false;
+};
 /// A struct containing information about request to differentiate a function.
 struct DiffRequest {
 private:
@@ -102,9 +110,20 @@ public:
   /// A flag specifying whether this differentiation is to be used
   /// in immediate contexts.
   bool ImmediateMode = false;
+  /// A flag specifying whether vector forward mode should use fixed-size
+  /// direction vectors when the number of directions is known at compile time.
+  bool StaticDirections = false;
+  /// A flag specifying whether the hessian should be computed by a single
+  /// vector forward mode pass over the gradient instead of one second order
+  /// derivative per independent variable.
+  bool VectorHessian = false;
   /// A flag specifying whether this differentiation is to be used
   /// for error estimation.
   bool EnableErrorEstimation = false;
+  /// A flag specifying whether the pullback of a functor call operator is
+  /// called by the iterations of a Kokkos loop, which all pass the same
+  /// adjoint of the functor.
+  bool CalledFromKokkosLoop = false;
   /// Puts the derived function and its code in the diff call
   void updateCall(clang::FunctionDecl* FD, clang::FunctionDecl* OverloadedFD,
                   clang::Sema& SemaRef);
@@ -117,7 +136,7 @@ public:
   const clang::CXXRecordDecl* Functor = nullptr;
   /// Stores loop checkpoint pragma locations, if any.
   /// The order is reversed to simplify lookups.
-  mutable std::map<clang::SourceLocation, bool, std::greater<>>
+  mutable std::map<clang::SourceLocation, LoopCheckpoint, std::greater<>>
       m_CladLoopCheckpoints;
 
   /// Global VarDecl to differentiate, if any.
@@ -175,6 +194,8 @@ public:
     // the set of overloads is the same.
     // Including AnalysisDC would complicate constructing requests to find the
     // existing once.
+    // CalledFromKokkosLoop is set on the existing request when the loop is
+    // planned after it.
     return Function == other.Function &&
            BaseFunctionName == other.BaseFunctionName &&
            CurrentDerivativeOrder == other.CurrentDerivativeOrder &&
@@ -184,6 +205,8 @@ public:
            EnableVariedAnalysis == other.EnableVariedAnalysis &&
            EnableUsefulAnalysis == other.EnableUsefulAnalysis &&
            DVI == other.DVI && use_enzyme == other.use_enzyme &&
+           StaticDirections == other.StaticDirections &&
+           VectorHessian == other.VectorHessian &&
            DeclarationOnly == other.DeclarationOnly && Global == other.Global &&
            CUDAGlobalArgsIndexes == other.CUDAGlobalArgsIndexes;
   }
@@ -276,6 +299,9 @@ public:
 
     llvm::DenseSet<const clang::FunctionDecl*> m_Traversed;
 
+    /// The functors of the planned Kokkos loops, see CalledFromKokkosLoop.
+    llvm::DenseSet<const clang::CXXRecordDecl*> m_KokkosLoopFunctors;
+
     bool m_IsTraversingTopLevelDecl = true;
 
   public:
@@ -303,6 +329,12 @@ public:
 
   private:
     bool isInInterval(clang::SourceLocation Loc) const;
+    /// Records the functors passed to the Kokkos loop \p E and marks the
+    /// planned pullbacks of their call operators.
+    void AddKokkosLoopFunctors(const clang::CallExpr* E);
+    /// \returns true if \p R is the pullback of the call operator of a
+    /// functor passed to a planned Kokkos loop.
+    bool isKokkosLoopFunctorPullback(const DiffRequest& R) const;
   };
 }
 
@@ -9,15 +9,28 @@
 
 #include "Array.h"
 #include "ArrayRef.h"
+#ifndef __CUDACC__
+#include "BatchExecution.h"
+#endif
 #include "BuiltinDerivatives.h"
 #ifdef __CUDACC__
 #include "BuiltinDerivativesCUDA.cuh"
 #endif
 #include "CladConfig.h"
+#include "CompressedTape.h"
 #include "FunctionTraits.h"
 #include "Matrix.h"
 #include "NumericalDiff.h"
+#ifndef __CUDACC__
+#include "ParallelAdjoints.h"
+#endif
 #include "RestoreTracker.h"
+#include "Revolve.h"
+#include "Sparsity.h"
+#ifndef __CUDACC__
+#include "SpillingTape.h"
+#endif
+#include "StaticArray.h"
 #include "Tape.h"
 
 #include <array>
@@ -30,6 +43,7 @@
 #include <utility>
 #ifndef __CUDACC__
 #include <mutex>
+#include <tuple>
 #endif
 
 namespace clad {
@@ -57,10 +71,27 @@ inline CUDA_HOST_DEVICE unsigned int GetLength(const char* code) {
 #define CUDA_REST_ARGS
 #endif
 
-/// Tape type used for storing values in reverse-mode AD inside loops.
+/// Tape type used for storing values in reverse-mode AD inside loops. If
+/// CLAD_TAPE_SPILL_LIMIT is defined, the tapes keep at most that many bytes in
+/// memory and spill the rest to a temporary file. If CLAD_TAPE_COMPRESSION is
+/// defined, the full slabs of floating-point values are compressed. The two
+/// tapes are exclusive.
+#if defined(CLAD_TAPE_SPILL_LIMIT) && defined(CLAD_TAPE_COMPRESSION)
+#error "CLAD_TAPE_SPILL_LIMIT and CLAD_TAPE_COMPRESSION cannot be combined"
+#endif
+#if defined(CLAD_TAPE_SPILL_LIMIT) && !defined(__CUDACC__)
+template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
+          bool is_multithread = false>
+using tape = spilling_tape_impl<T, SBO_SIZE, SLAB_SIZE, is_multithread>;
+#elif defined(CLAD_TAPE_COMPRESSION) && !defined(__CUDACC__)
+template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
+          bool is_multithread = false>
+using tape = compressed_tape_impl<T, SBO_SIZE, SLAB_SIZE, is_multithread>;
+#else
 template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
           bool is_multithread = false>
 using tape = tape_impl<T, SBO_SIZE, SLAB_SIZE, is_multithread>;
+#endif
 
 /// Add value to the end of the tape, return the same value.
 template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
@@ -143,6 +174,51 @@ CUDA_HOST_DEVICE void push(tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
     std::lock_guard<std::mutex> lock(of.mutex());
     return of.back();
   }
+
+  /// Tape type with a separate shard per thread. Threads push to and pop from
+  /// their own shard without locking.
+  template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024>
+  using sharded_tape = sharded_tape_impl<T, SBO_SIZE, SLAB_SIZE>;
+
+  /// Add value to the end of the calling thread's shard, return the same value.
+  template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
+            typename... ArgsT>
+  T& push(sharded_tape<T, SBO_SIZE, SLAB_SIZE>& to, ArgsT&&... val) {
+    auto& local = to.local();
+    local.emplace_back(std::forward<ArgsT>(val)...);
+    return local.back();
+  }
+
+  /// A specialization for C arrays
+  template <typename T, typename U, size_t N, std::size_t SBO_SIZE = 64,
+            std::size_t SLAB_SIZE = 1024>
+  void push(sharded_tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
+    auto& local = to.local();
+    local.emplace_back();
+    std::copy(std::begin(val), std::end(val), std::begin(local.back()));
+  }
+
+  /// Remove the last value pushed by the calling thread, return it.
+  template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024>
+  T pop(sharded_tape<T, SBO_SIZE, SLAB_SIZE>& to) {
+    auto& local = to.local();
+    T val = std::move(local.back());
+    local.pop_back();
+    return val;
+  }
+
+  /// A specialization for C arrays
+  template <typename T, std::size_t N, std::size_t SBO_SIZE = 64,
+            std::size_t SLAB_SIZE = 1024>
+  void pop(sharded_tape<T[N], SBO_SIZE, SLAB_SIZE>& to) {
+    to.pop_back();
+  }
+
+  /// Access the last value pushed by the calling thread.
+  template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024>
+  T& back(sharded_tape<T, SBO_SIZE, SLAB_SIZE>& of) {
+    return of.back();
+  }
 #endif
 
   /// The purpose of this function is to initialize adjoints
@@ -449,6 +525,42 @@ CUDA_HOST_DEVICE void push(tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
       return execute(std::forward<Args>(args)...);
     }
 
+#ifndef __CUDACC__
+    /// Executes the derivative for the \p n samples of a struct-of-arrays
+    /// batch. The arguments made by `clad::batched` are the columns of the
+    /// batch, the sample i is passed their i-th element, or its address if the
+    /// parameter is a pointer. The other arguments are passed to all samples.
+    /// For example, with `double f(double x, double y)`:
+    /// ```
+    /// auto grad = clad::gradient(f);
+    /// // x, y, dx and dy are arrays of n doubles, dx and dy set to 0.
+    /// grad.execute_batch(n, clad::batched(x), clad::batched(y),
+    ///                    clad::batched(dx), clad::batched(dy));
+    /// ```
+    /// The samples are split across the threads of \p pool, which must not
+    /// write to the same non-batched outputs. The values returned by the
+    /// derivative are discarded.
+    template <typename... Args, class FnType = CladFunctionType>
+    typename std::enable_if<!std::is_same<FnType, NoFunction*>::value>::type
+    execute_batch(thread_pool& pool, std::size_t n, Args&&... args) const {
+      using Tuple = std::tuple<Args&...>;
+      Tuple tuple(args...);
+      BatchContext<Tuple> context = {this, &tuple};
+      // A few ranges per thread balance the load without contention.
+      std::size_t grain = n / (8 * pool.size());
+      using Seq = MakeIndexSequence<sizeof...(Args)>;
+      pool.parallel_for(n, grain, GetBatchJob<Tuple>(Seq{}), &context);
+    }
+
+    /// Executes the derivative for the \p n samples of a batch on the threads
+    /// of `clad::thread_pool::global()`.
+    template <typename... Args, class FnType = CladFunctionType>
+    typename std::enable_if<!std::is_same<FnType, NoFunction*>::value>::type
+    execute_batch(std::size_t n, Args&&... args) const {
+      execute_batch(thread_pool::global(), n, std::forward<Args>(args)...);
+    }
+#endif
+
     /// Return the string representation for the generated derivative.
     constexpr const char* getCode() const {
       if (m_Code)
@@ -478,6 +590,29 @@ CUDA_HOST_DEVICE void push(tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
     }
 
     private:
+#ifndef __CUDACC__
+      /// The derivative and the arguments of CladFunction::execute_batch.
+      template <class Tuple> struct BatchContext {
+        const CladFunction* m_Function;
+        Tuple* m_Args;
+      };
+
+      /// Executes the samples [begin, end) of CladFunction::execute_batch.
+      template <class Tuple, std::size_t... Is>
+      static void ExecuteBatch(void* context, std::size_t begin,
+                               std::size_t end) {
+        auto* ctx = static_cast<BatchContext<Tuple>*>(context);
+        for (std::size_t i = begin; i < end; i++)
+          ctx->m_Function->execute(
+              batch_sample(std::get<Is>(*ctx->m_Args), i)...);
+      }
+
+      template <class Tuple, std::size_t... Is>
+      static thread_pool::job_t GetBatchJob(IndexSequence<Is...>) {
+        return &ExecuteBatch<Tuple, Is...>;
+      }
+#endif
+
       /// Helper function for executing non-member derived functions.
       template <class Fn, class... Args>
       constexpr CUDA_HOST_DEVICE return_type_t<CladFunctionType>
@@ -745,6 +880,70 @@ CUDA_HOST_DEVICE void push(tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
         derivedFn /* will be replaced by hessian*/, code, f);
   }
 
+  /// Generates function which computes the product of the hessian matrix of
+  /// the given function wrt the parameters specified in `args` with a vector,
+  /// without computing the hessian matrix itself. The generated function takes
+  /// the vector and the output for the product as two additional parameters.
+  ///
+  /// \param[in] fn function to differentiate
+  /// \param[in] args independent parameters information
+  /// \returns `CladFunction` object to access the corresponding derived
+  /// function.
+  template <unsigned... BitMaskedOpts, typename ArgSpec = const char*,
+            typename F,
+            typename DerivedFnType = HessianVectorProductDerivedFnTraits_t<F>,
+            typename = typename std::enable_if<
+                !std::is_class<remove_reference_and_pointer_t<F>>::value>::type>
+  constexpr CladFunction<
+      DerivedFnType, ExtractFunctorTraits_t<F>> __attribute__((annotate("HVP")))
+  hessian_vector_product(
+      F f, ArgSpec args = "",
+      DerivedFnType derivedFn = static_cast<DerivedFnType>(nullptr),
+      const char* code = "") {
+    return CladFunction<DerivedFnType, ExtractFunctorTraits_t<F>>(
+        derivedFn /* will be replaced by hessian vector product*/, code);
+  }
+
+  /// Specialization for differentiating functors.
+  template <unsigned... BitMaskedOpts, typename ArgSpec = const char*,
+            typename F,
+            typename DerivedFnType = HessianVectorProductDerivedFnTraits_t<F>,
+            typename = typename std::enable_if<
+                std::is_class<remove_reference_and_pointer_t<F>>::value>::type>
+  constexpr CladFunction<
+      DerivedFnType, ExtractFunctorTraits_t<F>> __attribute__((annotate("HVP")))
+  hessian_vector_product(
+      F&& f, ArgSpec args = "",
+      DerivedFnType derivedFn = static_cast<DerivedFnType>(nullptr),
+      const char* code = "") {
+    return CladFunction<DerivedFnType, ExtractFunctorTraits_t<F>>(
+        derivedFn /* will be replaced by hessian vector product*/, code, f);
+  }
+
+  /// Generates function which computes the hessian matrix of the given
+  /// function wrt the array parameter specified in `args` in the compressed
+  /// sparse row format. The sparsity pattern is traced at the first call and
+  /// the columns of a star coloring of the pattern are computed together by a
+  /// hessian vector product.
+  ///
+  /// \param[in] fn function to differentiate
+  /// \param[in] args independent parameters information
+  /// \returns `CladFunction` object to access the corresponding derived
+  /// function.
+  template <unsigned... BitMaskedOpts, typename ArgSpec = const char*,
+            typename F,
+            typename DerivedFnType = SparseHessianDerivedFnTraits_t<F>,
+            typename = typename std::enable_if<
+                !std::is_class<remove_reference_and_pointer_t<F>>::value>::type>
+  constexpr CladFunction<
+      DerivedFnType, ExtractFunctorTraits_t<F>> __attribute__((annotate("SH")))
+  sparse_hessian(F f, ArgSpec args = "",
+                 DerivedFnType derivedFn = static_cast<DerivedFnType>(nullptr),
+                 const char* code = "") {
+    return CladFunction<DerivedFnType, ExtractFunctorTraits_t<F>>(
+        derivedFn /* will be replaced by sparse hessian*/, code);
+  }
+
   /// Generates function which computes jacobian matrix of the given function
   /// wrt the parameters specified in `args` using reverse mode differentiation.
   ///
@@ -783,6 +982,30 @@ CUDA_HOST_DEVICE void push(tape<T[N], SBO_SIZE, SLAB_SIZE>& to, const U& val) {
         derivedFn /* will be replaced by Jacobian*/, code, f);
   }
 
+  /// Generates function which computes the jacobian matrix of the given
+  /// function wrt the array parameter specified in `args` in the compressed
+  /// sparse row format. The last parameter of the function is its output
+  /// array. The sparsity pattern is traced at the first call and the columns
+  /// sharing no row are computed together by a vector forward mode pass.
+  ///
+  /// \param[in] fn function to differentiate
+  /// \param[in] args independent parameters information
+  /// \returns `CladFunction` object to access the corresponding derived
+  /// function.
+  template <unsigned... BitMaskedOpts, typename ArgSpec = const char*,
+            typename F,
+            typename DerivedFnType = SparseJacobianDerivedFnTraits_t<F>,
+            typename = typename std::enable_if<
+                !std::is_class<remove_reference_and_pointer_t<F>>::value>::type>
+  constexpr CladFunction<
+      DerivedFnType, ExtractFunctorTraits_t<F>> __attribute__((annotate("SJ")))
+  sparse_jacobian(F f, ArgSpec args = "",
+                  DerivedFnType derivedFn = static_cast<DerivedFnType>(nullptr),
+                  const char* code = "") {
+    return CladFunction<DerivedFnType, ExtractFunctorTraits_t<F>>(
+        derivedFn /* will be replaced by sparse jacobian*/, code);
+  }
+
   template <typename ArgSpec = const char*, typename F,
             typename DerivedFnType = GradientDerivedEstFnTraits_t<F>>
   constexpr CladFunction<DerivedFnType> __attribute__((annotate("E")))
@@ -4,6 +4,7 @@
 #include "clad/Differentiator/ArrayRef.h"
 #include "clad/Differentiator/Matrix.h"
 
+#include <tuple>
 #include <type_traits>
 
 namespace clad {
@@ -36,6 +37,70 @@ namespace clad {
           sizeof(&remove_reference_and_pointer_t<C>::operator()) > 0)>::type>
       : std::true_type {};
 
+  /// Check whether the functor `Op` defines the pullback of its call operator
+  /// for a unary operation on `T`. Provides the member constant `value`.
+  template <typename Op, typename T, typename = void>
+  struct has_unary_operator_call_pullback : std::false_type {};
+
+  template <typename Op, typename T>
+  struct has_unary_operator_call_pullback<
+      Op, T,
+      decltype(std::declval<Op&>().operator_call_pullback(
+                   std::declval<T>(),          // x
+                   std::declval<T>(),          // d_y
+                   static_cast<Op*>(nullptr),  // d_op
+                   static_cast<T*>(nullptr)),  // d_x
+               void())> : std::true_type {};
+
+  /// Check whether the functor `Op` defines the pullback of its call operator
+  /// for a binary operation on `T`. Provides the member constant `value`.
+  template <typename Op, typename T, typename = void>
+  struct has_binary_operator_call_pullback : std::false_type {};
+
+  template <typename Op, typename T>
+  struct has_binary_operator_call_pullback<
+      Op, T,
+      decltype(std::declval<Op&>().operator_call_pullback(
+                   std::declval<T>(),          // x1
+                   std::declval<T>(),          // x2
+                   std::declval<T>(),          // d_y
+                   static_cast<Op*>(nullptr),  // d_op
+                   static_cast<T*>(nullptr),   // d_x1
+                   static_cast<T*>(nullptr)),  // d_x2
+               void())> : std::true_type {};
+
+  /// Check whether the functor `Op` defines the pushforward of its call
+  /// operator for a unary operation on `T`. Provides the member constant
+  /// `value`.
+  template <typename Op, typename T, typename = void>
+  struct has_unary_operator_call_pushforward : std::false_type {};
+
+  template <typename Op, typename T>
+  struct has_unary_operator_call_pushforward<
+      Op, T,
+      decltype(std::declval<Op&>().operator_call_pushforward(
+                   std::declval<T>(),               // x
+                   static_cast<const Op*>(nullptr), // d_op
+                   std::declval<T>()),              // d_x
+               void())> : std::true_type {};
+
+  /// Check whether the functor `Op` defines the pushforward of its call
+  /// operator for a binary operation on `T`. Provides the member constant
+  /// `value`.
+  template <typename Op, typename T, typename = void>
+  struct has_binary_operator_call_pushforward : std::false_type {};
+
+  template <typename Op, typename T>
+  struct has_binary_operator_call_pushforward<
+      Op, T,
+      decltype(std::declval<Op&>().operator_call_pushforward(
+                   std::declval<T>(),               // x1
+                   std::declval<T>(),               // x2
+                   static_cast<const Op*>(nullptr), // d_op
+                   std::declval<T>(),               // d_x1
+                   std::declval<T>()),              // d_x2
+               void())> : std::true_type {};
+
   /// Placeholder type for denoting no function type exists
   ///
   /// This is used by `ExtractDerivedFnTraitsForwMode` and 
@@ -718,6 +783,119 @@ namespace clad {
     using type = NoFunction*;
   };
 
+  template <class T, class = void> struct SparseJacobianDerivedFnTraits {};
+
+  // SparseJacobianDerivedFnTraits is used to deduce type of the derived
+  // functions derived using sparse jacobian mode. The derived function takes
+  // the output for the jacobian, a clad::csr_matrix of the value type of the
+  // output array, which is the last parameter of the function.
+  template <class T>
+  using SparseJacobianDerivedFnTraits_t =
+      typename SparseJacobianDerivedFnTraits<T>::type;
+
+  // SparseJacobianDerivedFnTraits specialization for pure function pointer
+  // types. Member functions are not supported by the sparse jacobian mode.
+  template <class ReturnType, class... Args>
+  struct SparseJacobianDerivedFnTraits<ReturnType (*)(Args...)> {
+    using OutputType = typename std::tuple_element<sizeof...(Args) - 1,
+                                                   std::tuple<Args...>>::type;
+    using ValueType = typename std::remove_cv<
+        remove_reference_and_pointer_t<OutputType>>::type;
+    using type = void (*)(Args..., csr_matrix<ValueType>*);
+  };
+
+  template <class T, class = void> struct SparseHessianDerivedFnTraits {};
+
+  // SparseHessianDerivedFnTraits is used to deduce type of the derived
+  // functions derived using sparse hessian mode. The derived function takes
+  // the output for the hessian, a clad::csr_matrix of the return type.
+  template <class T>
+  using SparseHessianDerivedFnTraits_t =
+      typename SparseHessianDerivedFnTraits<T>::type;
+
+  // SparseHessianDerivedFnTraits specialization for pure function pointer
+  // types. Member functions are not supported by the sparse hessian mode.
+  template <class ReturnType, class... Args>
+  struct SparseHessianDerivedFnTraits<ReturnType (*)(Args...)> {
+    using type = void (*)(Args..., csr_matrix<ReturnType>*);
+  };
+
+  template <class T, class = void> struct HessianVectorProductDerivedFnTraits {};
+
+  // HessianVectorProductDerivedFnTraits is used to deduce type of the derived
+  // functions derived using hessian vector product mode. The derived function
+  // takes the vector v and the output parameter for the product H.v.
+  template <class T>
+  using HessianVectorProductDerivedFnTraits_t =
+      typename HessianVectorProductDerivedFnTraits<T>::type;
+
+  // HessianVectorProductDerivedFnTraits specializations for pure function
+  // pointer types
+  template <class ReturnType, class... Args>
+  struct HessianVectorProductDerivedFnTraits<ReturnType (*)(Args...)> {
+    using type = void (*)(Args..., ReturnType*, ReturnType*);
+  };
+
+  /// These macro expansions are used to cover all possible cases of
+  /// qualifiers in member functions when declaring
+  /// HessianVectorProductDerivedFnTraits, in the same way as for
+  /// HessianDerivedFnTraits.
+#define HessianVectorProductDerivedFnTraits_AddSPECS(var, cv, vol, ref, noex)  \
+  template <typename R, typename C, typename... Args>                          \
+  struct HessianVectorProductDerivedFnTraits<R (C::*)(Args...) cv vol ref      \
+                                                 noex> {                       \
+    using type = void (C::*)(Args..., R*, R*) cv vol ref noex;                 \
+  };
+
+#if __cpp_noexcept_function_type > 0
+#define HessianVectorProductDerivedFnTraits_AddNOEX(var, con, vol, ref)        \
+  HessianVectorProductDerivedFnTraits_AddSPECS(var, con, vol, ref, )           \
+      HessianVectorProductDerivedFnTraits_AddSPECS(var, con, vol, ref,         \
+                                                   noexcept)
+#else
+#define HessianVectorProductDerivedFnTraits_AddNOEX(var, con, vol, ref)        \
+  HessianVectorProductDerivedFnTraits_AddSPECS(var, con, vol, ref, )
+#endif
+
+#define HessianVectorProductDerivedFnTraits_AddREF(var, con, vol)              \
+  HessianVectorProductDerivedFnTraits_AddNOEX(var, con, vol, )                 \
+      HessianVectorProductDerivedFnTraits_AddNOEX(var, con, vol, &)            \
+          HessianVectorProductDerivedFnTraits_AddNOEX(var, con, vol, &&)
+
+#define HessianVectorProductDerivedFnTraits_AddVOL(var, con)                   \
+  HessianVectorProductDerivedFnTraits_AddREF(var, con, )                       \
+      HessianVectorProductDerivedFnTraits_AddREF(var, con, volatile)
+
+#define HessianVectorProductDerivedFnTraits_AddCON(var)                        \
+  HessianVectorProductDerivedFnTraits_AddVOL(var, )                            \
+      HessianVectorProductDerivedFnTraits_AddVOL(var, const)
+
+  // Declares all the specializations
+  HessianVectorProductDerivedFnTraits_AddCON(());
+
+  /// Specialization for class types
+  /// If class have exactly one user defined call operator, then defines
+  /// member typedef `type` same as the type of the derived function of the
+  /// call operator, otherwise defines member typedef `type` as the type of
+  /// `NoFunction*`.
+  template <class F>
+  struct HessianVectorProductDerivedFnTraits<
+      F, typename std::enable_if<
+             std::is_class<remove_reference_and_pointer_t<F>>::value &&
+             has_call_operator<F>::value>::type> {
+    using ClassType =
+        typename std::decay<remove_reference_and_pointer_t<F>>::type;
+    using type = HessianVectorProductDerivedFnTraits_t<
+        decltype(&ClassType::operator())>;
+  };
+  template <class F>
+  struct HessianVectorProductDerivedFnTraits<
+      F, typename std::enable_if<
+             std::is_class<remove_reference_and_pointer_t<F>>::value &&
+             !has_call_operator<F>::value>::type> {
+    using type = NoFunction*;
+  };
+
   /// Compute type of derived function of function, method or functor when
   /// differentiated using forward differentiation mode
   /// (`clad::differentiate`). Computed type is provided as member typedef
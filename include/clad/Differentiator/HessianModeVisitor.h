@@ -15,7 +15,9 @@
 
 #include <array>
 #include <stack>
+#include <string>
 #include <unordered_map>
+#include <utility>
 
 namespace clad {
   /// A visitor for processing the function code to generate hessians
@@ -33,6 +35,37 @@ namespace clad {
           size_t TotalIndependentArgsSize, const std::string& hessianFuncName,
           clang::DeclContext* FD, clang::QualType hessianFuncType);
 
+    /// Derives the gradient of the function w.r.t. the requested args in
+    /// reverse mode, then differentiates the gradient in the forward \p mode.
+    ///
+    ///\returns the gradient and its derivative, or nulls on error.
+    std::pair<clang::FunctionDecl*, clang::FunctionDecl*>
+    DeriveGradientTangent(DiffMode mode);
+
+    /// Builds f_hessian_dvec, which computes the whole hessian matrix by
+    /// differentiating the gradient of the function in vector forward mode
+    /// w.r.t. all the independent args at once.
+    DerivativeAndOverload
+    DeriveVectorized(const DiffParams& args, const std::string& hessianFuncName,
+                     clang::DeclContext* DC, clang::QualType hessianFuncType);
+
+    /// Builds f_hessian_vector_product, which computes the product of the
+    /// hessian with a vector v by differentiating the gradient of the function
+    /// in forward mode in the direction v, without forming the hessian.
+    DerivativeAndOverload DeriveHessianVectorProduct(
+        const DiffParams& args, const IndexIntervalTable& indexIntervalTable,
+        const std::string& hessianFuncName, clang::DeclContext* DC,
+        clang::QualType hessianFuncType);
+
+    /// Builds f_hessian_sparse, which computes the hessian w.r.t. an array in
+    /// a clad::csr_matrix with one hessian vector product per color of a
+    /// clad::hessian_sweep, differentiating the pushforward of the function in
+    /// reverse mode.
+    DerivativeAndOverload DeriveSparse(const DiffParams& args,
+                                       const std::string& hessianFuncName,
+                                       clang::DeclContext* DC,
+                                       clang::QualType hessianFuncType);
+
   public:
     HessianModeVisitor(DerivativeBuilder& builder, const DiffRequest& request);
     ~HessianModeVisitor() override = default;
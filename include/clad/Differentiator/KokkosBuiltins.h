@@ -8,7 +8,9 @@
 #include <Kokkos_Core.hpp>
 #include <cstddef>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include "clad/Differentiator/Differentiator.h"
 
 namespace clad::custom_derivatives {
@@ -57,6 +59,67 @@ void constructor_pullback(
     unsigned long* /*d_idx0*/, size_t* /*d_idx1*/, size_t* /*d_idx2*/,
     size_t* /*d_idx3*/, size_t* /*d_idx4*/, size_t* /*d_idx5*/,
     size_t* /*d_idx5*/, size_t* /*d_idx6*/);
+/// Kokkos scratch arrays of a team
+// The tangent or the adjoint of a scratch view is allocated in the scratch
+// memory of the team right after the view, see Kokkos::diff_policy.
+template <class View>
+using scratch_memory_space_of =
+    typename View::traits::execution_space::scratch_memory_space;
+template <class DataType, class... ViewParams>
+clad::ValueAndPushforward<::Kokkos::View<DataType, ViewParams...>,
+                          ::Kokkos::View<DataType, ViewParams...>>
+constructor_pushforward(
+    clad::Tag<::Kokkos::View<DataType, ViewParams...>>,
+    const scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>&
+        space,
+    const size_t& idx0, const size_t& idx1, const size_t& idx2,
+    const size_t& idx3, const size_t& idx4, const size_t& idx5,
+    const size_t& idx6, const size_t& idx7,
+    const scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>&
+    /*d_space*/,
+    const size_t& /*d_idx0*/, const size_t& /*d_idx1*/,
+    const size_t& /*d_idx2*/, const size_t& /*d_idx3*/,
+    const size_t& /*d_idx4*/, const size_t& /*d_idx5*/,
+    const size_t& /*d_idx6*/, const size_t& /*d_idx7*/) {
+  return {::Kokkos::View<DataType, ViewParams...>(space, idx0, idx1, idx2, idx3,
+                                                  idx4, idx5, idx6, idx7),
+          ::Kokkos::View<DataType, ViewParams...>(space, idx0, idx1, idx2, idx3,
+                                                  idx4, idx5, idx6, idx7)};
+}
+template <class DataType, class... ViewParams>
+clad::ValueAndAdjoint<::Kokkos::View<DataType, ViewParams...>,
+                      ::Kokkos::View<DataType, ViewParams...>>
+constructor_reverse_forw(
+    clad::Tag<::Kokkos::View<DataType, ViewParams...>>,
+    const scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>&
+        space,
+    const size_t idx0, const size_t idx1, const size_t idx2, const size_t idx3,
+    const size_t idx4, const size_t idx5, const size_t idx6, const size_t idx7,
+    const scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>&
+    /*d_space*/,
+    const size_t /*d_idx0*/, const size_t /*d_idx1*/, const size_t /*d_idx2*/,
+    const size_t /*d_idx3*/, const size_t /*d_idx4*/, const size_t /*d_idx5*/,
+    const size_t /*d_idx6*/, const size_t /*d_idx7*/) {
+  ::Kokkos::View<DataType, ViewParams...> v(space, idx0, idx1, idx2, idx3, idx4,
+                                            idx5, idx6, idx7);
+  ::Kokkos::View<DataType, ViewParams...> d_v(space, idx0, idx1, idx2, idx3,
+                                              idx4, idx5, idx6, idx7);
+  // The adjoints start from zero, see Kokkos::zero_diff_scratch.
+  return {v, d_v};
+}
+template <class DataType, class... ViewParams>
+void constructor_pullback(
+    const scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>&
+    /*space*/,
+    const size_t /*idx0*/, const size_t /*idx1*/, const size_t /*idx2*/,
+    const size_t /*idx3*/, const size_t /*idx4*/, const size_t /*idx5*/,
+    const size_t /*idx6*/, const size_t /*idx7*/,
+    ::Kokkos::View<DataType, ViewParams...>* /*d_this*/,
+    scratch_memory_space_of<::Kokkos::View<DataType, ViewParams...>>*
+    /*d_space*/,
+    size_t* /*d_idx0*/, size_t* /*d_idx1*/, size_t* /*d_idx2*/,
+    size_t* /*d_idx3*/, size_t* /*d_idx4*/, size_t* /*d_idx5*/,
+    size_t* /*d_idx6*/, size_t* /*d_idx7*/) {}
 /// View indexing
 template <typename View, typename Idx>
 inline clad::ValueAndPushforward<typename View::reference_type,
@@ -318,6 +381,84 @@ void operator_call_pullback(const ::Kokkos::View<DataType, ViewParams...>* v,
                             dIdx6* /*d_i3*/, dIdx7* /*d_i3*/) {
   (*d_v)(i0, i1, i2, i3, i4, i5, i6, i7) += d_y;
 }
+/// Team handles
+// The ranks and the sizes of a team are not differentiable.
+template <class Member>
+clad::ValueAndPushforward<int, int>
+league_rank_pushforward(const Member* team, const Member* /*d_team*/) {
+  return {team->league_rank(), 0};
+}
+template <class Member, class... Args>
+void league_rank_pullback(const Member* /*team*/, Args... /*args*/) {}
+template <class Member>
+clad::ValueAndPushforward<int, int>
+league_size_pushforward(const Member* team, const Member* /*d_team*/) {
+  return {team->league_size(), 0};
+}
+template <class Member, class... Args>
+void league_size_pullback(const Member* /*team*/, Args... /*args*/) {}
+template <class Member>
+clad::ValueAndPushforward<int, int>
+team_rank_pushforward(const Member* team, const Member* /*d_team*/) {
+  return {team->team_rank(), 0};
+}
+template <class Member, class... Args>
+void team_rank_pullback(const Member* /*team*/, Args... /*args*/) {}
+template <class Member>
+clad::ValueAndPushforward<int, int>
+team_size_pushforward(const Member* team, const Member* /*d_team*/) {
+  return {team->team_size(), 0};
+}
+template <class Member, class... Args>
+void team_size_pullback(const Member* /*team*/, Args... /*args*/) {}
+// The adjoints accumulated in the scratch by a thread are read by the others
+// once the barrier is passed in the reverse pass too.
+template <class Member>
+void team_barrier_pushforward(const Member* team, const Member* /*d_team*/) {
+  team->team_barrier();
+}
+template <class Member>
+void team_barrier_pullback(const Member* team, Member* /*d_team*/) {
+  team->team_barrier();
+}
+// The tangents and the adjoints of the scratch views are allocated in the
+// scratch memory of the team as well.
+template <class Member>
+clad::ValueAndPushforward<
+    decltype(::std::declval<const Member&>().team_scratch(0)),
+    decltype(::std::declval<const Member&>().team_scratch(0))>
+team_scratch_pushforward(const Member* team, int level,
+                         const Member* /*d_team*/, int /*d_level*/) {
+  return {team->team_scratch(level), team->team_scratch(level)};
+}
+template <class Member>
+clad::ValueAndAdjoint<
+    decltype(::std::declval<const Member&>().team_scratch(0)),
+    decltype(::std::declval<const Member&>().team_scratch(0))>
+team_scratch_reverse_forw(const Member* team, int level,
+                          const Member* /*d_team*/, int /*d_level*/) {
+  return {team->team_scratch(level), team->team_scratch(level)};
+}
+template <class Member, class... Args>
+void team_scratch_pullback(const Member* /*team*/, Args... /*args*/) {}
+template <class Member>
+clad::ValueAndPushforward<
+    decltype(::std::declval<const Member&>().thread_scratch(0)),
+    decltype(::std::declval<const Member&>().thread_scratch(0))>
+thread_scratch_pushforward(const Member* team, int level,
+                           const Member* /*d_team*/, int /*d_level*/) {
+  return {team->thread_scratch(level), team->thread_scratch(level)};
+}
+template <class Member>
+clad::ValueAndAdjoint<
+    decltype(::std::declval<const Member&>().thread_scratch(0)),
+    decltype(::std::declval<const Member&>().thread_scratch(0))>
+thread_scratch_reverse_forw(const Member* team, int level,
+                            const Member* /*d_team*/, int /*d_level*/) {
+  return {team->thread_scratch(level), team->thread_scratch(level)};
+}
+template <class Member, class... Args>
+void thread_scratch_pullback(const Member* /*team*/, Args... /*args*/) {}
 } // namespace class_functions
 
 /// Kokkos functions (view utils)
@@ -510,6 +651,96 @@ template <typename S> void fence_pushforward(const S& s, const S& /*d_s*/) {
 }
 template <typename... Args> void fence_pullback(Args...) { ::Kokkos::fence(); }
 
+/// Parallel dispatch helpers
+// Whether the policy is a range of the threads or the vector lanes of a team,
+// e.g. TeamThreadRange, which is iterated without a label.
+template <class Policy>
+constexpr bool is_nested_policy =
+    !::Kokkos::is_execution_policy<Policy>::value &&
+    !::std::is_integral<Policy>::value;
+// Whether the iterations of the nested policy are split among the threads of
+// the team, rather than among the vector lanes of a thread.
+template <class Policy> struct is_team_range : ::std::false_type {};
+template <class IType, class Member>
+struct is_team_range<
+    ::Kokkos::Impl::TeamThreadRangeBoundariesStruct<IType, Member>>
+    : ::std::true_type {};
+template <class IType, class Member>
+struct is_team_range<
+    ::Kokkos::Impl::TeamVectorRangeBoundariesStruct<IType, Member>>
+    : ::std::true_type {};
+// The tangent passed to the pushforward of a functor for one of its arguments:
+// zero for the indices, the argument itself for the work tag and the team
+// handle, which are not differentiable.
+template <class T> decltype(auto) diff_functor_arg_tangent(const T& arg) {
+  if constexpr (::std::is_arithmetic<T>::value)
+    return T();
+  else
+    return (arg);
+}
+// The adjoint passed to the pullback of a functor for one of its arguments,
+// see diff_functor_arg_tangent.
+template <class T, bool IsIndex = ::std::is_arithmetic<T>::value>
+struct diff_functor_arg_adjoint {
+  T m_Adjoint{};
+  diff_functor_arg_adjoint(const T& /*arg*/) {}
+  T* get() { return &m_Adjoint; }
+};
+template <class T> struct diff_functor_arg_adjoint<T, false> {
+  T* m_Arg;
+  diff_functor_arg_adjoint(const T& arg) : m_Arg(const_cast<T*>(&arg)) {}
+  T* get() { return m_Arg; }
+};
+// Calls \p f with the adjoints of the arguments \p args of a functor.
+template <class F, class... Args>
+void diff_call_with_arg_adjoints(F&& f, const Args&... args) {
+  ::std::tuple<diff_functor_arg_adjoint<Args>...> d_args(args...);
+  ::std::apply([&f](auto&... d_arg) { f(d_arg.get()...); }, d_args);
+}
+// The policy running the derivative of a loop. The derivatives of the team
+// kernels allocate the tangents or the adjoints of their scratch views after
+// them, thus request twice the scratch memory of the primal kernel.
+template <class Policy> const Policy& diff_policy(const Policy& policy) {
+  return policy;
+}
+template <class... Properties>
+::Kokkos::TeamPolicy<Properties...>
+diff_policy(const ::Kokkos::TeamPolicy<Properties...>& policy) {
+  ::Kokkos::TeamPolicy<Properties...> res = policy;
+  for (int level = 0; level < 2; ++level)
+    res = res.set_scratch_size(
+        level, ::Kokkos::PerTeam(2 * policy.team_scratch_size(level)),
+        ::Kokkos::PerThread(2 * policy.thread_scratch_size(level)));
+  return res;
+}
+// The adjoints of the scratch views are accumulated, thus the threads of every
+// team of the adjoint kernel zero its scratch memory together before running
+// the pullback of the functor, whose arguments are \p args.
+template <class Policy, class... Args>
+void zero_diff_scratch(const Policy& /*policy*/, const Args&... /*args*/) {}
+template <class... Properties, class... Args>
+void zero_diff_scratch(const ::Kokkos::TeamPolicy<Properties...>& policy,
+                       const Args&... args) {
+  // The team handle follows the work tag, if any. The scratch space is copied
+  // so that the memory taken here is still free for the kernel.
+  const auto& team = ::std::get<sizeof...(Args) - 1>(::std::tie(args...));
+  for (int level = 0; level < 2; ++level) {
+    if (::std::size_t size = 2 * policy.team_scratch_size(level)) {
+      auto space = team.team_scratch(level);
+      char* data = static_cast<char*>(space.get_shmem(size));
+      ::Kokkos::parallel_for(::Kokkos::TeamThreadRange(team, size),
+                             [data](::std::size_t i) { data[i] = 0; });
+    }
+    if (::std::size_t size = 2 * policy.thread_scratch_size(level)) {
+      auto space = team.thread_scratch(level);
+      char* data = static_cast<char*>(space.get_shmem(size));
+      ::Kokkos::parallel_for(::Kokkos::ThreadVectorRange(team, size),
+                             [data](::std::size_t i) { data[i] = 0; });
+    }
+  }
+  team.team_barrier();
+}
+
 /// Parallel for (forward mode)
 template <class... PolicyParams, class FunctorType> // range policy
 void parallel_for_pushforward(
@@ -717,12 +948,35 @@ void parallel_for_pushforward(const ::std::string& str, const Policy& policy,
                                                                    functor,
                                                                    d_functor);
 }
-template <class Policy, class FunctorType> // anonymous loop
+template <class... Properties, class FunctorType> // team policy
+void parallel_for_pushforward(
+    const ::std::string& str, const ::Kokkos::TeamPolicy<Properties...>& policy,
+    const FunctorType& functor, const ::std::string& /*d_str*/,
+    const ::Kokkos::TeamPolicy<Properties...>& /*d_policy*/,
+    const FunctorType& d_functor) {
+  ::Kokkos::parallel_for(str, policy, functor);
+  ::Kokkos::parallel_for("_diff_" + str, diff_policy(policy),
+                         [&functor, &d_functor](const auto&... args) {
+                           functor.operator_call_pushforward(
+                               args..., &d_functor,
+                               diff_functor_arg_tangent(args)...);
+                         });
+}
+template <class Policy, class FunctorType> // anonymous or nested loop
 void parallel_for_pushforward(const Policy& policy, const FunctorType& functor,
                               const Policy& d_policy,
                               const FunctorType& d_functor) {
-  parallel_for_pushforward(::std::string("anonymous_parallel_for"), policy,
-                           functor, ::std::string(""), d_policy, d_functor);
+  if constexpr (is_nested_policy<Policy>) {
+    // The pushforward computes the primal iteration as well, the iterations
+    // of a team range are thus run once.
+    ::Kokkos::parallel_for(policy, [&functor, &d_functor](const auto& i) {
+      functor.operator_call_pushforward(i, &d_functor,
+                                        diff_functor_arg_tangent(i));
+    });
+  } else {
+    parallel_for_pushforward(::std::string("anonymous_parallel_for"), policy,
+                             functor, ::std::string(""), d_policy, d_functor);
+  }
 }
 template <class Policy, class FunctorType> // anonymous loop
 void parallel_for_pushforward(
@@ -753,10 +1007,39 @@ void parallel_for_pushforward(
 }
 
 /// Parallel for (reverse mode)
-template <typename F>
-void parallel_for_pullback(const size_t work_count, const F& functor,
-                           size_t* d_work_count, F* d_functor) {
-  // TODO: implement parallel_for pullbacks
+// The iterations of the loop are independent, the adjoint loop is thus a
+// parallel_for over the same policy. Like in the primal loop, the adjoints
+// updated by the iterations have to be distinct, except the ones of the
+// scalar members of the functor, which all iterations share and which the
+// pullback of the functor updates with Kokkos::atomic_add.
+template <class Policy, class FunctorType>
+void parallel_for_pullback(const ::std::string& str, const Policy& policy,
+                           const FunctorType& functor, ::std::string* /*d_str*/,
+                           Policy* /*d_policy*/, FunctorType* d_functor) {
+  ::Kokkos::parallel_for("_diff_" + str, diff_policy(policy),
+                         [&policy, &functor, d_functor](const auto&... args) {
+                           zero_diff_scratch(policy, args...);
+                           diff_call_with_arg_adjoints(
+                               [&](auto*... d_arg) {
+                                 functor.operator_call_pullback(
+                                     args..., d_functor, d_arg...);
+                               },
+                               args...);
+                         });
+}
+template <class Policy, class FunctorType> // anonymous or nested loop
+void parallel_for_pullback(const Policy& policy, const FunctorType& functor,
+                           Policy* d_policy, FunctorType* d_functor) {
+  if constexpr (is_nested_policy<Policy>) {
+    ::Kokkos::parallel_for(policy, [&functor, d_functor](const auto& i) {
+      diff_call_with_arg_adjoints(
+          [&](auto* d_i) { functor.operator_call_pullback(i, d_functor, d_i); },
+          i);
+    });
+  } else {
+    parallel_for_pullback(::std::string("anonymous_parallel_for"), policy,
+                          functor, nullptr, d_policy, d_functor);
+  }
 }
 
 /// Parallel reduce (forward mode)
@@ -1015,6 +1298,33 @@ struct diff_parallel_reduce_MDP_dispatch<
                                                                       d_res);
   }
 };
+template <class... Properties, class FunctorType, class Reduced>
+struct diff_parallel_reduce_MDP_dispatch<::Kokkos::TeamPolicy<Properties...>,
+                                         FunctorType, Reduced, void,
+                                         0> { // TeamPolicy
+  static void run(const ::std::string& str,
+                  const ::Kokkos::TeamPolicy<Properties...>& policy,
+                  const FunctorType& functor, Reduced& res,
+                  const FunctorType& d_functor, Reduced& d_res) {
+    using WorkTag =
+        typename ::Kokkos::TeamPolicy<Properties...>::work_tag;
+    if constexpr (::std::is_void<WorkTag>::value)
+      ::Kokkos::parallel_reduce(
+          "_diff_" + str, diff_policy(policy),
+          [&](const auto& team, auto& r, auto& d_r) {
+            functor.operator_call_pushforward(team, r, &d_functor, team, d_r);
+          },
+          res, d_res);
+    else
+      ::Kokkos::parallel_reduce(
+          "_diff_" + str, diff_policy(policy),
+          [&](const auto _work_tag, const auto& team, auto& r, auto& d_r) {
+            functor.operator_call_pushforward(_work_tag, team, r, &d_functor,
+                                              _work_tag, team, d_r);
+          },
+          res, d_res);
+  }
+};
 // This structure is used to dispatch parallel reduce pushforward calls for
 // integral policies
 template <class Policy, class FunctorType, class Reduced, bool isInt>
@@ -1052,6 +1362,90 @@ void parallel_reduce_pushforward(const ::std::string& str, const Policy& policy,
       ::std::is_integral<Policy>::value>::run(str, policy, functor, res,
                                               d_functor, d_res);
 }
+template <class Policy, class FunctorType,
+          class Reduced> // anonymous or nested loop
+void parallel_reduce_pushforward(const Policy& policy,
+                                 const FunctorType& functor, Reduced& res,
+                                 const Policy& d_policy,
+                                 const FunctorType& d_functor, Reduced& d_res) {
+  if constexpr (is_nested_policy<Policy>) {
+    // A team-level reduction, whose result is known by all the threads of the
+    // team. The tangent of the sum is the sum of the tangents.
+    ::Kokkos::parallel_reduce(policy, functor, res);
+    ::Kokkos::parallel_reduce(
+        policy,
+        [&functor, &d_functor](const auto& i, Reduced& d_r) {
+          Reduced r{};
+          functor.operator_call_pushforward(i, r, &d_functor,
+                                            diff_functor_arg_tangent(i), d_r);
+        },
+        d_res);
+  } else {
+    parallel_reduce_pushforward(::std::string("anonymous_parallel_reduce"),
+                                policy, functor, res, ::std::string(""),
+                                d_policy, d_functor, d_res);
+  }
+}
+
+/// Parallel reduce (reverse mode)
+// The reductions are sums, the default of Kokkos for scalar results, thus the
+// adjoint of the contribution of every iteration is the adjoint of the result
+// and the iterations of the adjoint loop are independent. They run as a
+// parallel_for over the policy of the primal loop, for range,
+// multi-dimensional, team and integral policies alike. Like in the primal
+// loop, the adjoints updated by the iterations have to be distinct, e.g. the
+// elements of the views indexed by the iteration. The adjoints of the scalar
+// members of the functor are updated atomically, see parallel_for_pullback.
+template <class Policy, class FunctorType, class Reduced>
+void parallel_reduce_pullback(const ::std::string& str, const Policy& policy,
+                              const FunctorType& functor, Reduced& /*res*/,
+                              ::std::string* /*d_str*/, Policy* /*d_policy*/,
+                              FunctorType* d_functor, Reduced* d_res) {
+  // The result is overwritten by the reduction.
+  Reduced d_r = *d_res;
+  *d_res = {};
+  ::Kokkos::parallel_for(
+      "_diff_" + str, diff_policy(policy),
+      [&policy, &functor, d_functor, d_r](const auto&... args) {
+        zero_diff_scratch(policy, args...);
+        Reduced r{};
+        Reduced d_r_i = d_r;
+        diff_call_with_arg_adjoints(
+            [&](auto*... d_arg) {
+              functor.operator_call_pullback(args..., r, d_functor, d_arg...,
+                                             &d_r_i);
+            },
+            args...);
+      });
+}
+template <class Policy, class FunctorType,
+          class Reduced> // anonymous or nested loop
+void parallel_reduce_pullback(const Policy& policy, const FunctorType& functor,
+                              Reduced& res, Policy* d_policy,
+                              FunctorType* d_functor, Reduced* d_res) {
+  if constexpr (is_nested_policy<Policy>) {
+    // Every thread of the team holds the result, whose adjoint is thus the
+    // sum of the adjoints of the threads. Each of them pulls it back through
+    // its share of the iterations.
+    Reduced d_r = *d_res;
+    *d_res = {};
+    if constexpr (is_team_range<Policy>::value)
+      policy.member.team_reduce(::Kokkos::Sum<Reduced>(d_r));
+    ::Kokkos::parallel_for(policy, [&functor, d_functor, d_r](const auto& i) {
+      Reduced r{};
+      Reduced d_r_i = d_r;
+      diff_call_with_arg_adjoints(
+          [&](auto* d_i) {
+            functor.operator_call_pullback(i, r, d_functor, d_i, &d_r_i);
+          },
+          i);
+    });
+  } else {
+    parallel_reduce_pullback(::std::string("anonymous_parallel_reduce"),
+                             policy, functor, res, nullptr, d_policy,
+                             d_functor, d_res);
+  }
+}
 
 } // namespace Kokkos
 } // namespace clad::custom_derivatives
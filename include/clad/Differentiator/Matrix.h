@@ -86,6 +86,10 @@ public:
     return clad::array_ref<T>(m_data).slice(row_idx * m_cols, m_cols);
   }
 
+  /// Returns the reference to the first row. The matrix is the derivative of
+  /// a pointer in vector mode, this is the derivative of the pointee.
+  CUDA_HOST_DEVICE clad::array_ref<T> operator*() { return (*this)[0]; }
+
   /// Adding constant to matrix.
   template <typename U, typename std::enable_if<std::is_arithmetic<U>::value,
                                                 int>::type = 0>
@@ -168,6 +172,100 @@ public:
   }
 }; // class matrix
 
+/// A sparse matrix in the compressed sparse row (CSR) format, used by the
+/// sparse derivative modes instead of a dense clad::matrix. The nonzeros of
+/// row i are values()[row_ptr()[i]] ... values()[row_ptr()[i + 1] - 1], in the
+/// columns col_idx()[row_ptr()[i]] ... col_idx()[row_ptr()[i + 1] - 1], which
+/// are sorted in increasing order.
+///
+/// The sparsity pattern is determined by the first evaluation of a sparse
+/// derivative into the matrix and reused by the following ones. It belongs to
+/// the control flow taken by that evaluation; call clear_pattern() to detect
+/// it again, e.g. when branches depending on the inputs change.
+template <typename T> class csr_matrix {
+private:
+  /// The number of rows in the matrix.
+  size_t m_rows;
+  /// The number of columns in the matrix.
+  size_t m_cols;
+  /// Whether the sparsity pattern is known.
+  bool m_has_pattern = false;
+  /// The offsets of the rows in m_col_idx and m_values, of size rows + 1.
+  clad::array<size_t> m_row_ptr;
+  /// The column of each nonzero.
+  clad::array<size_t> m_col_idx;
+  /// The value of each nonzero.
+  clad::array<T> m_values;
+
+public:
+  /// Delete the default constructor.
+  csr_matrix() = delete;
+
+  /// Construct an empty matrix of size rows x cols, without sparsity pattern.
+  CUDA_HOST_DEVICE csr_matrix(size_t rows, size_t cols)
+      : m_rows(rows), m_cols(cols), m_row_ptr(rows + 1) {}
+
+  /// Returns the number of rows in the matrix.
+  CUDA_HOST_DEVICE size_t rows() const { return m_rows; }
+
+  /// Returns the number of columns in the matrix.
+  CUDA_HOST_DEVICE size_t cols() const { return m_cols; }
+
+  /// Returns the number of nonzeros in the sparsity pattern.
+  CUDA_HOST_DEVICE size_t nnz() const { return m_row_ptr[m_rows]; }
+
+  /// Returns true if the sparsity pattern is known.
+  CUDA_HOST_DEVICE bool has_pattern() const { return m_has_pattern; }
+
+  /// Sets the sparsity pattern and zeroes the values. row_ptr has rows + 1
+  /// elements and col_idx has row_ptr[rows] elements.
+  CUDA_HOST_DEVICE void set_pattern(clad::array<size_t> row_ptr,
+                                    clad::array<size_t> col_idx) {
+    assert(row_ptr.size() == m_rows + 1 && col_idx.size() == row_ptr[m_rows]);
+    m_row_ptr = std::move(row_ptr);
+    m_col_idx = std::move(col_idx);
+    m_values = clad::array<T>(m_col_idx.size());
+    m_has_pattern = true;
+  }
+
+  /// Forgets the sparsity pattern and the values.
+  CUDA_HOST_DEVICE void clear_pattern() {
+    m_row_ptr = clad::array<size_t>(m_rows + 1);
+    m_col_idx = clad::array<size_t>();
+    m_values = clad::array<T>();
+    m_has_pattern = false;
+  }
+
+  /// Returns the row offsets of the matrix.
+  CUDA_HOST_DEVICE const size_t* row_ptr() const { return m_row_ptr.ptr(); }
+
+  /// Returns the columns of the nonzeros.
+  CUDA_HOST_DEVICE const size_t* col_idx() const { return m_col_idx.ptr(); }
+
+  /// Returns the values of the nonzeros.
+  CUDA_HOST_DEVICE T* values() { return m_values.ptr(); }
+  CUDA_HOST_DEVICE const T* values() const { return m_values.ptr(); }
+
+  /// Returns the element at the given row and column, which is zero if it is
+  /// not in the sparsity pattern.
+  CUDA_HOST_DEVICE T operator()(size_t row, size_t col) const {
+    assert(row < m_rows && col < m_cols);
+    // Binary search of the column in the row.
+    size_t lo = m_row_ptr[row];
+    size_t hi = m_row_ptr[row + 1];
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (m_col_idx[mid] < col)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo < m_row_ptr[row + 1] && m_col_idx[lo] == col)
+      return m_values[lo];
+    return static_cast<T>(0);
+  }
+}; // class csr_matrix
+
 // Function for creating an identity matrix of size rows x cols, with the
 // diagonal offset by diag_offset.
 // For example, identity_matrix(3, 3, 1) returns:
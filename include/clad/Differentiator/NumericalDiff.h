@@ -6,47 +6,162 @@
 #include "FunctionTraits.h"
 #include "Tape.h"
 
+#include <algorithm>
 #include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <limits>
 #include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#if defined(CLAD_NUM_DIFF_THREADS) && CLAD_NUM_DIFF_THREADS > 1
+#include "BatchExecution.h"
+#endif
 
 namespace numerical_diff {
 
+  /// A bump-pointer arena for the copies of the arguments perturbed by the
+  /// numerical differentiation. The memory is taken from a chain of blocks
+  /// which are kept when the arena is reset, thus after the first call of a
+  /// target function the copies cost a pointer increment each, and reset()
+  /// is O(1) if no objects with non-trivial destructors were registered.
+  class buffer_arena {
+    struct Block {
+      Block* next;
+      std::size_t size;
+    };
+    /// The objects with non-trivial destructors, stored in the arena.
+    struct Destructor {
+      void (*destroy)(void* ptr, std::size_t n);
+      void* ptr;
+      std::size_t n;
+      Destructor* next;
+    };
+    static constexpr std::size_t kMinBlockSize = 4096;
+    static constexpr std::size_t kHeaderSize =
+        (sizeof(Block) + alignof(std::max_align_t) - 1) /
+        alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    Block* m_First = nullptr;
+    /// The block the memory is taken from.
+    Block* m_Current = nullptr;
+    std::uintptr_t m_Ptr = 0;
+    std::uintptr_t m_End = 0;
+    /// The last registered destructor.
+    Destructor* m_Destructors = nullptr;
+
+    static std::uintptr_t data(Block* block) {
+      return reinterpret_cast<std::uintptr_t>(block) + kHeaderSize;
+    }
+    void use(Block* block) {
+      m_Current = block;
+      m_Ptr = data(block);
+      m_End = m_Ptr + block->size;
+    }
+    /// Continues in the next block if it has at least \p size bytes, otherwise
+    /// in a new one inserted after the current block.
+    void grow(std::size_t size) {
+      Block* next = m_Current ? m_Current->next : m_First;
+      if (next && next->size >= size) {
+        use(next);
+        return;
+      }
+      std::size_t blockSize = m_Current ? 2 * m_Current->size : kMinBlockSize;
+      blockSize = std::max(blockSize, size);
+      auto* block = static_cast<Block*>(malloc(kHeaderSize + blockSize));
+      if (!block)
+        throw std::bad_alloc();
+      block->next = next;
+      block->size = blockSize;
+      if (m_Current)
+        m_Current->next = block;
+      else
+        m_First = block;
+      use(block);
+    }
+    template <typename T> static void destroy(void* ptr, std::size_t n) {
+      for (std::size_t i = 0; i < n; i++)
+        static_cast<T*>(ptr)[i].~T();
+    }
+
+  public:
+    buffer_arena() = default;
+    buffer_arena(const buffer_arena&) = delete;
+    buffer_arena& operator=(const buffer_arena&) = delete;
+    ~buffer_arena() {
+      reset();
+      while (m_First) {
+        Block* next = m_First->next;
+        free(m_First);
+        m_First = next;
+      }
+    }
+
+    /// \returns \p size bytes of memory aligned to \p align, valid until the
+    /// next reset().
+    void* allocate(std::size_t size, std::size_t align) {
+      std::uintptr_t ptr = (m_Ptr + align - 1) & ~(std::uintptr_t)(align - 1);
+      if (!m_Current || ptr + size > m_End) {
+        grow(size + align);
+        ptr = (m_Ptr + align - 1) & ~(std::uintptr_t)(align - 1);
+      }
+      m_Ptr = ptr + size;
+      return reinterpret_cast<void*>(ptr);
+    }
+
+    /// Makes reset() destroy the \p n objects of type \p T at \p ptr.
+    template <typename T> void register_destructor(T* ptr, std::size_t n) {
+      if (std::is_trivially_destructible<T>::value || !n)
+        return;
+      auto* record = static_cast<Destructor*>(
+          allocate(sizeof(Destructor), alignof(Destructor)));
+      using Object = typename std::remove_cv<T>::type;
+      *record = {&destroy<Object>, const_cast<Object*>(ptr), n, m_Destructors};
+      m_Destructors = record;
+    }
+
+    /// Destroys the registered objects, in the reverse order of their
+    /// registration, and makes the whole memory of the arena available.
+    void reset() {
+      for (; m_Destructors; m_Destructors = m_Destructors->next)
+        m_Destructors->destroy(m_Destructors->ptr, m_Destructors->n);
+      if (m_First)
+        use(m_First);
+    }
+  };
+
   /// A class to keep track of the memory we allocate to make sure it is
-  /// deallocated later.
+  /// deallocated later. The buffers are taken from a buffer_arena.
   class ManageBufferSpace {
-    /// A tape of shared pointers so we don't have to do memory management
-    /// ourselves.
-    clad::tape_impl<void*> data = {};
+    buffer_arena m_Arena;
 
   public:
-    ~ManageBufferSpace() { free_buffer(); }
-
     /// A function to make some buffer space and construct object in place
-    /// if the given type has a trivial destructor and construction is
-    /// requested. This provided so that users can numerically differentiate
-    /// functions that take pointers to user-defined data types.
-    /// FIXME: implement type-erasure to support types with non-trivial
-    /// destructors.
+    /// if construction is requested. This provided so that users can
+    /// numerically differentiate functions that take pointers to user-defined
+    /// data types. The constructed object is destroyed by free_buffer().
     ///
     /// \tparam T the type of buffer to make.
     /// \param[in] \c n The length for the buffer.
     /// \param[in] \c constructInPlace True if an object has to be constructed
-    /// in place. Use for trivially constructable types ONLY.
+    /// in place.
     /// \param[in] \c args Arguments to forward to the constructor.
     ///
     /// \returns A raw pointer to the newly created buffer.
-    template <typename T, typename... Args,
-              typename std::enable_if<std::is_trivially_destructible<T>::value,
-                                      bool>::type = true>
+    template <typename T, typename... Args>
     T* make_buffer_space(std::size_t n, bool constructInPlace, Args&&... args) {
-      void* ptr = malloc(n * sizeof(T));
+      T* ptr = make_buffer_space<T>(n);
       if (constructInPlace) {
-        ::new (ptr) T(std::forward<Args>(args)...);
+        ::new (static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+        m_Arena.register_destructor(ptr, 1);
       }
-      data.emplace_back(ptr);
-      return static_cast<T*>(ptr);
+      return ptr;
     }
 
     /// A function to make some buffer space.
@@ -56,25 +171,31 @@ namespace numerical_diff {
     ///
     /// \returns A raw pointer to the newly created buffer.
     template <typename T> T* make_buffer_space(std::size_t n) {
-      void* ptr = malloc(n * sizeof(T));
-      data.emplace_back(ptr);
-      return static_cast<T*>(ptr);
+      return static_cast<T*>(m_Arena.allocate(n * sizeof(T), alignof(T)));
     }
 
-    /// A function to free the space previously allocated.
-    void free_buffer() {
-      while (data.size()) {
-        void* ptr = data.back();
-        data.pop_back();
-        free(ptr);
-      }
+    /// A function to make a buffer with copies of the \p n objects at \p src.
+    /// The copies are destroyed by free_buffer().
+    ///
+    /// \returns A raw pointer to the newly created buffer.
+    template <typename T> T* copy_buffer_space(const T* src, std::size_t n) {
+      T* ptr = make_buffer_space<T>(n);
+      for (std::size_t i = 0; i < n; i++)
+        ::new (static_cast<void*>(ptr + i)) T(src[i]);
+      m_Arena.register_destructor(ptr, n);
+      return ptr;
     }
+
+    /// A function to free the space previously allocated.
+    void free_buffer() { m_Arena.reset(); }
   };
 
   /// A buffer manager to request for buffer space
-  /// while forwarding reference/pointer args to the target function.
+  /// while forwarding reference/pointer args to the target function. Every
+  /// thread has its own, which makes the numerical differentiation safe to
+  /// call from several threads.
   inline ManageBufferSpace& getBufferManager() {
-    static ManageBufferSpace bufMan;
+    static thread_local ManageBufferSpace bufMan;
     return bufMan;
   }
 
@@ -122,7 +243,8 @@ namespace numerical_diff {
   ///
   /// \param[in] \c derivError The error associated with numerically
   /// differentiating a function. This error is calculated by the remainder term
-  /// on expanding the five-point stencil series.
+  /// on expanding the five-point stencil series, or estimated from the
+  /// Richardson extrapolation table.
   /// \param[in] \c evalError This error is associated with the evaluation of
   /// the target functions.
   /// \param[in] \c paramPos The position of the parameter to which this error
@@ -136,7 +258,11 @@ namespace numerical_diff {
              paramPos, arrPos);
     else
       printf("\nError Report for parameter at position %d:\n", paramPos);
+#ifdef CLAD_NUM_DIFF_RICHARDSON
+    printf("Error due to the Richardson extrapolation is: %0.10f"
+#else
     printf("Error due to the five-point central difference is: %0.10f"
+#endif
            "\nError due to function evaluation is: %0.10f\n",
            derivError, evalError);
   }
@@ -226,15 +352,11 @@ namespace numerical_diff {
   T* updateIndexParamValue(T* arg, std::size_t idx, std::size_t currIdx,
                            int multiplier, precision& h_val, std::size_t n = 0,
                            std::size_t i = 0) {
-    // malloc some buffer space that we will free later.
+    // copy the array to some buffer space that we will free later.
     // this is required to make sure that we are retuning a deep copy
     // that is valid throughout the scope of the central_diff function.
     // Temp is system owned.
-    T* temp = getBufferManager().make_buffer_space<T>(n);
-    // deepcopy
-    for (std::size_t j = 0; j < n; j++) {
-      temp[j] = arg[j];
-    }
+    T* temp = getBufferManager().copy_buffer_space<T>(arg, n);
     if (idx == currIdx) {
       h_val = (h_val == 0) ? get_h(temp[i]) : h_val;
       // update the specific array value.
@@ -243,6 +365,507 @@ namespace numerical_diff {
     return temp;
   }
 
+  /// The derivative of a target function with respect to one input, and the
+  /// error estimates of the formula used to compute it.
+  struct stencil_result {
+    precision derivative = 0;
+    /// The error due to the five-point stencil formula.
+    precision derivError = 0;
+    /// The error due to the evaluation of the target function.
+    precision evalError = 0;
+  };
+
+  /// Evaluates the target function with the input \p arrIdx of the parameter
+  /// at position \p n shifted by \p multiplier * \p h.
+  ///
+  /// \param[in] \c lengths A callable returning the length of the
+  /// pointer/array at the given position.
+  template <typename F, typename Lengths, std::size_t... Ints,
+            typename... Args>
+  precision evaluate_shifted(F f, std::size_t n, std::size_t arrIdx,
+                             int multiplier, precision& h,
+                             const Lengths& lengths,
+                             clad::IndexSequence<Ints...> idxSeq,
+                             Args&&... args) {
+    return f(updateIndexParamValue(std::forward<Args>(args), Ints, n,
+                                   multiplier, h, lengths(Ints), arrIdx)...);
+  }
+
+  /// Calculates the derivative of a target function with respect to the
+  /// input \p arrIdx of the parameter at position \p n using the five-point
+  /// stencil formula.
+  ///
+  /// \param[in] \c f The target function to numerically differentiate.
+  /// \param[in] \c n The position of the parameter.
+  /// \param[in] \c arrIdx The index of the input in the pointer/array.
+  /// \param[in] \c computeErrors A flag to decide if the error estimates
+  /// should be computed, which needs two more evaluations of \p f.
+  /// \param[in] \c lengths A callable returning the length of the
+  /// pointer/array at the given position.
+  /// \param[in] \c idxSeq The index sequence associated with the input
+  /// parameter pack.
+  /// \param[in] \c args The arguments to the function to differentiate.
+  template <typename F, typename Lengths, std::size_t... Ints,
+            typename... Args>
+  stencil_result five_point_stencil(F f, std::size_t n, std::size_t arrIdx,
+                                    bool computeErrors, const Lengths& lengths,
+                                    clad::IndexSequence<Ints...> idxSeq,
+                                    Args&&... args) {
+    stencil_result res;
+    precision h = 0;
+    // calculate f[x+h, x-h]
+    // f(..., x+h,...)
+    precision xaf = evaluate_shifted(f, n, arrIdx, /*multiplier=*/1, h,
+                                     lengths, idxSeq,
+                                     std::forward<Args>(args)...);
+    precision xbf = evaluate_shifted(f, n, arrIdx, /*multiplier=*/-1, h,
+                                     lengths, idxSeq,
+                                     std::forward<Args>(args)...);
+    precision xf1 = (xaf - xbf) / (h + h);
+
+    // calculate f[x+2h, x-2h]
+    precision xaf2 = evaluate_shifted(f, n, arrIdx, /*multiplier=*/2, h,
+                                      lengths, idxSeq,
+                                      std::forward<Args>(args)...);
+    precision xbf2 = evaluate_shifted(f, n, arrIdx, /*multiplier=*/-2, h,
+                                      lengths, idxSeq,
+                                      std::forward<Args>(args)...);
+    precision xf2 = (xaf2 - xbf2) / (2 * h + 2 * h);
+
+    if (computeErrors) {
+      // calculate f(x+3h) and f(x-3h)
+      precision xaf3 = evaluate_shifted(f, n, arrIdx, /*multiplier=*/3, h,
+                                        lengths, idxSeq,
+                                        std::forward<Args>(args)...);
+      precision xbf3 = evaluate_shifted(f, n, arrIdx, /*multiplier=*/-3, h,
+                                        lengths, idxSeq,
+                                        std::forward<Args>(args)...);
+      // Error in derivative due to the five-point stencil formula
+      // E(f'(x)) = f`````(x) * h^4 / 30 + O(h^5) (Taylor Approx) and
+      // f`````(x) = (f[x+3h, x-3h] - 4f[x+2h, x-2h] + 5f[x+h, x-h])/(2 * h^5)
+      // Formula courtesy of 'Abramowitz, Milton; Stegun, Irene A. (1970),
+      // Handbook of Mathematical Functions with Formulas, Graphs, and
+      // Mathematical Tables, Dover. Ninth printing. Table 25.2.`.
+      precision error = ((xaf3 - xbf3) - 4 * (xaf2 - xbf2) + 5 * (xaf - xbf)) /
+                        (60 * h);
+      res.derivError = std::fabs(error);
+      // This is the error in evaluation of all the function values.
+      res.evalError = std::numeric_limits<precision>::epsilon() *
+                      (std::fabs(xaf2) + std::fabs(xbf2) +
+                       8 * (std::fabs(xaf) + std::fabs(xbf))) /
+                      (12 * h);
+    }
+
+    // five-point stencil formula = (4f[x+h, x-h] - f[x+2h, x-2h])/3
+    res.derivative = 4.0 * xf1 / 3.0 - xf2 / 3.0;
+    return res;
+  }
+
+  /// The maximal number of steps, each half of the previous one, of the
+  /// Richardson extrapolation.
+  constexpr int richardson_steps = 12;
+  /// The first step of the Richardson extrapolation is 2^richardson_scale
+  /// times the step chosen by updateIndexParamValue.
+  constexpr int richardson_scale = 6;
+
+  /// Reads the input \p arrIdx of \p arg into \p x if it is a floating-point
+  /// or an integral value, or an array of them.
+  ///
+  /// \returns true if \p x was read.
+  template <typename T>
+  bool read_input(const T& arg, std::size_t /*arrIdx*/, precision& x,
+                  std::true_type /*isArithmetic*/, std::false_type) {
+    x = static_cast<precision>(arg);
+    return true;
+  }
+  template <typename T>
+  bool read_input(const T& arg, std::size_t arrIdx, precision& x,
+                  std::false_type, std::true_type /*isArithmeticArray*/) {
+    x = static_cast<precision>(arg[arrIdx]);
+    return true;
+  }
+  template <typename T>
+  bool read_input(const T& /*arg*/, std::size_t /*arrIdx*/,
+                  precision& /*x*/, std::false_type, std::false_type) {
+    return false;
+  }
+
+  /// Whether \p T is a pointer to or an array of arithmetic values.
+  template <typename T, typename D = typename std::decay<T>::type>
+  using is_arithmetic_array = std::integral_constant<
+      bool, std::is_pointer<D>::value &&
+                std::is_arithmetic<
+                    typename std::remove_pointer<D>::type>::value>;
+
+  /// Reads the input \p arrIdx of the parameter at position \p n into \p x.
+  ///
+  /// \returns true if \p x was read, i.e. the input is arithmetic.
+  template <std::size_t... Ints, typename... Args>
+  bool read_input(std::size_t n, std::size_t arrIdx, precision& x,
+                  clad::IndexSequence<Ints...> /*idxSeq*/,
+                  const Args&... args) {
+    bool read = false;
+    using expander = int[];
+    (void)expander{
+        0, (Ints == n ? (read = read_input(
+                             args, arrIdx, x,
+                             std::is_arithmetic<
+                                 typename std::decay<Args>::type>{},
+                             is_arithmetic_array<Args>{}),
+                         0)
+                      : 0)...};
+    return read;
+  }
+
+  /// Calculates the derivative of a target function with respect to the
+  /// input \p arrIdx of the parameter at position \p n by Richardson
+  /// extrapolation of central differences, as proposed by Ridders. The
+  /// central difference is computed with steps halved from
+  /// 2^richardson_scale times the h chosen by updateIndexParamValue. Every
+  /// new difference is combined with the extrapolations of the larger steps,
+  /// thus each evaluation of \p f is used once and adds an order of accuracy.
+  /// The result is the extrapolation with the smallest error estimate. The
+  /// steps stop being halved once the round-off error dominates and makes
+  /// the extrapolation worse, which adapts the step to \p f. The steps of the
+  /// arithmetic inputs are relative to their magnitude, so that they stay
+  /// in the domain of \p f near 0, e.g. of `log`. If no difference is
+  /// finite, the derivative is NaN.
+  ///
+  /// \param[in] \c f The target function to numerically differentiate.
+  /// \param[in] \c n The position of the parameter.
+  /// \param[in] \c arrIdx The index of the input in the pointer/array.
+  /// \param[in] \c lengths A callable returning the length of the
+  /// pointer/array at the given position.
+  /// \param[in] \c idxSeq The index sequence associated with the input
+  /// parameter pack.
+  /// \param[in] \c args The arguments to the function to differentiate.
+  template <typename F, typename Lengths, std::size_t... Ints,
+            typename... Args>
+  stencil_result
+  richardson_extrapolation(F f, std::size_t n, std::size_t arrIdx,
+                           bool /*computeErrors*/, const Lengths& lengths,
+                           clad::IndexSequence<Ints...> idxSeq,
+                           Args&&... args) {
+    // table[i][j] is the extrapolation of order j from the differences with
+    // the steps of i - j to i.
+    precision table[richardson_steps][richardson_steps];
+    stencil_result res;
+    res.derivError = std::numeric_limits<precision>::infinity();
+    // The first evaluation lets updateIndexParamValue choose h unless it is
+    // scaled by the input here, the steps are then passed to it.
+    precision h = 0;
+    precision x = 0;
+    if (read_input(n, arrIdx, x, idxSeq, args...) && x != 0)
+      h = make_h_representable(x, get_h(x) * std::fabs(x));
+    int multiplier = 1 << richardson_scale;
+    // The first step of the table, the differences with larger steps left the
+    // domain of f.
+    int first = 0;
+    for (int i = 0; i < richardson_steps; i++) {
+      precision xaf = evaluate_shifted(f, n, arrIdx, multiplier, h, lengths,
+                                       idxSeq, std::forward<Args>(args)...);
+      precision xbf = evaluate_shifted(f, n, arrIdx, -multiplier, h, lengths,
+                                       idxSeq, std::forward<Args>(args)...);
+      precision step = multiplier * h;
+      h = step / 2;
+      multiplier = 1;
+      table[i][0] = (xaf - xbf) / (step + step);
+      if (!std::isfinite(table[i][0])) {
+        first = i + 1;
+        continue;
+      }
+      // This is the error in evaluation of the function values.
+      precision evalError = std::numeric_limits<precision>::epsilon() *
+                            (std::fabs(xaf) + std::fabs(xbf)) / (step + step);
+      if (i == first && !std::isfinite(res.derivError)) {
+        res.derivative = table[i][0];
+        res.evalError = evalError;
+      }
+      // The error of the central difference is a series in step^2, thus
+      // halving the step divides the term eliminated by extrapolation j by
+      // 4^j.
+      precision factor = 4;
+      for (int j = 1; j <= i - first; j++, factor *= 4) {
+        table[i][j] =
+            (factor * table[i][j - 1] - table[i - 1][j - 1]) / (factor - 1);
+        precision error =
+            std::max(std::fabs(table[i][j] - table[i][j - 1]),
+                     std::fabs(table[i][j] - table[i - 1][j - 1]));
+        if (error <= res.derivError) {
+          res.derivative = table[i][j];
+          res.derivError = error;
+          res.evalError = evalError;
+        }
+      }
+      // A growing extrapolation is due to the round-off error only once the
+      // error estimate is close to it, before the steps may be too large.
+      if (i > first && res.derivError <= 64 * evalError &&
+          std::fabs(table[i][i - first] - table[i - 1][i - 1 - first]) >=
+              2 * res.derivError)
+        break;
+    }
+    // Every step left the domain of f.
+    if (first == richardson_steps)
+      res.derivative = std::numeric_limits<precision>::quiet_NaN();
+    return res;
+  }
+
+  /// The imaginary step of the complex-step differentiation. The derivative
+  /// is not computed from a difference of function values, thus the step
+  /// can be small enough for the truncation error to vanish.
+  constexpr precision complex_step_size = 1e-20;
+
+  template <typename T> struct is_std_complex : std::false_type {};
+  template <typename T>
+  struct is_std_complex<std::complex<T>> : std::true_type {};
+
+  /// How an argument is passed to the target function by the complex-step
+  /// differentiation.
+  enum class complex_step_kind {
+    /// The argument is passed unchanged.
+    unchanged,
+    /// The argument is the one being differentiated, x + ih is passed.
+    step,
+    /// The argument is a floating-point scalar passed as a complex number,
+    /// e.g. to a function template taking all its arguments as the same T.
+    promoted
+  };
+
+  /// \returns how the argument of type \p T at position \p K is passed if the
+  /// argument at position \p N is differentiated.
+  template <typename T>
+  constexpr complex_step_kind get_complex_step_kind(std::size_t K,
+                                                    std::size_t N,
+                                                    bool promote) {
+    return K == N ? complex_step_kind::step
+           : promote && std::is_floating_point<
+                            typename std::decay<T>::type>::value
+               ? complex_step_kind::promoted
+               : complex_step_kind::unchanged;
+  }
+
+  template <complex_step_kind Kind>
+  using complex_step_tag = std::integral_constant<complex_step_kind, Kind>;
+
+  /// Passes an argument to the target function as described by the tag.
+  template <typename T>
+  T&& complex_step_arg(complex_step_tag<complex_step_kind::unchanged>,
+                       T&& arg, const std::complex<precision>& /*z*/) {
+    return std::forward<T>(arg);
+  }
+  template <typename T>
+  std::complex<precision>
+  complex_step_arg(complex_step_tag<complex_step_kind::step>, T&& /*arg*/,
+                   const std::complex<precision>& z) {
+    return z;
+  }
+  template <typename T>
+  std::complex<precision>
+  complex_step_arg(complex_step_tag<complex_step_kind::promoted>, T&& arg,
+                   const std::complex<precision>& /*z*/) {
+    return std::complex<precision>(arg);
+  }
+
+  /// Checks if the target function \p F can be called with the argument at
+  /// position \p N, which must be a floating-point scalar, replaced by a
+  /// complex number and returns a complex number. If \p Promote is true, the
+  /// other floating-point arguments are passed as complex numbers too. This
+  /// is the case for templated callables, e.g. generic lambdas, and for the
+  /// overloads of the mathematical functions in <complex>.
+  template <typename F, std::size_t N, bool Promote, typename Seq,
+            typename... Args>
+  struct is_complex_step_differentiable;
+  template <typename F, std::size_t N, bool Promote, std::size_t... Ints,
+            typename... Args>
+  struct is_complex_step_differentiable<F, N, Promote,
+                                        clad::IndexSequence<Ints...>,
+                                        Args...> {
+    template <typename G>
+    static auto test(int) -> is_std_complex<typename std::decay<decltype(
+        std::declval<G&>()(complex_step_arg(
+            complex_step_tag<get_complex_step_kind<Args>(Ints, N, Promote)>{},
+            std::declval<Args>(),
+            std::declval<const std::complex<precision>&>())...))>::type>;
+    template <typename G> static std::false_type test(...);
+
+    using Arg = typename std::decay<typename std::tuple_element<
+        N, std::tuple<Args...>>::type>::type;
+    static constexpr bool value = std::is_floating_point<Arg>::value &&
+                                  decltype(test<F>(0))::value;
+  };
+
+  template <std::size_t N, bool Promote, typename F, std::size_t... Ints,
+            typename... Args>
+  bool complex_step_at(std::false_type, F /*f*/, stencil_result& /*res*/,
+                       clad::IndexSequence<Ints...> /*idxSeq*/,
+                       Args&&... /*args*/) {
+    return false;
+  }
+
+  /// Calculates the derivative with respect to the argument at position \p N
+  /// as Im(f(..., x + ih, ...)) / h with the step complex_step_size.
+  template <std::size_t N, bool Promote, typename F, std::size_t... Ints,
+            typename... Args>
+  bool complex_step_at(std::true_type, F f, stencil_result& res,
+                       clad::IndexSequence<Ints...> /*idxSeq*/,
+                       Args&&... args) {
+    precision x = std::get<N>(std::forward_as_tuple(args...));
+    std::complex<precision> z(x, complex_step_size);
+    std::complex<precision> fz = f(complex_step_arg(
+        complex_step_tag<get_complex_step_kind<Args>(Ints, N, Promote)>{},
+        std::forward<Args>(args), z)...);
+    res.derivative = std::imag(fz) / complex_step_size;
+    // The truncation error is f'''(x) * h^2 / 6, which is negligible, only
+    // the evaluation of f contributes.
+    res.derivError = 0;
+    res.evalError =
+        std::numeric_limits<precision>::epsilon() * std::fabs(res.derivative);
+    return true;
+  }
+
+  /// Calculates the derivative with respect to the argument at position \p N
+  /// by complex-step differentiation if \p F can be called with it being
+  /// complex, alone or together with the other floating-point arguments.
+  template <std::size_t N, typename F, std::size_t... Ints, typename... Args>
+  bool complex_step_at(F f, stencil_result& res,
+                       clad::IndexSequence<Ints...> idxSeq, Args&&... args) {
+    using Seq = clad::IndexSequence<Ints...>;
+    constexpr bool single =
+        is_complex_step_differentiable<F, N, false, Seq, Args...>::value;
+    constexpr bool promoted =
+        is_complex_step_differentiable<F, N, true, Seq, Args...>::value;
+    return complex_step_at<N, /*Promote=*/!single>(
+        std::integral_constant<bool, single || promoted>{}, f, res, idxSeq,
+        std::forward<Args>(args)...);
+  }
+
+  /// Calculates the derivative of a target function with respect to the
+  /// scalar argument at position \p n by complex-step differentiation, if the
+  /// target function can be called with that argument being complex. This
+  /// needs one evaluation of \p f and is accurate to machine precision, but
+  /// requires \p f to be real-analytic, i.e. to not use e.g. std::abs or
+  /// comparisons of the complex number. It is enabled by defining
+  /// CLAD_NUM_DIFF_COMPLEX_STEP, as the return type of a generic lambda
+  /// whose body does not compile for complex numbers cannot be checked.
+  ///
+  /// \returns true if the derivative was computed.
+  template <typename F, std::size_t... Ints, typename... Args>
+  bool complex_step(F f, std::size_t n, stencil_result& res,
+                    clad::IndexSequence<Ints...> idxSeq, Args&&... args) {
+    bool done = false;
+    int expand[] = {0, (n == Ints && !done &&
+                            (done = complex_step_at<Ints>(
+                                 f, res, idxSeq, std::forward<Args>(args)...)),
+                        0)...};
+    (void)expand;
+    return done;
+  }
+
+  template <typename F, typename G, typename... Args>
+  auto call_complex_step_target(int, F f, G /*g*/, Args&&... args)
+      -> decltype(f(std::forward<Args>(args)...)) {
+    return f(std::forward<Args>(args)...);
+  }
+  template <typename F, typename G, typename... Args>
+  auto call_complex_step_target(long, F /*f*/, G g, Args&&... args)
+      -> decltype(g(std::forward<Args>(args)...)) {
+    return g(std::forward<Args>(args)...);
+  }
+
+  /// A target function together with its specialization on complex numbers,
+  /// e.g. `g<double>` and `g<std::complex<double>>` of a function template.
+  /// The calls are forwarded to the former if it accepts the arguments and
+  /// to the latter otherwise, thus the complex-step differentiation can be
+  /// used for a function template whose address was taken. If
+  /// CLAD_NUM_DIFF_COMPLEX_STEP is defined, Clad passes one to the
+  /// numerical differentiation functions when it falls back to them for a
+  /// function template.
+  template <typename F, typename G> struct complex_step_target {
+    F m_Real;
+    G m_Complex;
+
+    template <typename... Args>
+    auto operator()(Args&&... args) const
+        -> decltype(call_complex_step_target(0, std::declval<const F&>(),
+                                             std::declval<const G&>(),
+                                             std::forward<Args>(args)...)) {
+      return call_complex_step_target(0, m_Real, m_Complex,
+                                      std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename F, typename G>
+  complex_step_target<F, G> make_complex_step_target(F f, G g) {
+    return {f, g};
+  }
+
+  /// Calculates the derivative of a target function with respect to one
+  /// input by complex-step differentiation if CLAD_NUM_DIFF_COMPLEX_STEP is
+  /// defined and the target can be called with complex numbers, otherwise
+  /// with the method selected at compile time: Richardson extrapolation if
+  /// CLAD_NUM_DIFF_RICHARDSON is defined, the five-point stencil formula
+  /// otherwise.
+  template <typename F, typename Lengths, std::size_t... Ints,
+            typename... Args>
+  stencil_result estimate_derivative(F f, std::size_t n, std::size_t arrIdx,
+                                     bool computeErrors,
+                                     const Lengths& lengths,
+                                     clad::IndexSequence<Ints...> idxSeq,
+                                     Args&&... args) {
+#ifdef CLAD_NUM_DIFF_COMPLEX_STEP
+    stencil_result res;
+    if (complex_step(f, n, res, idxSeq, std::forward<Args>(args)...))
+      return res;
+#endif
+#ifdef CLAD_NUM_DIFF_RICHARDSON
+    return richardson_extrapolation(f, n, arrIdx, computeErrors, lengths,
+                                    idxSeq, std::forward<Args>(args)...);
+#else
+    return five_point_stencil(f, n, arrIdx, computeErrors, lengths, idxSeq,
+                              std::forward<Args>(args)...);
+#endif
+  }
+
+#if defined(CLAD_NUM_DIFF_THREADS) && CLAD_NUM_DIFF_THREADS > 1
+  /// \returns the pool evaluating the inputs of a call, with
+  /// CLAD_NUM_DIFF_THREADS threads including the calling one. The workers are
+  /// created by the first call and reused by the next ones.
+  inline clad::thread_pool& getThreadPool() {
+    static clad::thread_pool pool(CLAD_NUM_DIFF_THREADS - 1);
+    return pool;
+  }
+#endif
+
+  /// Calls \p task for every index in [0, \p count). The inputs of a gradient
+  /// are independent, thus if CLAD_NUM_DIFF_THREADS is defined to a number
+  /// greater than one, the indices are split in contiguous ranges evaluated
+  /// by the threads of getThreadPool(). The target function must then be safe
+  /// to call concurrently. The buffer arena of every thread is reset after
+  /// each index.
+  template <typename Task>
+  void for_each_component(std::size_t count, const Task& task) {
+#if defined(CLAD_NUM_DIFF_THREADS) && CLAD_NUM_DIFF_THREADS > 1
+    if (count > 1) {
+      clad::thread_pool& pool = getThreadPool();
+      std::size_t chunk = (count + pool.size() - 1) / pool.size();
+      auto run = [](void* context, std::size_t begin, std::size_t end) {
+        const Task& task = *static_cast<const Task*>(context);
+        for (std::size_t c = begin; c < end; c++) {
+          task(c);
+          getBufferManager().free_buffer();
+        }
+      };
+      pool.parallel_for(count, chunk, run,
+                        const_cast<void*>(static_cast<const void*>(&task)));
+      return;
+    }
+#endif
+    for (std::size_t c = 0; c < count; c++) {
+      task(c);
+      getBufferManager().free_buffer();
+    }
+  }
+
   /// A helper function to calculate the numerical derivative of a target
   /// function.
   ///
@@ -262,67 +885,28 @@ namespace numerical_diff {
       clad::IndexSequence<Ints...> idxSeq, Args&&... args) {
 
     std::size_t argLen = sizeof...(Args);
-    // loop over all the args, selecting each arg to get the derivative with
-    // respect to.
-    for (std::size_t i = 0; i < argLen; i++) {
-      precision h;
-      std::size_t argVecLen = _grad[i].size();
-      for (std::size_t j = 0; j < argVecLen; j++) {
-        // Reset h
-        h = 0;
-        // calculate f[x+h, x-h]
-        // f(..., x+h,...)
-        precision xaf = f(updateIndexParamValue(std::forward<Args>(args), Ints,
-                                                i, /*multiplier=*/1, h,
-                                                _grad[Ints].size(), j)...);
-        precision xbf = f(updateIndexParamValue(std::forward<Args>(args), Ints,
-                                                i, /*multiplier=*/-1, h,
-                                                _grad[Ints].size(), j)...);
-        precision xf1 = (xaf - xbf) / (h + h);
-
-        // calculate f[x+2h, x-2h]
-        precision xaf2 = f(updateIndexParamValue(std::forward<Args>(args), Ints,
-                                                 i,
-                                                 /*multiplier=*/2, h,
-                                                 _grad[Ints].size(), j)...);
-        precision xbf2 = f(updateIndexParamValue(std::forward<Args>(args), Ints,
-                                                 i,
-                                                 /*multiplier=*/-2, h,
-                                                 _grad[Ints].size(), j)...);
-        precision xf2 = (xaf2 - xbf2) / (2 * h + 2 * h);
-
-        if (printErrors) {
-          // calculate f(x+3h) and f(x-3h)
-          precision xaf3 = f(updateIndexParamValue(std::forward<Args>(args),
-                                                   Ints, i,
-                                                   /*multiplier=*/3, h,
-                                                   _grad[Ints].size(), j)...);
-          precision xbf3 = f(updateIndexParamValue(std::forward<Args>(args),
-                                                   Ints, i,
-                                                   /*multiplier=*/-3, h,
-                                                   _grad[Ints].size(), j)...);
-          // Error in derivative due to the five-point stencil formula
-          // E(f'(x)) = f`````(x) * h^4 / 30 + O(h^5) (Taylor Approx) and
-          // f`````(x) = (f[x+3h, x-3h] - 4f[x+2h, x-2h] + 5f[x+h, x-h])/(2 *
-          // h^5) Formula courtesy of 'Abramowitz, Milton; Stegun, Irene A.
-          // (1970), Handbook of Mathematical Functions with Formulas, Graphs,
-          // and Mathematical Tables, Dover. Ninth printing. Table 25.2.`.
-          precision error = ((xaf3 - xbf3) - 4 * (xaf2 - xbf2) +
-                             5 * (xaf - xbf)) /
-                            (60 * h);
-          // This is the error in evaluation of all the function values.
-          precision evalError = std::numeric_limits<precision>::epsilon() *
-                                (std::fabs(xaf2) + std::fabs(xbf2) +
-                                 8 * (std::fabs(xaf) + std::fabs(xbf))) /
-                                (12 * h);
-          // Finally print the error to standard ouput.
-          printError(std::fabs(error), evalError, i, argVecLen > 1 ? j : -1);
-        }
+    // collect all the inputs, every element of the arrays being one, to get
+    // the derivative with respect to.
+    std::vector<std::pair<std::size_t, std::size_t>> inputs;
+    for (std::size_t i = 0; i < argLen; i++)
+      for (std::size_t j = 0, e = _grad[i].size(); j < e; j++)
+        inputs.emplace_back(i, j);
+    auto lengths = [&_grad](std::size_t i) { return _grad[i].size(); };
+    std::vector<stencil_result> results(inputs.size());
+    for_each_component(inputs.size(), [&](std::size_t c) {
+      results[c] = estimate_derivative(f, inputs[c].first, inputs[c].second,
+                                       printErrors, lengths, idxSeq,
+                                       std::forward<Args>(args)...);
+    });
 
-        // five-point stencil formula = (4f[x+h, x-h] - f[x+2h, x-2h])/3
-        _grad[i][j] = 4.0 * xf1 / 3.0 - xf2 / 3.0;
-        getBufferManager().free_buffer();
-      }
+    for (std::size_t c = 0; c < inputs.size(); c++) {
+      std::size_t i = inputs[c].first;
+      std::size_t j = inputs[c].second;
+      // Finally print the error to standard ouput.
+      if (printErrors)
+        printError(results[c].derivError, results[c].evalError, i,
+                   _grad[i].size() > 1 ? (int)j : -1);
+      _grad[i][j] = results[c].derivative;
     }
   }
 
@@ -345,54 +929,19 @@ namespace numerical_diff {
                                  Args&&... args) {
 
     std::size_t argLen = sizeof...(Args);
-    // loop over all the args, selecting each arg to get the derivative with
-    // respect to.
-    for (std::size_t i = 0; i < argLen; i++) {
-      precision h = 0;
-      // calculate f[x+h, x-h]
-      // f(..., x+h,...)
-      precision xaf = f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                              /*multiplier=*/1, h)...);
-      precision xbf = f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                              /*multiplier=*/-1, h)...);
-      precision xf1 = (xaf - xbf) / (h + h);
-
-      // calculate f[x+2h, x-2h]
-      precision xaf2 =
-          f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                  /*multiplier=*/2, h)...);
-      precision xbf2 =
-          f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                  /*multiplier=*/-2, h)...);
-      precision xf2 = (xaf2 - xbf2) / (2 * h + 2 * h);
-
-      if (printErrors) {
-        // calculate f(x+3h) and f(x-3h)
-        precision xaf3 =
-            f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                    /*multiplier=*/3, h)...);
-        precision xbf3 =
-            f(updateIndexParamValue(std::forward<Args>(args), Ints, i,
-                                    /*multiplier=*/-3, h)...);
-        // Error in derivative due to the five-point stencil formula
-        // E(f'(x)) = f`````(x) * h^4 / 30 + O(h^5) (Taylor Approx) and
-        // f`````(x) = (f[x+3h, x-3h] - 4f[x+2h, x-2h] + 5f[x+h, x-h])/(2 *
-        // h^5) Formula courtesy of 'Abramowitz, Milton; Stegun, Irene A.
-        // (1970), Handbook of Mathematical Functions with Formulas, Graphs,
-        // and Mathematical Tables, Dover. Ninth printing. Table 25.2.`.
-        precision error =
-            ((xaf3 - xbf3) - 4 * (xaf2 - xbf2) + 5 * (xaf - xbf)) / (60 * h);
-        // This is the error in evaluation of all the function values.
-        precision evalError = std::numeric_limits<precision>::epsilon() *
-                              (std::fabs(xaf2) + std::fabs(xbf2) +
-                               8 * (std::fabs(xaf) + std::fabs(xbf))) /
-                              (12 * h);
-        // Finally print the error to standard ouput.
-        printError(std::fabs(error), evalError, i);
-      }
+    auto lengths = [](std::size_t) { return std::size_t(0); };
+    std::vector<stencil_result> results(argLen);
+    for_each_component(argLen, [&](std::size_t i) {
+      results[i] = estimate_derivative(f, i, /*arrIdx=*/0, printErrors,
+                                       lengths, idxSeq,
+                                       std::forward<Args>(args)...);
+    });
 
-      // five-point stencil formula = (4f[x+h, x-h] - f[x+2h, x-2h])/3
-      _grad[i] = 4.0 * xf1 / 3.0 - xf2 / 3.0;
+    for (std::size_t i = 0; i < argLen; i++) {
+      // Finally print the error to standard ouput.
+      if (printErrors)
+        printError(results[i].derivError, results[i].evalError, i);
+      _grad[i] = results[i].derivative;
     }
   }
 
@@ -439,49 +988,15 @@ namespace numerical_diff {
       F f, T arg, std::size_t n, int arrIdx, std::size_t arrLen,
       bool printErrors, clad::IndexSequence<Ints...> idxSeq, Args&&... args) {
 
-    precision xaf, xbf, xaf2, xbf2, xf1, xf2, dx, h = 0;
-    // calculate f[x+h, x-h]
-    xaf = f(updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                  /*multiplier=*/1, h, arrLen, arrIdx)...);
-    xbf = f(updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                  /*multiplier=*/-1, h, arrLen, arrIdx)...);
-    xf1 = (xaf - xbf) / (h + h);
-
-    // calculate f[x+2h, x-2h]
-    xaf2 = f(updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                   /*multiplier=*/2, h, arrLen, arrIdx)...);
-    xbf2 = f(updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                   /*multiplier=*/-2, h, arrLen, arrIdx)...);
-    xf2 = (xaf2 - xbf2) / (2 * h + 2 * h);
-
-    if (printErrors) {
-      // calculate f(x+3h) and f(x-3h)
-      precision xaf3 = f(
-          updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                /*multiplier=*/3, h, arrLen, arrIdx)...);
-      precision xbf3 = f(
-          updateIndexParamValue(std::forward<Args>(args), Ints, n,
-                                /*multiplier=*/-3, h, arrLen, arrIdx)...);
-      // Error in derivative due to the five-point stencil formula
-      // E(f'(x)) = f`````(x) * h^4 / 30 + O(h^5) (Taylor Approx) and
-      // f`````(x) = (f[x+3h, x-3h] - 4f[x+2h, x-2h] + 5f[x+h, x-h])/(2 * h^5)
-      // Formula courtesy of 'Abramowitz, Milton; Stegun, Irene A. (1970),
-      // Handbook of Mathematical Functions with Formulas, Graphs, and
-      // Mathematical Tables, Dover. Ninth printing. Table 25.2.`.
-      precision error = ((xaf3 - xbf3) - 4 * (xaf2 - xbf2) + 5 * (xaf - xbf)) /
-                        (60 * h);
-      // This is the error in evaluation of all the function values.
-      precision evalError = std::numeric_limits<precision>::epsilon() *
-                            (std::fabs(xaf2) + std::fabs(xbf2) +
-                             8 * (std::fabs(xaf) + std::fabs(xbf))) /
-                            (12 * h);
-      // Finally print the error to standard ouput.
-      printError(std::fabs(error), evalError, n, arrIdx);
-    }
-
-    // five-point stencil formula = (4f[x+h, x-h] - f[x+2h, x-2h])/3
-    dx = 4.0 * xf1 / 3.0 - xf2 / 3.0;
-    return dx;
+    auto lengths = [arrLen](std::size_t) { return arrLen; };
+    stencil_result res =
+        estimate_derivative(f, n, arrIdx, printErrors, lengths, idxSeq,
+                            std::forward<Args>(args)...);
+    getBufferManager().free_buffer();
+    // Finally print the error to standard ouput.
+    if (printErrors)
+      printError(res.derivError, res.evalError, n, arrIdx);
+    return res.derivative;
   }
 
   /// A function to calculate the derivative of a function using the central
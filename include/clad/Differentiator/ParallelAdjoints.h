@@ -0,0 +1,24 @@
+#ifndef CLAD_DIFFERENTIATOR_PARALLELADJOINTS_H
+#define CLAD_DIFFERENTIATOR_PARALLELADJOINTS_H
+
+namespace clad {
+
+/// Adds \p value to the adjoint at \p ptr, which other threads may update
+/// concurrently. Used by the reverse pass of parallel loops for the adjoints
+/// which are shared by their iterations.
+template <typename T, typename U> inline void atomic_add(T* ptr, U value) {
+#if defined(__GNUC__) || defined(__clang__)
+  T expected;
+  __atomic_load(ptr, &expected, __ATOMIC_RELAXED);
+  T desired = expected + value;
+  while (!__atomic_compare_exchange(ptr, &expected, &desired, /*weak=*/true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    desired = expected + value;
+#else
+#pragma omp atomic
+  *ptr += value;
+#endif
+}
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_PARALLELADJOINTS_H
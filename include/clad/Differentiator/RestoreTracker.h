@@ -1,11 +1,11 @@
 #ifndef CLAD_DIFFERENTIATOR_RESTORETRACKER_H
 #define CLAD_DIFFERENTIATOR_RESTORETRACKER_H
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <map>
-#include <utility>
 #include <vector>
 
 namespace clad {
@@ -20,10 +20,53 @@ namespace clad {
 /// We use it when we have to pass information between nested calls and
 /// clad::tape is not viable.
 class restore_tracker {
-  // m_data consists of pairs of memory addresses and bitwise values
-  using RawMemory = std::vector<uint8_t>;
   using Address = char*;
-  std::map<const Address, RawMemory> m_data;
+  /// Describes a stored variable. It is placed right after the bytes of the
+  /// variable in the log so that the log can be walked backwards.
+  struct entry {
+    Address address;
+    std::size_t size;
+  };
+  /// The stored variables, each one as its bytes followed by its entry.
+  std::vector<uint8_t> m_log;
+  /// The stored addresses, an open-addressing hash set with linear probing
+  /// whose empty slots are null. Its capacity is zero or a power of two.
+  std::vector<Address> m_stored;
+  /// The number of addresses in m_stored.
+  std::size_t m_numStored = 0;
+
+  static std::size_t hash(const void* address) {
+    // The low bits of the addresses are mostly zero because of the alignment.
+    std::uint64_t h = (reinterpret_cast<std::uintptr_t>(address) >> 3) *
+                      0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+  }
+  /// Inserts \p address into m_stored, \returns false if it was there.
+  bool insert(Address address) {
+    // Keep the load factor at most 1/2 for short probe sequences.
+    if (2 * (m_numStored + 1) > m_stored.size()) {
+      std::vector<Address> old(m_stored.empty() ? 32 : 2 * m_stored.size());
+      old.swap(m_stored);
+      for (Address a : old)
+        if (a)
+          m_stored[find(a)] = a;
+    }
+    std::size_t slot = find(address);
+    if (m_stored[slot])
+      return false;
+    m_stored[slot] = address;
+    ++m_numStored;
+    return true;
+  }
+  /// \returns the slot of \p address in m_stored, or the empty slot where it
+  /// belongs.
+  std::size_t find(Address address) const {
+    std::size_t mask = m_stored.size() - 1;
+    std::size_t slot = hash(address) & mask;
+    while (m_stored[slot] && m_stored[slot] != address)
+      slot = (slot + 1) & mask;
+    return slot;
+  }
 
 public:
   // Store the value and the address of `val`.
@@ -33,19 +76,33 @@ public:
     // _tracker.store(x); // stored
     // ...
     // _tracker.store(x); // ignored
-    if (m_data.find((char*)&val) != m_data.end())
+    Address address = (char*)&val;
+    if (!insert(address))
       return;
-    std::vector<uint8_t> buffer(sizeof(T));
-    std::memcpy(buffer.data(), &val, sizeof(T));
-    m_data.emplace((char*)&val, std::move(buffer));
+    if (m_log.empty())
+      m_log.reserve(256);
+    entry e = {address, sizeof(T)};
+    std::size_t offset = m_log.size();
+    m_log.resize(offset + sizeof(T) + sizeof(entry));
+    std::memcpy(&m_log[offset], &val, sizeof(T));
+    std::memcpy(&m_log[offset + sizeof(T)], &e, sizeof(entry));
   }
   // Set all stored addresses to the corresponsing values bitwise.
   void restore() {
-    for (std::pair<const Address, RawMemory>& pair : m_data) {
-      std::vector<uint8_t>& buffer = pair.second;
-      std::memcpy(pair.first, buffer.data(), buffer.size());
+    std::size_t offset = m_log.size();
+    while (offset) {
+      assert(offset >= sizeof(entry) && "corrupted restore_tracker log");
+      entry e;
+      offset -= sizeof(entry);
+      std::memcpy(&e, &m_log[offset], sizeof(entry));
+      offset -= e.size;
+      std::memcpy(e.address, &m_log[offset], e.size);
+    }
+    m_log.clear();
+    if (m_numStored) {
+      std::fill(m_stored.begin(), m_stored.end(), nullptr);
+      m_numStored = 0;
     }
-    m_data.clear();
   }
 };
 } // namespace clad
@@ -19,12 +19,16 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/StmtOpenMP.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Version.h"
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 
 #include <array>
@@ -234,6 +238,11 @@ namespace clad {
     clang::VarDecl* GlobalStoreImpl(clang::QualType Type,
                                     llvm::StringRef prefix,
                                     clang::Expr* init = nullptr);
+    /// Same as above, but the variable is named \p II, which should be
+    /// created by CreateUniqueIdentifier.
+    clang::VarDecl* GlobalStoreImpl(clang::QualType Type,
+                                    clang::IdentifierInfo* II,
+                                    clang::Expr* init = nullptr);
     /// Creates a (global in the function scope) variable declaration, puts
     /// it into m_Globals block (to be inserted into the beginning of fn's
     /// body). Returns reference R to the created declaration. If E is not null,
@@ -430,6 +439,8 @@ namespace clad {
     StmtDiff VisitSwitchStmt(const clang::SwitchStmt* SS);
     StmtDiff VisitCaseStmt(const clang::CaseStmt* CS);
     StmtDiff VisitDefaultStmt(const clang::DefaultStmt* DS);
+    StmtDiff
+    VisitOMPParallelForDirective(const clang::OMPParallelForDirective* D);
     virtual DeclDiff<clang::VarDecl>
     DifferentiateVarDecl(const clang::VarDecl* VD, bool keepLocal = false);
     StmtDiff DifferentiateCtorInit(clang::CXXCtorInitializer* CI,
@@ -463,6 +474,49 @@ namespace clad {
     /// \returns The atomicAdd call expression.
     clang::Expr* BuildCallToCudaAtomicAdd(clang::Expr* LHS, clang::Expr* RHS);
 
+    /// Checks whether the adjoint of the data member \p ME is shared by the
+    /// iterations of a Kokkos loop, i.e. \p ME is a member of the functor
+    /// whose call operator pullback is called by a Kokkos loop.
+    bool shouldUseKokkosAtomicOps(const clang::MemberExpr* ME);
+
+    /// Checks whether the adjoint \p E is shared by the iterations of the
+    /// OpenMP loop being differentiated and is not combined by a reduction
+    /// clause. The adjoints held by variables are recorded for the reduction.
+    bool shouldUseOMPAtomicOps(clang::Expr* E);
+
+    /// Builds `clad::atomic_add(&LHS, RHS)`.
+    clang::Expr* BuildCallToAtomicAdd(clang::Expr* LHS, clang::Expr* RHS);
+
+    /// \returns true if the parameter of the differentiated function named
+    /// \p prefix followed by the name of \p PVD is in m_WrittenParams.
+    bool isWrittenParam(const clang::ParmVarDecl* PVD,
+                        llvm::StringRef prefix = "") const;
+
+    /// \returns true if the value of \p S only depends on the parameters of
+    /// the function which are never written, thus is the same for all
+    /// threads.
+    bool dependsOnParamsOnly(const clang::Stmt* S) const;
+
+    /// Checks whether every thread updates the same element with the adjoint
+    /// \p E, e.g. `*_d_val` or `_d_p[0]`, i.e. the address of the element
+    /// does not depend on the thread id or on the iteration. The element of
+    /// the original parameter must not be written, as its adjoint is then
+    /// read by the reverse pass.
+    bool isThreadInvariantAdjoint(const clang::Expr* E);
+
+    /// An adjoint shared by the threads which each thread accumulates in a
+    /// private variable and adds to the shared one once.
+    struct PrivatizedAdjoint {
+      llvm::FoldingSetNodeID ID;
+      clang::Expr* Shared;
+      clang::VarDecl* Private;
+    };
+
+    /// Builds `_acc += dfdx()`, where `_acc` is the private accumulator of
+    /// the shared adjoint \p E in \p Privatized, added if not there yet.
+    clang::Expr* BuildPrivatizedIncrement(
+        clang::Expr* E, llvm::SmallVectorImpl<PrivatizedAdjoint>& Privatized);
+
     /// Check whether this is an assignment to a malloc or a realloc call for a
     /// derivative variable and build a call to memset to follow the memory
     /// allocation in order to properly intialize the memory to zero. \param[in]
@@ -580,13 +634,44 @@ namespace clad {
     /// increment statement, if any.
     ///\param[in] isForLoop should be true if we are differentiating a `for`
     /// loop body; otherwise false.
+    ///\param[in] forLoopInc forward pass `for` loop increment expression, if
+    /// any.
     ///\returns {forward pass statements, reverse pass statements} for the loop
     /// body.
     StmtDiff DifferentiateLoopBody(const clang::Stmt* body,
                                    LoopCounter& loopCounter,
                                    clang::Stmt* condVarDifff = nullptr,
                                    clang::Stmt* forLoopIncDiff = nullptr,
-                                   bool isForLoop = false);
+                                   bool isForLoop = false,
+                                   clang::Expr* forLoopInc = nullptr);
+
+    /// Differentiates the body of an OpenMP parallel loop. The reverse pass of
+    /// such loops recomputes every iteration before running its reverse
+    /// pass, thus no tape outlives an iteration.
+    ///
+    ///\param[in] body body of the loop
+    ///\returns {forward pass statements, reverse pass statements} for the loop
+    /// body.
+    StmtDiff DifferentiateOMPLoopBody(const clang::Stmt* body);
+
+    /// Helper function to checkpoint a loop marked with
+    /// `#pragma clad checkpoint loop snapshots(N)`. The variables modified by
+    /// the loop are stored in the snapshots of a `clad::revolve` and each
+    /// reverse pass iteration starts by restoring the state of its iteration.
+    ///
+    ///\param[in,out] bodyDiff {forward pass statements, reverse pass
+    /// statements} of the loop body, which recomputes the iteration.
+    ///\param[in] body body of the loop
+    ///\param[in] loopCounter associated `LoopCounter` object of the loop.
+    ///\param[in] snapshots the maximal number of snapshots.
+    ///\param[in] forLoopInc forward pass `for` loop increment expression, if
+    /// any.
+    ///\param[in] isForLoop should be true if we are differentiating a `for`
+    /// loop body; otherwise false.
+    ///\returns false if the state of the loop cannot be stored.
+    bool AddBinomialCheckpointing(StmtDiff& bodyDiff, const clang::Stmt* body,
+                                  LoopCounter& loopCounter, unsigned snapshots,
+                                  clang::Expr* forLoopInc, bool isForLoop);
 
     /// This class modifies forward and reverse blocks of the loop/switch
     /// body so that `break` and `continue` statements are correctly
@@ -756,6 +841,28 @@ namespace clad {
 
     /// A flag indicating if the Stmt is contained in a checkpointed loop.
     bool m_IsInsideCheckpointedLoop = false;
+
+    /// The reverse pass of an OpenMP parallel loop being built.
+    struct OMPRegion {
+      /// The iteration variable of the loop.
+      const clang::VarDecl* LoopVar = nullptr;
+      /// The scalar adjoints incremented by the iterations.
+      llvm::SmallSetVector<clang::VarDecl*, 8> ReducedAdjoints;
+      /// The shared adjoints updated by every iteration.
+      llvm::SmallVector<PrivatizedAdjoint, 4> Privatized;
+    };
+    OMPRegion* m_OMPRegion = nullptr;
+    /// The privately accumulated updates of the shared adjoints of a CUDA
+    /// kernel or device function, added to the shared ones at the end of the
+    /// function.
+    llvm::SmallVector<PrivatizedAdjoint, 4> m_PrivatizedAdjoints;
+    /// Whether all the threads of the block reach the end of the derived
+    /// kernel, thus the privatized adjoints are reduced over the block and
+    /// also privatized outside the loops.
+    bool m_ReducesPrivatizedOverBlock = false;
+    /// The parameters of the differentiated function which it may write, or
+    /// whose pointee it may write.
+    llvm::SmallPtrSet<const clang::ParmVarDecl*, 4> m_WrittenParams;
   };
 } // end namespace clad
 
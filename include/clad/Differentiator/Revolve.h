@@ -0,0 +1,168 @@
+#ifndef CLAD_DIFFERENTIATOR_REVOLVE_H
+#define CLAD_DIFFERENTIATOR_REVOLVE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+namespace clad {
+
+/// This class implements the binomial checkpointing schedule of Griewank and
+/// Walther (Algorithm 799: Revolve) for the loops marked with
+/// `#pragma clad checkpoint loop snapshots(N)`. The state of the loop, the
+/// variables its iterations modify, is stored in at most N snapshots. The
+/// gradient is generated as
+/// ```
+/// clad::revolve _cp0 = {N};
+/// for (...) {
+///   _t0++;
+///   _cp0.forward(i, u);
+///   ... // the iteration, without storing any values
+/// }
+/// ...
+/// for (; _t0; _t0--) {
+///   while (_cp0.restore(_t0 - 1, i, u)) {
+///     ... // the iteration, advancing the state by one step
+///   }
+///   ... // the iteration and its reverse pass
+/// }
+/// ```
+/// Reversing n iterations with N snapshots costs O(n log n) recomputed
+/// iterations instead of O(n) stored ones.
+class revolve {
+  using RawMemory = std::vector<uint8_t>;
+  /// The maximal number of snapshots.
+  std::size_t m_maxSnapshots;
+  /// The size of the state in bytes.
+  std::size_t m_stateSize = 0;
+  /// The iterations at which the snapshots were taken, in increasing order.
+  std::vector<std::size_t> m_positions;
+  /// The snapshots, one after the other.
+  RawMemory m_data;
+  /// The iteration the state is at while advancing.
+  std::size_t m_pos = 0;
+  /// The iteration at which the next snapshot is taken while advancing.
+  std::size_t m_next = 0;
+  /// Whether the state is being advanced to an iteration.
+  bool m_advancing = false;
+  /// The number of iterations recomputed so far.
+  std::size_t m_numAdvances = 0;
+
+  template <typename... Ts> static constexpr std::size_t state_size() {
+    return sum({sizeof(Ts)...});
+  }
+  static constexpr std::size_t sum(std::initializer_list<std::size_t> sizes) {
+    std::size_t res = 0;
+    for (std::size_t size : sizes)
+      res += size;
+    return res;
+  }
+
+  template <typename... Ts> void take(std::size_t pos, const Ts&... state) {
+    if (m_data.empty()) {
+      m_stateSize = state_size<Ts...>();
+      m_data.resize(m_maxSnapshots * m_stateSize);
+    }
+    assert(m_positions.size() < m_maxSnapshots && "no free snapshots");
+    uint8_t* snapshot = m_data.data() + m_positions.size() * m_stateSize;
+    std::size_t offset = 0;
+    int expand[] = {0, (std::memcpy(snapshot + offset, &state, sizeof(Ts)),
+                        offset += sizeof(Ts), 0)...};
+    (void)expand;
+    m_positions.push_back(pos);
+  }
+
+  template <typename... Ts> void load(Ts&... state) {
+    const uint8_t* snapshot =
+        m_data.data() + (m_positions.size() - 1) * m_stateSize;
+    std::size_t offset = 0;
+    int expand[] = {0, (std::memcpy(&state, snapshot + offset, sizeof(Ts)),
+                        offset += sizeof(Ts), 0)...};
+    (void)expand;
+  }
+
+  /// Returns the iteration at which the next snapshot should be taken when
+  /// advancing from the snapshot at capo to reverse the iteration fine - 1,
+  /// as computed by Revolve. Returns fine - 1 if no snapshot is needed.
+  std::size_t next_snapshot(std::size_t capo, std::size_t fine) const {
+    // The snapshot at capo can be overwritten once the iterations after it are
+    // reversed, thus it counts as available.
+    std::size_t ds = m_maxSnapshots - m_positions.size() + 1;
+    if (ds < 2 || fine - capo < 3)
+      return fine - 1;
+    std::size_t reps = 0;
+    std::size_t range = 1;
+    while (range < fine - capo) {
+      reps++;
+      range = range * (reps + ds) / reps;
+    }
+    std::size_t bino1 = range * reps / (ds + reps);
+    std::size_t bino2 = (ds > 1) ? bino1 * ds / (ds + reps - 1) : 1;
+    std::size_t bino3 = 0;
+    if (ds > 1)
+      bino3 = (ds > 2) ? bino2 * (ds - 1) / (ds + reps - 2) : 1;
+    std::size_t bino4 = bino2 * (reps - 1) / ds;
+    std::size_t bino5 = 0;
+    if (ds > 2)
+      bino5 = (ds > 3) ? bino3 * (ds - 2) / reps : 1;
+    std::size_t next = capo;
+    if (fine - capo <= bino1 + bino3)
+      next = capo + bino4;
+    else if (fine - capo >= range - bino5)
+      next = capo + bino1;
+    else
+      next = fine - bino2 - bino3;
+    if (next <= capo)
+      next = capo + 1;
+    return next < fine - 1 ? next : fine - 1;
+  }
+
+public:
+  revolve(std::size_t snapshots) : m_maxSnapshots(snapshots ? snapshots : 1) {}
+
+  /// Called at the beginning of every iteration of the forward pass. Stores
+  /// the state of the first iteration.
+  template <typename... Ts> void forward(const Ts&... state) {
+    if (m_positions.empty())
+      take(0, state...);
+  }
+
+  /// Brings the state to the beginning of the iteration \p target. Returns
+  /// true if the caller has to run one iteration to advance the state and
+  /// call restore() again, false once the state is at \p target.
+  template <typename... Ts> bool restore(std::size_t target, Ts&... state) {
+    if (!m_advancing) {
+      assert(!m_positions.empty() && "the forward pass stored no snapshot");
+      // The snapshots after the target are not needed anymore.
+      while (m_positions.back() > target)
+        m_positions.pop_back();
+      load(state...);
+      m_pos = m_positions.back();
+      m_next = next_snapshot(m_pos, target + 1);
+      m_advancing = true;
+    }
+    if (m_pos == m_next && m_pos != m_positions.back() &&
+        m_positions.size() < m_maxSnapshots) {
+      take(m_pos, state...);
+      m_next = next_snapshot(m_pos, target + 1);
+    }
+    if (m_pos == target) {
+      m_advancing = false;
+      return false;
+    }
+    ++m_pos;
+    ++m_numAdvances;
+    return true;
+  }
+
+  /// Returns the number of iterations recomputed to restore the states.
+  std::size_t num_advances() const { return m_numAdvances; }
+  /// Returns the number of snapshots currently stored.
+  std::size_t num_snapshots() const { return m_positions.size(); }
+};
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_REVOLVE_H
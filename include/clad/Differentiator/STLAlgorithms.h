@@ -0,0 +1,1134 @@
+#ifndef CLAD_DIFFERENTIATOR_STLALGORITHMS_H
+#define CLAD_DIFFERENTIATOR_STLALGORITHMS_H
+
+// Derivatives of the numeric algorithms of the standard library and of their
+// overloads taking an execution policy. The adjoints of the overloads taking
+// a policy are computed by algorithms run with the same policy. The iterators
+// must be random access iterators. The reverse_forw functions of in-place
+// calls store the overwritten range in the restore_tracker of the caller,
+// which restores it before the pullbacks.
+
+#include <clad/Differentiator/BuiltinDerivatives.h>
+#include <clad/Differentiator/FunctionTraits.h>
+#include <clad/Differentiator/RestoreTracker.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clad::custom_derivatives::std {
+
+namespace detail {
+template <typename Op, typename T, template <typename> class Std>
+constexpr bool is_op_v =
+    ::std::is_same_v<Op, Std<T>> || ::std::is_same_v<Op, Std<void>>;
+
+template <typename Policy>
+using enable_if_policy_t = ::std::enable_if_t<
+    ::std::is_execution_policy_v<::std::remove_cv_t<
+        ::std::remove_reference_t<Policy>>>>;
+
+template <typename Iterator>
+using value_t = ::std::remove_const_t<
+    typename ::std::iterator_traits<Iterator>::value_type>;
+
+/// An iterator over the indices [0, n), which lets the standard algorithms
+/// run a loop over several ranges with an execution policy.
+class index_iterator {
+  ::std::size_t m_Index = 0;
+
+public:
+  using iterator_category = ::std::random_access_iterator_tag;
+  using value_type = ::std::size_t;
+  using difference_type = ::std::ptrdiff_t;
+  using pointer = const ::std::size_t*;
+  using reference = ::std::size_t;
+
+  index_iterator() = default;
+  explicit index_iterator(::std::size_t i) : m_Index(i) {}
+  reference operator*() const { return m_Index; }
+  reference operator[](difference_type n) const { return m_Index + n; }
+  index_iterator& operator++() {
+    ++m_Index;
+    return *this;
+  }
+  index_iterator operator++(int) { return index_iterator(m_Index++); }
+  index_iterator& operator--() {
+    --m_Index;
+    return *this;
+  }
+  index_iterator operator--(int) { return index_iterator(m_Index--); }
+  index_iterator& operator+=(difference_type n) {
+    m_Index += n;
+    return *this;
+  }
+  index_iterator& operator-=(difference_type n) {
+    m_Index -= n;
+    return *this;
+  }
+  friend index_iterator operator+(index_iterator it, difference_type n) {
+    return it += n;
+  }
+  friend index_iterator operator+(difference_type n, index_iterator it) {
+    return it += n;
+  }
+  friend index_iterator operator-(index_iterator it, difference_type n) {
+    return it -= n;
+  }
+  friend difference_type operator-(index_iterator a, index_iterator b) {
+    return static_cast<difference_type>(a.m_Index) -
+           static_cast<difference_type>(b.m_Index);
+  }
+  friend bool operator==(index_iterator a, index_iterator b) {
+    return a.m_Index == b.m_Index;
+  }
+  friend bool operator!=(index_iterator a, index_iterator b) {
+    return a.m_Index != b.m_Index;
+  }
+  friend bool operator<(index_iterator a, index_iterator b) {
+    return a.m_Index < b.m_Index;
+  }
+  friend bool operator>(index_iterator a, index_iterator b) {
+    return a.m_Index > b.m_Index;
+  }
+  friend bool operator<=(index_iterator a, index_iterator b) {
+    return a.m_Index <= b.m_Index;
+  }
+  friend bool operator>=(index_iterator a, index_iterator b) {
+    return a.m_Index >= b.m_Index;
+  }
+};
+
+/// Calls \p f for the indices [0, n) with the execution policy \p policy.
+template <typename Policy, typename F>
+void for_each_index(const Policy& policy, ::std::size_t n, F f) {
+  ::std::for_each(policy, index_iterator(0), index_iterator(n), f);
+}
+
+/// \returns the sum of \p f over the indices [0, n) with the execution
+/// policy \p policy.
+template <typename Policy, typename T, typename F>
+T sum_over_indices(const Policy& policy, ::std::size_t n, T init, F f) {
+  return ::std::transform_reduce(policy, index_iterator(0), index_iterator(n),
+                                 init, ::std::plus<>(), f);
+}
+
+/// \returns the adjoint at the position \p i of the adjoint range \p d_first,
+/// which has the iterator type of the differentiated range and thus may be a
+/// constant iterator.
+template <typename Iterator>
+value_t<Iterator>& adjoint_at(Iterator d_first, ::std::size_t i) {
+  using Value = value_t<Iterator>;
+  return const_cast<Value&>(static_cast<const Value&>(d_first[i]));
+}
+
+/// The adjoints of the iterations of a loop over the elements calling \p op
+/// may run concurrently unless they all update the adjoint of \p op.
+template <typename Op>
+constexpr bool has_shared_adjoint_v = !::std::is_empty_v<Op>;
+
+/// Adds to \p d_x the adjoint of the argument \p x of the unary operation
+/// \p op for the adjoint \p d_y of its result.
+template <typename Op, typename T>
+void unary_op_pullback(Op op, T x, T d_y, Op* d_op, T* d_x) {
+  if constexpr (is_op_v<Op, T, ::std::negate>) {
+    *d_x -= d_y;
+  } else if constexpr (has_unary_operator_call_pullback<Op, T>::value) {
+    T d_x_local = 0;
+    op.operator_call_pullback(x, d_y, d_op, &d_x_local);
+    *d_x += d_x_local;
+  } else {
+    static_assert(::std::is_same_v<T, void>,
+                  "This unary operation is not supported by the custom "
+                  "pullbacks of the std algorithms.");
+  }
+}
+
+/// Adds to \p d_x1 and \p d_x2 the adjoints of the arguments of the binary
+/// operation \p op for the adjoint \p d_y of its result.
+template <typename Op, typename T>
+void binary_op_pullback(Op op, T x1, T x2, T d_y, Op* d_op, T* d_x1,
+                        T* d_x2) {
+  if constexpr (is_op_v<Op, T, ::std::plus>) {
+    *d_x1 += d_y;
+    *d_x2 += d_y;
+  } else if constexpr (is_op_v<Op, T, ::std::minus>) {
+    *d_x1 += d_y;
+    *d_x2 -= d_y;
+  } else if constexpr (is_op_v<Op, T, ::std::multiplies>) {
+    *d_x1 += d_y * x2;
+    *d_x2 += x1 * d_y;
+  } else if constexpr (is_op_v<Op, T, ::std::divides>) {
+    *d_x1 += d_y / x2;
+    *d_x2 -= d_y * x1 / (x2 * x2);
+  } else if constexpr (has_binary_operator_call_pullback<Op, T>::value) {
+    T d_x1_local = 0;
+    T d_x2_local = 0;
+    op.operator_call_pullback(x1, x2, d_y, d_op, &d_x1_local, &d_x2_local);
+    *d_x1 += d_x1_local;
+    *d_x2 += d_x2_local;
+  } else {
+    static_assert(::std::is_same_v<T, void>,
+                  "This binary operation is not supported by the custom "
+                  "pullbacks of the std algorithms.");
+  }
+}
+
+/// \returns the value and the tangent of the unary operation \p op at \p x.
+template <typename Op, typename T>
+clad::ValueAndPushforward<T, T> unary_op_pushforward(const Op& op, T x,
+                                                     const Op* d_op, T d_x) {
+  if constexpr (is_op_v<Op, T, ::std::negate>) {
+    return {-x, -d_x};
+  } else if constexpr (has_unary_operator_call_pushforward<Op, T>::value) {
+    auto res = const_cast<Op&>(op).operator_call_pushforward(x, d_op, d_x);
+    return {res.value, res.pushforward};
+  } else {
+    static_assert(::std::is_same_v<T, void>,
+                  "This unary operation is not supported by the custom "
+                  "pushforwards of the std algorithms.");
+  }
+}
+
+/// \returns the value and the tangent of the binary operation \p op at
+/// \p x1, \p x2.
+template <typename Op, typename T>
+clad::ValueAndPushforward<T, T> binary_op_pushforward(const Op& op, T x1, T x2,
+                                                      const Op* d_op, T d_x1,
+                                                      T d_x2) {
+  if constexpr (is_op_v<Op, T, ::std::plus>) {
+    return {x1 + x2, d_x1 + d_x2};
+  } else if constexpr (is_op_v<Op, T, ::std::minus>) {
+    return {x1 - x2, d_x1 - d_x2};
+  } else if constexpr (is_op_v<Op, T, ::std::multiplies>) {
+    return {x1 * x2, d_x1 * x2 + x1 * d_x2};
+  } else if constexpr (is_op_v<Op, T, ::std::divides>) {
+    return {x1 / x2, (d_x1 * x2 - x1 * d_x2) / (x2 * x2)};
+  } else if constexpr (has_binary_operator_call_pushforward<Op, T>::value) {
+    auto res = const_cast<Op&>(op).operator_call_pushforward(x1, x2, d_op,
+                                                             d_x1, d_x2);
+    return {res.value, res.pushforward};
+  } else {
+    static_assert(::std::is_same_v<T, void>,
+                  "This binary operation is not supported by the custom "
+                  "pushforwards of the std algorithms.");
+  }
+}
+
+/// \returns whether the output range starting at \p result overwrites the
+/// input range of \p n elements starting at \p first.
+template <typename InputIt, typename OutputIt>
+bool overwrites(InputIt first, OutputIt result, ::std::size_t n) {
+  return n && static_cast<const void*>(&*first) ==
+                  static_cast<const void*>(&*result);
+}
+
+/// Stores the \p n elements at \p result in \p tracker before an in-place
+/// call overwrites them, thus the pullback of the call reads its inputs once
+/// the caller restores the tracker.
+template <typename OutputIt>
+void save_range(OutputIt result, ::std::size_t n,
+                clad::restore_tracker& tracker) {
+  for (::std::size_t i = 0; i < n; ++i)
+    tracker.store(result[i]);
+}
+
+template <typename Op, typename T> void assert_plus() {
+  static_assert(is_op_v<Op, T, ::std::plus>,
+                "Only std::plus is supported as the reduction of the custom "
+                "derivatives of the std algorithms.");
+}
+
+// Implementations of the derivatives for an execution policy. The overloads
+// without a policy use std::execution::seq.
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename UnaryOp>
+void transform_pullback(const Policy& policy, InputIt first, InputIt last,
+                        OutputIt result, UnaryOp op, InputIt d_first,
+                        OutputIt d_result, UnaryOp* d_op) {
+  using Value = value_t<InputIt>;
+  ::std::size_t n = ::std::distance(first, last);
+  // The output adjoint is reset before the input adjoint is updated, which
+  // is the same element for in-place calls.
+  auto body = [&](::std::size_t i) {
+    Value d_y = adjoint_at(d_result, i);
+    adjoint_at(d_result, i) = 0;
+    unary_op_pullback<UnaryOp, Value>(op, first[i], d_y, d_op,
+                                      &adjoint_at(d_first, i));
+  };
+  if constexpr (has_shared_adjoint_v<UnaryOp>)
+    for_each_index(::std::execution::seq, n, body);
+  else
+    for_each_index(policy, n, body);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2,
+          typename OutputIt, typename BinaryOp>
+void transform_pullback(const Policy& policy, InputIt1 first1, InputIt1 last1,
+                        InputIt2 first2, OutputIt result, BinaryOp op,
+                        InputIt1 d_first1, InputIt2 d_first2,
+                        OutputIt d_result, BinaryOp* d_op) {
+  using Value = value_t<InputIt1>;
+  ::std::size_t n = ::std::distance(first1, last1);
+  auto body = [&](::std::size_t i) {
+    Value d_y = adjoint_at(d_result, i);
+    adjoint_at(d_result, i) = 0;
+    binary_op_pullback<BinaryOp, Value>(op, first1[i], first2[i], d_y, d_op,
+                                        &adjoint_at(d_first1, i),
+                                        &adjoint_at(d_first2, i));
+  };
+  if constexpr (has_shared_adjoint_v<BinaryOp>)
+    for_each_index(::std::execution::seq, n, body);
+  else
+    for_each_index(policy, n, body);
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename UnaryOp>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+transform_pushforward(const Policy& policy, InputIt first, InputIt last,
+                      OutputIt result, const UnaryOp& op, InputIt d_first,
+                      OutputIt d_result, const UnaryOp* d_op) {
+  using Value = value_t<InputIt>;
+  ::std::size_t n = ::std::distance(first, last);
+  for_each_index(policy, n, [&](::std::size_t i) {
+    auto res = unary_op_pushforward<UnaryOp, Value>(op, first[i], d_op,
+                                                    d_first[i]);
+    result[i] = res.value;
+    d_result[i] = res.pushforward;
+  });
+  return {result + n, d_result + n};
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2,
+          typename OutputIt, typename BinaryOp>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+transform_pushforward(const Policy& policy, InputIt1 first1, InputIt1 last1,
+                      InputIt2 first2, OutputIt result, const BinaryOp& op,
+                      InputIt1 d_first1, InputIt2 d_first2, OutputIt d_result,
+                      const BinaryOp* d_op) {
+  using Value = value_t<InputIt1>;
+  ::std::size_t n = ::std::distance(first1, last1);
+  for_each_index(policy, n, [&](::std::size_t i) {
+    auto res = binary_op_pushforward<BinaryOp, Value>(
+        op, first1[i], first2[i], d_op, d_first1[i], d_first2[i]);
+    result[i] = res.value;
+    d_result[i] = res.pushforward;
+  });
+  return {result + n, d_result + n};
+}
+
+/// Adds \p d_output to the adjoints of the elements and to \p d_init.
+template <typename Policy, typename Iterator, typename T>
+void reduce_pullback(const Policy& policy, Iterator first, Iterator last,
+                     T d_output, Iterator d_first, T* d_init) {
+  if (d_init)
+    *d_init += d_output;
+  for_each_index(policy, ::std::distance(first, last), [&](::std::size_t i) {
+    adjoint_at(d_first, i) += d_output;
+  });
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename BinaryOp>
+void transform_reduce_pullback(const Policy& policy, InputIt1 first1,
+                               InputIt1 last1, InputIt2 first2,
+                               BinaryOp transform_op, T d_output,
+                               InputIt1 d_first1, InputIt2 d_first2,
+                               T* d_init, BinaryOp* d_transform_op) {
+  if (d_init)
+    *d_init += d_output;
+  auto body = [&](::std::size_t i) {
+    binary_op_pullback<BinaryOp, T>(
+        transform_op, first1[i], first2[i], d_output, d_transform_op,
+        &adjoint_at(d_first1, i), &adjoint_at(d_first2, i));
+  };
+  ::std::size_t n = ::std::distance(first1, last1);
+  if constexpr (has_shared_adjoint_v<BinaryOp>)
+    for_each_index(::std::execution::seq, n, body);
+  else
+    for_each_index(policy, n, body);
+}
+
+template <typename Policy, typename Iterator, typename T, typename UnaryOp>
+void transform_reduce_pullback(const Policy& policy, Iterator first,
+                               Iterator last, UnaryOp transform_op,
+                               T d_output, Iterator d_first, T* d_init,
+                               UnaryOp* d_transform_op) {
+  if (d_init)
+    *d_init += d_output;
+  auto body = [&](::std::size_t i) {
+    unary_op_pullback<UnaryOp, T>(transform_op, first[i], d_output,
+                                  d_transform_op, &adjoint_at(d_first, i));
+  };
+  ::std::size_t n = ::std::distance(first, last);
+  if constexpr (has_shared_adjoint_v<UnaryOp>)
+    for_each_index(::std::execution::seq, n, body);
+  else
+    for_each_index(policy, n, body);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename BinaryOp>
+T transform_reduce_tangent(const Policy& policy, InputIt1 first1,
+                           InputIt1 last1, InputIt2 first2,
+                           const BinaryOp& transform_op, InputIt1 d_first1,
+                           InputIt2 d_first2, T d_init,
+                           const BinaryOp* d_transform_op) {
+  return sum_over_indices(
+      policy, ::std::distance(first1, last1), d_init, [&](::std::size_t i) {
+        return binary_op_pushforward<BinaryOp, T>(
+                   transform_op, first1[i], first2[i], d_transform_op,
+                   d_first1[i], d_first2[i])
+            .pushforward;
+      });
+}
+
+template <typename Policy, typename Iterator, typename T, typename UnaryOp>
+T transform_reduce_tangent(const Policy& policy, Iterator first, Iterator last,
+                           const UnaryOp& transform_op, Iterator d_first,
+                           T d_init, const UnaryOp* d_transform_op) {
+  return sum_over_indices(
+      policy, ::std::distance(first, last), d_init, [&](::std::size_t i) {
+        return unary_op_pushforward<UnaryOp, T>(transform_op, first[i],
+                                                d_transform_op, d_first[i])
+            .pushforward;
+      });
+}
+
+/// \returns the tangent of std::inner_product, accumulated in the order of
+/// std::inner_product.
+template <typename InputIt1, typename InputIt2, typename T, typename BinaryOp>
+T inner_product_tangent(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                        const BinaryOp& op, InputIt1 d_first1,
+                        InputIt2 d_first2, T d_init, const BinaryOp* d_op) {
+  for (::std::size_t i = 0, n = ::std::distance(first1, last1); i < n; ++i) {
+    auto res = binary_op_pushforward<BinaryOp, T>(
+        op, first1[i], first2[i], d_op, d_first1[i], d_first2[i]);
+    d_init = d_init + res.pushforward;
+  }
+  return d_init;
+}
+
+/// Adds to the adjoint of every element the sum of the adjoints of the
+/// outputs of the scan that it contributes to, which is a scan of the output
+/// adjoints from the end, and resets the output adjoints.
+template <typename Policy, typename InputIt, typename OutputIt>
+void inclusive_scan_pullback(const Policy& policy, InputIt first,
+                             InputIt last, OutputIt result, InputIt d_first,
+                             OutputIt d_result) {
+  using Value = value_t<InputIt>;
+  ::std::size_t n = ::std::distance(first, last);
+  ::std::vector<Value> suffix(n);
+  ::std::inclusive_scan(policy, ::std::make_reverse_iterator(d_result + n),
+                        ::std::make_reverse_iterator(d_result),
+                        suffix.begin());
+  for_each_index(policy, n, [&](::std::size_t i) {
+    adjoint_at(d_result, i) = 0;
+    adjoint_at(d_first, i) += suffix[n - 1 - i];
+  });
+}
+
+/// The output i of an exclusive scan is the sum of \p init and of the
+/// elements before i, thus the element i contributes to the outputs after it.
+template <typename Policy, typename InputIt, typename OutputIt, typename T>
+void exclusive_scan_pullback(const Policy& policy, InputIt first,
+                             InputIt last, OutputIt result, InputIt d_first,
+                             OutputIt d_result, T* d_init) {
+  using Value = value_t<InputIt>;
+  ::std::size_t n = ::std::distance(first, last);
+  if (d_init)
+    *d_init += ::std::reduce(policy, d_result, d_result + n, T());
+  ::std::vector<Value> suffix(n);
+  ::std::exclusive_scan(policy, ::std::make_reverse_iterator(d_result + n),
+                        ::std::make_reverse_iterator(d_result),
+                        suffix.begin(), Value());
+  for_each_index(policy, n, [&](::std::size_t i) {
+    adjoint_at(d_result, i) = 0;
+    adjoint_at(d_first, i) += suffix[n - 1 - i];
+  });
+}
+} // namespace detail
+
+// std::transform
+
+template <typename InputIt, typename OutputIt, typename UnaryOp>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+transform_reverse_forw(InputIt first, InputIt last, OutputIt result,
+                       UnaryOp op, InputIt /*dfirst*/, InputIt /*dlast*/,
+                       OutputIt /*dresult*/, UnaryOp /*dop*/,
+                       clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::transform(first, last, result, op), {}};
+}
+
+template <typename InputIt, typename OutputIt, typename UnaryOp>
+void transform_pullback(InputIt first, InputIt last, OutputIt result,
+                        UnaryOp op, OutputIt /*d_return*/, InputIt* d_first,
+                        InputIt* /*d_last*/, OutputIt* d_result,
+                        UnaryOp* d_op) {
+  detail::transform_pullback(::std::execution::seq, first, last, result, op,
+                             *d_first, *d_result, d_op);
+}
+
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+          typename BinaryOp>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+transform_reverse_forw(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                       OutputIt result, BinaryOp op, InputIt1 /*dfirst1*/,
+                       InputIt1 /*dlast1*/, InputIt2 /*dfirst2*/,
+                       OutputIt /*dresult*/, BinaryOp /*dop*/,
+                       clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first1, last1);
+  if (detail::overwrites(first1, result, n) ||
+      detail::overwrites(first2, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::transform(first1, last1, first2, result, op), {}};
+}
+
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+          typename BinaryOp>
+void transform_pullback(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                        OutputIt result, BinaryOp op,
+                        OutputIt /*d_return*/, InputIt1* d_first1,
+                        InputIt1* /*d_last1*/, InputIt2* d_first2,
+                        OutputIt* d_result, BinaryOp* d_op) {
+  detail::transform_pullback(::std::execution::seq, first1, last1, first2,
+                             result, op, *d_first1, *d_first2, *d_result,
+                             d_op);
+}
+
+template <typename InputIt, typename OutputIt, typename UnaryOp>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+transform_pushforward(InputIt first, InputIt last, OutputIt result,
+                      UnaryOp op, InputIt d_first, InputIt /*d_last*/,
+                      OutputIt d_result, UnaryOp d_op) {
+  return detail::transform_pushforward(::std::execution::seq, first, last,
+                                       result, op, d_first, d_result, &d_op);
+}
+
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+          typename BinaryOp>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+transform_pushforward(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                      OutputIt result, BinaryOp op, InputIt1 d_first1,
+                      InputIt1 /*d_last1*/, InputIt2 d_first2,
+                      OutputIt d_result, BinaryOp d_op) {
+  return detail::transform_pushforward(::std::execution::seq, first1, last1,
+                                       first2, result, op, d_first1, d_first2,
+                                       d_result, &d_op);
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename UnaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+transform_reverse_forw(Policy&& policy, InputIt first, InputIt last,
+                       OutputIt result, UnaryOp op,
+                       const DPolicy& /*dpolicy*/, InputIt /*dfirst*/,
+                       InputIt /*dlast*/, OutputIt /*dresult*/,
+                       UnaryOp /*dop*/, clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::transform(policy, first, last, result, op), {}};
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename UnaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+void transform_pullback(Policy&& policy, InputIt first, InputIt last,
+                        OutputIt result, UnaryOp op,
+                        OutputIt /*d_return*/, DPolicy /*d_policy*/,
+                        InputIt* d_first, InputIt* /*d_last*/,
+                        OutputIt* d_result, UnaryOp* d_op) {
+  detail::transform_pullback(policy, first, last, result, op, *d_first,
+                             *d_result, d_op);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2,
+          typename OutputIt, typename BinaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndAdjoint<OutputIt, OutputIt> transform_reverse_forw(
+    Policy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2,
+    OutputIt result, BinaryOp op, const DPolicy& /*dpolicy*/,
+    InputIt1 /*dfirst1*/, InputIt1 /*dlast1*/, InputIt2 /*dfirst2*/,
+    OutputIt /*dresult*/, BinaryOp /*dop*/, clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first1, last1);
+  if (detail::overwrites(first1, result, n) ||
+      detail::overwrites(first2, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::transform(policy, first1, last1, first2, result, op), {}};
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2,
+          typename OutputIt, typename BinaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+void transform_pullback(Policy&& policy, InputIt1 first1, InputIt1 last1,
+                        InputIt2 first2, OutputIt result, BinaryOp op,
+                        OutputIt /*d_return*/, DPolicy /*d_policy*/,
+                        InputIt1* d_first1, InputIt1* /*d_last1*/,
+                        InputIt2* d_first2, OutputIt* d_result,
+                        BinaryOp* d_op) {
+  detail::transform_pullback(policy, first1, last1, first2, result, op,
+                             *d_first1, *d_first2, *d_result, d_op);
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename UnaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+transform_pushforward(Policy&& policy, InputIt first, InputIt last,
+                      OutputIt result, UnaryOp op,
+                      const DPolicy& /*d_policy*/, InputIt d_first,
+                      InputIt /*d_last*/, OutputIt d_result, UnaryOp d_op) {
+  return detail::transform_pushforward(policy, first, last, result, op,
+                                       d_first, d_result, &d_op);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2,
+          typename OutputIt, typename BinaryOp, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<OutputIt, OutputIt> transform_pushforward(
+    Policy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2,
+    OutputIt result, BinaryOp op, const DPolicy& /*d_policy*/,
+    InputIt1 d_first1, InputIt1 /*d_last1*/, InputIt2 d_first2,
+    OutputIt d_result, BinaryOp d_op) {
+  return detail::transform_pushforward(policy, first1, last1, first2, result,
+                                       op, d_first1, d_first2, d_result,
+                                       &d_op);
+}
+
+// std::reduce
+
+template <typename Iterator>
+void reduce_pullback(Iterator first, Iterator last,
+                     detail::value_t<Iterator> d_output, Iterator* d_first,
+                     Iterator* /*d_last*/) {
+  detail::reduce_pullback(::std::execution::seq, first, last, d_output,
+                          *d_first, (detail::value_t<Iterator>*)nullptr);
+}
+
+template <typename Iterator, typename T>
+void reduce_pullback(Iterator first, Iterator last, T /*init*/, T d_output,
+                     Iterator* d_first, Iterator* /*d_last*/, T* d_init) {
+  detail::reduce_pullback(::std::execution::seq, first, last, d_output,
+                          *d_first, d_init);
+}
+
+template <typename Iterator, typename T, typename BinaryOp>
+void reduce_pullback(Iterator first, Iterator last, T /*init*/,
+                     BinaryOp /*op*/, T d_output, Iterator* d_first,
+                     Iterator* /*d_last*/, T* d_init, BinaryOp* /*d_op*/) {
+  detail::assert_plus<BinaryOp, T>();
+  detail::reduce_pullback(::std::execution::seq, first, last, d_output,
+                          *d_first, d_init);
+}
+
+template <typename Iterator>
+clad::ValueAndPushforward<detail::value_t<Iterator>,
+                          detail::value_t<Iterator>>
+reduce_pushforward(Iterator first, Iterator last, Iterator d_first,
+                   Iterator /*d_last*/) {
+  return {::std::reduce(first, last),
+          ::std::reduce(d_first, d_first + ::std::distance(first, last))};
+}
+
+template <typename Iterator, typename T>
+clad::ValueAndPushforward<T, T>
+reduce_pushforward(Iterator first, Iterator last, T init, Iterator d_first,
+                   Iterator /*d_last*/, T d_init) {
+  return {::std::reduce(first, last, init),
+          ::std::reduce(d_first, d_first + ::std::distance(first, last),
+                        d_init)};
+}
+
+template <typename Iterator, typename T, typename BinaryOp>
+clad::ValueAndPushforward<T, T>
+reduce_pushforward(Iterator first, Iterator last, T init, BinaryOp op,
+                   Iterator d_first, Iterator /*d_last*/, T d_init,
+                   BinaryOp /*d_op*/) {
+  detail::assert_plus<BinaryOp, T>();
+  return {::std::reduce(first, last, init, op),
+          ::std::reduce(d_first, d_first + ::std::distance(first, last),
+                        d_init, op)};
+}
+
+template <typename Policy, typename Iterator, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+void reduce_pullback(Policy&& policy, Iterator first, Iterator last,
+                     detail::value_t<Iterator> d_output, DPolicy /*d_policy*/,
+                     Iterator* d_first, Iterator* /*d_last*/) {
+  detail::reduce_pullback(policy, first, last, d_output, *d_first,
+                          (detail::value_t<Iterator>*)nullptr);
+}
+
+template <typename Policy, typename Iterator, typename T, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+void reduce_pullback(Policy&& policy, Iterator first, Iterator last,
+                     T /*init*/, T d_output, DPolicy /*d_policy*/,
+                     Iterator* d_first, Iterator* /*d_last*/, T* d_init) {
+  detail::reduce_pullback(policy, first, last, d_output, *d_first, d_init);
+}
+
+template <typename Policy, typename Iterator, typename T, typename BinaryOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void reduce_pullback(Policy&& policy, Iterator first, Iterator last,
+                     T /*init*/, BinaryOp /*op*/, T d_output,
+                     DPolicy /*d_policy*/, Iterator* d_first,
+                     Iterator* /*d_last*/, T* d_init, BinaryOp* /*d_op*/) {
+  detail::assert_plus<BinaryOp, T>();
+  detail::reduce_pullback(policy, first, last, d_output, *d_first, d_init);
+}
+
+template <typename Policy, typename Iterator, typename T, typename DPolicy,
+          typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<T, T>
+reduce_pushforward(Policy&& policy, Iterator first, Iterator last, T init,
+                   const DPolicy& /*d_policy*/, Iterator d_first,
+                   Iterator /*d_last*/, T d_init) {
+  return {::std::reduce(policy, first, last, init),
+          ::std::reduce(policy, d_first,
+                        d_first + ::std::distance(first, last), d_init)};
+}
+
+template <typename Policy, typename Iterator, typename T, typename BinaryOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<T, T>
+reduce_pushforward(Policy&& policy, Iterator first, Iterator last, T init,
+                   BinaryOp op, const DPolicy& /*d_policy*/, Iterator d_first,
+                   Iterator /*d_last*/, T d_init, BinaryOp /*d_op*/) {
+  detail::assert_plus<BinaryOp, T>();
+  return {::std::reduce(policy, first, last, init, op),
+          ::std::reduce(policy, d_first,
+                        d_first + ::std::distance(first, last), d_init, op)};
+}
+
+// std::transform_reduce
+
+template <typename InputIt1, typename InputIt2, typename T>
+void transform_reduce_pullback(InputIt1 first1, InputIt1 last1,
+                               InputIt2 first2, T /*init*/, T d_output,
+                               InputIt1* d_first1, InputIt1* /*d_last1*/,
+                               InputIt2* d_first2, T* d_init) {
+  detail::transform_reduce_pullback(::std::execution::seq, first1, last1,
+                                    first2, ::std::multiplies<>(), d_output,
+                                    *d_first1, *d_first2, d_init,
+                                    (::std::multiplies<>*)nullptr);
+}
+
+template <typename InputIt1, typename InputIt2, typename T,
+          typename BinaryReductionOp, typename BinaryTransformOp>
+void transform_reduce_pullback(
+    InputIt1 first1, InputIt1 last1, InputIt2 first2, T /*init*/,
+    BinaryReductionOp /*reduce_op*/, BinaryTransformOp transform_op,
+    T d_output, InputIt1* d_first1, InputIt1* /*d_last1*/,
+    InputIt2* d_first2, T* d_init, BinaryReductionOp* /*d_reduce_op*/,
+    BinaryTransformOp* d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  detail::transform_reduce_pullback(::std::execution::seq, first1, last1,
+                                    first2, transform_op, d_output, *d_first1,
+                                    *d_first2, d_init, d_transform_op);
+}
+
+template <typename Iterator, typename T, typename BinaryReductionOp,
+          typename UnaryTransformOp>
+void transform_reduce_pullback(Iterator first, Iterator last, T /*init*/,
+                               BinaryReductionOp /*reduce_op*/,
+                               UnaryTransformOp transform_op, T d_output,
+                               Iterator* d_first, Iterator* /*d_last*/,
+                               T* d_init, BinaryReductionOp* /*d_reduce_op*/,
+                               UnaryTransformOp* d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  detail::transform_reduce_pullback(::std::execution::seq, first, last,
+                                    transform_op, d_output, *d_first, d_init,
+                                    d_transform_op);
+}
+
+template <typename InputIt1, typename InputIt2, typename T>
+clad::ValueAndPushforward<T, T>
+transform_reduce_pushforward(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                             T init, InputIt1 d_first1, InputIt1 /*d_last1*/,
+                             InputIt2 d_first2, T d_init) {
+  return {::std::transform_reduce(first1, last1, first2, init),
+          detail::transform_reduce_tangent(
+              ::std::execution::seq, first1, last1, first2,
+              ::std::multiplies<>(), d_first1, d_first2, d_init,
+              (const ::std::multiplies<>*)nullptr)};
+}
+
+template <typename InputIt1, typename InputIt2, typename T,
+          typename BinaryReductionOp, typename BinaryTransformOp>
+clad::ValueAndPushforward<T, T> transform_reduce_pushforward(
+    InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+    BinaryReductionOp reduce_op, BinaryTransformOp transform_op,
+    InputIt1 d_first1, InputIt1 /*d_last1*/, InputIt2 d_first2, T d_init,
+    BinaryReductionOp /*d_reduce_op*/, BinaryTransformOp d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  return {::std::transform_reduce(first1, last1, first2, init, reduce_op,
+                                  transform_op),
+          detail::transform_reduce_tangent(::std::execution::seq, first1,
+                                           last1, first2, transform_op,
+                                           d_first1, d_first2, d_init,
+                                           &d_transform_op)};
+}
+
+template <typename Iterator, typename T, typename BinaryReductionOp,
+          typename UnaryTransformOp>
+clad::ValueAndPushforward<T, T> transform_reduce_pushforward(
+    Iterator first, Iterator last, T init, BinaryReductionOp reduce_op,
+    UnaryTransformOp transform_op, Iterator d_first, Iterator /*d_last*/,
+    T d_init, BinaryReductionOp /*d_reduce_op*/,
+    UnaryTransformOp d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  return {::std::transform_reduce(first, last, init, reduce_op, transform_op),
+          detail::transform_reduce_tangent(::std::execution::seq, first, last,
+                                           transform_op, d_first, d_init,
+                                           &d_transform_op)};
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void transform_reduce_pullback(Policy&& policy, InputIt1 first1,
+                               InputIt1 last1, InputIt2 first2, T /*init*/,
+                               T d_output, DPolicy /*d_policy*/,
+                               InputIt1* d_first1, InputIt1* /*d_last1*/,
+                               InputIt2* d_first2, T* d_init) {
+  detail::transform_reduce_pullback(policy, first1, last1, first2,
+                                    ::std::multiplies<>(), d_output,
+                                    *d_first1, *d_first2, d_init,
+                                    (::std::multiplies<>*)nullptr);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename BinaryReductionOp, typename BinaryTransformOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void transform_reduce_pullback(
+    Policy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2,
+    T /*init*/, BinaryReductionOp /*reduce_op*/,
+    BinaryTransformOp transform_op, T d_output, DPolicy /*d_policy*/,
+    InputIt1* d_first1, InputIt1* /*d_last1*/, InputIt2* d_first2,
+    T* d_init, BinaryReductionOp* /*d_reduce_op*/,
+    BinaryTransformOp* d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  detail::transform_reduce_pullback(policy, first1, last1, first2,
+                                    transform_op, d_output, *d_first1,
+                                    *d_first2, d_init, d_transform_op);
+}
+
+template <typename Policy, typename Iterator, typename T,
+          typename BinaryReductionOp, typename UnaryTransformOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void transform_reduce_pullback(Policy&& policy, Iterator first, Iterator last,
+                               T /*init*/, BinaryReductionOp /*reduce_op*/,
+                               UnaryTransformOp transform_op, T d_output,
+                               DPolicy /*d_policy*/, Iterator* d_first,
+                               Iterator* /*d_last*/, T* d_init,
+                               BinaryReductionOp* /*d_reduce_op*/,
+                               UnaryTransformOp* d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  detail::transform_reduce_pullback(policy, first, last, transform_op,
+                                    d_output, *d_first, d_init,
+                                    d_transform_op);
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<T, T> transform_reduce_pushforward(
+    Policy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+    const DPolicy& /*d_policy*/, InputIt1 d_first1, InputIt1 /*d_last1*/,
+    InputIt2 d_first2, T d_init) {
+  return {::std::transform_reduce(policy, first1, last1, first2, init),
+          detail::transform_reduce_tangent(
+              policy, first1, last1, first2, ::std::multiplies<>(), d_first1,
+              d_first2, d_init, (const ::std::multiplies<>*)nullptr)};
+}
+
+template <typename Policy, typename InputIt1, typename InputIt2, typename T,
+          typename BinaryReductionOp, typename BinaryTransformOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<T, T> transform_reduce_pushforward(
+    Policy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+    BinaryReductionOp reduce_op, BinaryTransformOp transform_op,
+    const DPolicy& /*d_policy*/, InputIt1 d_first1, InputIt1 /*d_last1*/,
+    InputIt2 d_first2, T d_init, BinaryReductionOp /*d_reduce_op*/,
+    BinaryTransformOp d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  return {::std::transform_reduce(policy, first1, last1, first2, init,
+                                  reduce_op, transform_op),
+          detail::transform_reduce_tangent(policy, first1, last1, first2,
+                                           transform_op, d_first1, d_first2,
+                                           d_init, &d_transform_op)};
+}
+
+template <typename Policy, typename Iterator, typename T,
+          typename BinaryReductionOp, typename UnaryTransformOp,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<T, T> transform_reduce_pushforward(
+    Policy&& policy, Iterator first, Iterator last, T init,
+    BinaryReductionOp reduce_op, UnaryTransformOp transform_op,
+    const DPolicy& /*d_policy*/, Iterator d_first, Iterator /*d_last*/,
+    T d_init, BinaryReductionOp /*d_reduce_op*/,
+    UnaryTransformOp d_transform_op) {
+  detail::assert_plus<BinaryReductionOp, T>();
+  return {::std::transform_reduce(policy, first, last, init, reduce_op,
+                                  transform_op),
+          detail::transform_reduce_tangent(policy, first, last, transform_op,
+                                           d_first, d_init, &d_transform_op)};
+}
+
+// std::inclusive_scan and std::exclusive_scan
+
+template <typename InputIt, typename OutputIt>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+inclusive_scan_reverse_forw(InputIt first, InputIt last, OutputIt result,
+                            InputIt /*dfirst*/, InputIt /*dlast*/,
+                            OutputIt /*dresult*/,
+                            clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::inclusive_scan(first, last, result), {}};
+}
+
+template <typename InputIt, typename OutputIt>
+void inclusive_scan_pullback(InputIt first, InputIt last,
+                             OutputIt result, OutputIt /*d_return*/,
+                             InputIt* d_first, InputIt* /*d_last*/,
+                             OutputIt* d_result) {
+  detail::inclusive_scan_pullback(::std::execution::seq, first, last, result,
+                                  *d_first, *d_result);
+}
+
+template <typename InputIt, typename OutputIt, typename BinaryOp>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+inclusive_scan_reverse_forw(InputIt first, InputIt last, OutputIt result,
+                            BinaryOp op, InputIt /*dfirst*/, InputIt /*dlast*/,
+                            OutputIt /*dresult*/, BinaryOp /*dop*/,
+                            clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::inclusive_scan(first, last, result, op), {}};
+}
+
+template <typename InputIt, typename OutputIt, typename BinaryOp>
+void inclusive_scan_pullback(InputIt first, InputIt last,
+                             OutputIt result, BinaryOp /*op*/,
+                             OutputIt /*d_return*/, InputIt* d_first,
+                             InputIt* /*d_last*/, OutputIt* d_result,
+                             BinaryOp* /*d_op*/) {
+  detail::assert_plus<BinaryOp, detail::value_t<InputIt>>();
+  detail::inclusive_scan_pullback(::std::execution::seq, first, last, result,
+                                  *d_first, *d_result);
+}
+
+template <typename InputIt, typename OutputIt>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+inclusive_scan_pushforward(InputIt first, InputIt last, OutputIt result,
+                           InputIt d_first, InputIt /*d_last*/,
+                           OutputIt d_result) {
+  return {::std::inclusive_scan(first, last, result),
+          ::std::inclusive_scan(
+              d_first, d_first + ::std::distance(first, last), d_result)};
+}
+
+template <typename InputIt, typename OutputIt, typename T>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+exclusive_scan_reverse_forw(InputIt first, InputIt last, OutputIt result,
+                            T init, InputIt /*dfirst*/, InputIt /*dlast*/,
+                            OutputIt /*dresult*/, T /*dinit*/,
+                            clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::exclusive_scan(first, last, result, init), {}};
+}
+
+template <typename InputIt, typename OutputIt, typename T>
+void exclusive_scan_pullback(InputIt first, InputIt last,
+                             OutputIt result, T /*init*/,
+                             OutputIt /*d_return*/, InputIt* d_first,
+                             InputIt* /*d_last*/, OutputIt* d_result,
+                             T* d_init) {
+  detail::exclusive_scan_pullback(::std::execution::seq, first, last, result,
+                                  *d_first, *d_result, d_init);
+}
+
+template <typename InputIt, typename OutputIt, typename T>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+exclusive_scan_pushforward(InputIt first, InputIt last, OutputIt result,
+                           T init, InputIt d_first, InputIt /*d_last*/,
+                           OutputIt d_result, T d_init) {
+  return {::std::exclusive_scan(first, last, result, init),
+          ::std::exclusive_scan(d_first,
+                                d_first + ::std::distance(first, last),
+                                d_result, d_init)};
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+inclusive_scan_reverse_forw(Policy&& policy, InputIt first, InputIt last,
+                            OutputIt result, const DPolicy& /*dpolicy*/,
+                            InputIt /*dfirst*/, InputIt /*dlast*/,
+                            OutputIt /*dresult*/,
+                            clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::inclusive_scan(policy, first, last, result), {}};
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void inclusive_scan_pullback(Policy&& policy, InputIt first, InputIt last,
+                             OutputIt result, OutputIt /*d_return*/,
+                             DPolicy /*d_policy*/, InputIt* d_first,
+                             InputIt* /*d_last*/, OutputIt* d_result) {
+  detail::inclusive_scan_pullback(policy, first, last, result, *d_first,
+                                  *d_result);
+}
+
+template <typename Policy, typename InputIt, typename OutputIt,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+inclusive_scan_pushforward(Policy&& policy, InputIt first, InputIt last,
+                           OutputIt result, const DPolicy& /*d_policy*/,
+                           InputIt d_first, InputIt /*d_last*/,
+                           OutputIt d_result) {
+  return {::std::inclusive_scan(policy, first, last, result),
+          ::std::inclusive_scan(policy, d_first,
+                                d_first + ::std::distance(first, last),
+                                d_result)};
+}
+
+template <typename Policy, typename InputIt, typename OutputIt, typename T,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndAdjoint<OutputIt, OutputIt>
+exclusive_scan_reverse_forw(Policy&& policy, InputIt first, InputIt last,
+                            OutputIt result, T init,
+                            const DPolicy& /*dpolicy*/, InputIt /*dfirst*/,
+                            InputIt /*dlast*/, OutputIt /*dresult*/,
+                            T /*dinit*/, clad::restore_tracker& tracker) {
+  ::std::size_t n = ::std::distance(first, last);
+  if (detail::overwrites(first, result, n))
+    detail::save_range(result, n, tracker);
+  return {::std::exclusive_scan(policy, first, last, result, init), {}};
+}
+
+template <typename Policy, typename InputIt, typename OutputIt, typename T,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+void exclusive_scan_pullback(Policy&& policy, InputIt first, InputIt last,
+                             OutputIt result, T /*init*/,
+                             OutputIt /*d_return*/, DPolicy /*d_policy*/,
+                             InputIt* d_first, InputIt* /*d_last*/,
+                             OutputIt* d_result, T* d_init) {
+  detail::exclusive_scan_pullback(policy, first, last, result, *d_first,
+                                  *d_result, d_init);
+}
+
+template <typename Policy, typename InputIt, typename OutputIt, typename T,
+          typename DPolicy, typename = detail::enable_if_policy_t<Policy>>
+clad::ValueAndPushforward<OutputIt, OutputIt>
+exclusive_scan_pushforward(Policy&& policy, InputIt first, InputIt last,
+                           OutputIt result, T init,
+                           const DPolicy& /*d_policy*/, InputIt d_first,
+                           InputIt /*d_last*/, OutputIt d_result, T d_init) {
+  return {::std::exclusive_scan(policy, first, last, result, init),
+          ::std::exclusive_scan(policy, d_first,
+                                d_first + ::std::distance(first, last),
+                                d_result, d_init)};
+}
+
+// std::inner_product and std::accumulate
+
+template <typename InputIt1, typename InputIt2, typename T>
+void inner_product_pullback(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                            T init, T d_output, InputIt1* d_first1,
+                            InputIt1* d_last1, InputIt2* d_first2,
+                            T* d_init) {
+  transform_reduce_pullback(first1, last1, first2, init, d_output, d_first1,
+                            d_last1, d_first2, d_init);
+}
+
+template <typename InputIt1, typename InputIt2, typename T, typename BinaryOp1,
+          typename BinaryOp2>
+void inner_product_pullback(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                            T init, BinaryOp1 op1, BinaryOp2 op2, T d_output,
+                            InputIt1* d_first1, InputIt1* d_last1,
+                            InputIt2* d_first2, T* d_init, BinaryOp1* d_op1,
+                            BinaryOp2* d_op2) {
+  transform_reduce_pullback(first1, last1, first2, init, op1, op2, d_output,
+                            d_first1, d_last1, d_first2, d_init, d_op1, d_op2);
+}
+
+template <typename InputIt1, typename InputIt2, typename T>
+clad::ValueAndPushforward<T, T>
+inner_product_pushforward(InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                          T init, InputIt1 d_first1, InputIt1 /*d_last1*/,
+                          InputIt2 d_first2, T d_init) {
+  return {::std::inner_product(first1, last1, first2, init),
+          detail::inner_product_tangent(first1, last1, first2,
+                                        ::std::multiplies<>(), d_first1,
+                                        d_first2, d_init,
+                                        (const ::std::multiplies<>*)nullptr)};
+}
+
+template <typename InputIt1, typename InputIt2, typename T, typename BinaryOp1,
+          typename BinaryOp2>
+clad::ValueAndPushforward<T, T> inner_product_pushforward(
+    InputIt1 first1, InputIt1 last1, InputIt2 first2, T init, BinaryOp1 op1,
+    BinaryOp2 op2, InputIt1 d_first1, InputIt1 /*d_last1*/, InputIt2 d_first2,
+    T d_init, BinaryOp1 /*d_op1*/, BinaryOp2 d_op2) {
+  detail::assert_plus<BinaryOp1, T>();
+  return {::std::inner_product(first1, last1, first2, init, op1, op2),
+          detail::inner_product_tangent(first1, last1, first2, op2, d_first1,
+                                        d_first2, d_init, &d_op2)};
+}
+
+template <typename Iterator, typename T>
+void accumulate_pullback(Iterator first, Iterator last, T init, T d_output,
+                         Iterator* d_first, Iterator* d_last, T* d_init) {
+  reduce_pullback(first, last, init, d_output, d_first, d_last, d_init);
+}
+
+template <typename Iterator, typename T, typename BinaryOp>
+void accumulate_pullback(Iterator first, Iterator last, T init, BinaryOp op,
+                         T d_output, Iterator* d_first, Iterator* d_last,
+                         T* d_init, BinaryOp* d_op) {
+  reduce_pullback(first, last, init, op, d_output, d_first, d_last, d_init,
+                  d_op);
+}
+
+template <typename Iterator, typename T>
+clad::ValueAndPushforward<T, T>
+accumulate_pushforward(Iterator first, Iterator last, T init, Iterator d_first,
+                       Iterator /*d_last*/, T d_init) {
+  return {::std::accumulate(first, last, init),
+          ::std::accumulate(d_first, d_first + ::std::distance(first, last),
+                            d_init)};
+}
+
+template <typename Iterator, typename T, typename BinaryOp>
+clad::ValueAndPushforward<T, T>
+accumulate_pushforward(Iterator first, Iterator last, T init, BinaryOp op,
+                       Iterator d_first, Iterator /*d_last*/, T d_init,
+                       BinaryOp /*d_op*/) {
+  detail::assert_plus<BinaryOp, T>();
+  return {::std::accumulate(first, last, init, op),
+          ::std::accumulate(d_first, d_first + ::std::distance(first, last),
+                            d_init, op)};
+}
+} // namespace clad::custom_derivatives::std
+
+#endif // CLAD_DIFFERENTIATOR_STLALGORITHMS_H
@@ -0,0 +1,464 @@
+#ifndef CLAD_DIFFERENTIATOR_SPARSITY_H
+#define CLAD_DIFFERENTIATOR_SPARSITY_H
+
+#include "clad/Differentiator/Array.h"
+#include "clad/Differentiator/Matrix.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#ifndef CLAD_SPARSITY_TRACE_WIDTH
+/// The number of columns of a sparse jacobian whose sparsity pattern is
+/// detected by a single vector forward pass.
+#define CLAD_SPARSITY_TRACE_WIDTH 64
+#endif
+
+namespace clad {
+namespace sparsity {
+/// Colors the columns of the sparsity pattern of a rows x cols matrix given in
+/// the CSR format, such that two columns with a nonzero in the same row have
+/// different colors. Uses the greedy distance-2 coloring of the bipartite
+/// graph of the pattern, in the natural order of the columns, which is optimal
+/// for banded patterns. Stores the color of each column in colors and returns
+/// the number of colors.
+inline std::size_t color_columns(std::size_t rows, std::size_t cols,
+                                 const std::size_t* row_ptr,
+                                 const std::size_t* col_idx,
+                                 std::size_t* colors) {
+  // Transpose the pattern to find the rows of each column.
+  std::vector<std::size_t> col_ptr(cols + 1, 0);
+  std::vector<std::size_t> row_idx(row_ptr[rows]);
+  for (std::size_t k = 0; k < row_ptr[rows]; ++k)
+    ++col_ptr[col_idx[k] + 1];
+  for (std::size_t j = 0; j < cols; ++j)
+    col_ptr[j + 1] += col_ptr[j];
+  std::vector<std::size_t> next(col_ptr.begin(), col_ptr.end() - 1);
+  for (std::size_t i = 0; i < rows; ++i)
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+      row_idx[next[col_idx[k]]++] = i;
+
+  // forbidden[c] == j + 1 if a column sharing a row with column j has color c.
+  std::vector<std::size_t> forbidden(cols, 0);
+  std::size_t numColors = 0;
+  for (std::size_t j = 0; j < cols; ++j) {
+    for (std::size_t r = col_ptr[j]; r < col_ptr[j + 1]; ++r) {
+      std::size_t i = row_idx[r];
+      for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+        if (col_idx[k] < j)
+          forbidden[colors[col_idx[k]]] = j + 1;
+    }
+    std::size_t color = 0;
+    while (forbidden[color] == j + 1)
+      ++color;
+    colors[j] = color;
+    if (color + 1 > numColors)
+      numColors = color + 1;
+  }
+  return numColors;
+}
+
+/// Star colors the adjacency graph of the symmetric sparsity pattern of an
+/// n x n matrix given in the CSR format, whose diagonal is ignored: adjacent
+/// columns have different colors and every path on four vertices uses at least
+/// three colors. Then each nonzero of the matrix can be read directly from the
+/// product of the matrix with the seed of the coloring, see hessian_sweep.
+/// Stores the color of each column in colors and returns the number of colors.
+inline std::size_t star_color(std::size_t n, const std::size_t* row_ptr,
+                              const std::size_t* col_idx,
+                              std::size_t* colors) {
+  const std::size_t uncolored = ~static_cast<std::size_t>(0);
+  for (std::size_t j = 0; j < n; ++j)
+    colors[j] = uncolored;
+  // forbidden[c] == v + 1 if coloring v with c makes a path two-colored.
+  std::vector<std::size_t> forbidden(n, 0);
+  // seen[c] == v + 1 if a neighbour of v has color c, repeated[c] == v + 1 if
+  // at least two of them have it.
+  std::vector<std::size_t> seen(n, 0);
+  std::vector<std::size_t> repeated(n, 0);
+  std::size_t numColors = 0;
+  for (std::size_t v = 0; v < n; ++v) {
+    for (std::size_t k = row_ptr[v]; k < row_ptr[v + 1]; ++k) {
+      std::size_t w = col_idx[k];
+      if (w == v || colors[w] == uncolored)
+        continue;
+      forbidden[colors[w]] = v + 1;
+      if (seen[colors[w]] == v + 1)
+        repeated[colors[w]] = v + 1;
+      seen[colors[w]] = v + 1;
+    }
+    // Coloring v like a vertex x at distance 2, through w, two-colors the path
+    // u - v - w - x if another neighbour u of v has the color of w, and the
+    // path v - w - x - y if another neighbour y of x has the color of w.
+    for (std::size_t k = row_ptr[v]; k < row_ptr[v + 1]; ++k) {
+      std::size_t w = col_idx[k];
+      if (w == v || colors[w] == uncolored)
+        continue;
+      for (std::size_t l = row_ptr[w]; l < row_ptr[w + 1]; ++l) {
+        std::size_t x = col_idx[l];
+        if (x == w || x == v || colors[x] == uncolored ||
+            forbidden[colors[x]] == v + 1)
+          continue;
+        if (repeated[colors[w]] == v + 1) {
+          forbidden[colors[x]] = v + 1;
+          continue;
+        }
+        for (std::size_t m = row_ptr[x]; m < row_ptr[x + 1]; ++m) {
+          std::size_t y = col_idx[m];
+          if (y != x && y != w && colors[y] == colors[w]) {
+            forbidden[colors[x]] = v + 1;
+            break;
+          }
+        }
+      }
+    }
+    std::size_t color = 0;
+    while (forbidden[color] == v + 1)
+      ++color;
+    colors[v] = color;
+    if (color + 1 > numColors)
+      numColors = color + 1;
+  }
+  return numColors;
+}
+
+/// The seed of the directions whose tangents reveal the sparsity pattern.
+/// NaN propagates through every product of the pushforward, so that partial
+/// derivatives which happen to be zero at the traced point still show up in
+/// the pattern.
+template <typename T> T trace_seed() {
+  if (std::numeric_limits<T>::has_quiet_NaN)
+    return std::numeric_limits<T>::quiet_NaN();
+  return static_cast<T>(1);
+}
+} // namespace sparsity
+
+/// Drives the vector forward passes that compute a sparse jacobian into a
+/// clad::csr_matrix. This class is not meant to be used by the user, the
+/// function generated by clad::sparse_jacobian calls the vector pushforward
+/// of the differentiated function with seed() and product() for as long as
+/// next() returns true:
+///
+///   clad::jacobian_sweep<double> _sweep(*_d_jac);
+///   while (_sweep.next())
+///     f_vector_pushforward(x, y, _sweep.seed(), _sweep.product());
+///
+/// If the jacobian has no sparsity pattern yet, the first passes trace it by
+/// seeding CLAD_SPARSITY_TRACE_WIDTH columns at a time. Then the columns are
+/// colored and a single pass, seeded with one direction per color, computes
+/// all the nonzeros, which are recovered from the compressed product.
+template <typename T> class jacobian_sweep {
+  enum class stage { start, trace, compressed, done };
+
+  /// The jacobian being computed.
+  csr_matrix<T>& m_jac;
+  /// The pass for which seed() and product() are set up.
+  stage m_stage = stage::start;
+  /// The first column traced by the current trace pass.
+  std::size_t m_traceBegin = 0;
+  /// The columns of the nonzeros of each row traced so far.
+  std::vector<std::vector<std::size_t>> m_rowPattern;
+  /// The color of each column.
+  std::vector<std::size_t> m_colors;
+  /// The directions of the current pass, one column per direction.
+  matrix<T> m_seed;
+  /// The tangents of the outputs in the directions of the current pass.
+  matrix<T> m_product;
+
+  /// Sets up the next trace pass. Stores the pattern in the jacobian and
+  /// returns false if all the columns have been traced.
+  bool begin_trace_pass() {
+    std::size_t cols = m_jac.cols();
+    if (m_traceBegin >= cols) {
+      std::size_t rows = m_jac.rows();
+      clad::array<std::size_t> row_ptr(rows + 1);
+      for (std::size_t i = 0; i < rows; ++i)
+        row_ptr[i + 1] = row_ptr[i] + m_rowPattern[i].size();
+      clad::array<std::size_t> col_idx(row_ptr[rows]);
+      for (std::size_t i = 0; i < rows; ++i)
+        for (std::size_t k = 0; k < m_rowPattern[i].size(); ++k)
+          col_idx[row_ptr[i] + k] = m_rowPattern[i][k];
+      m_jac.set_pattern(std::move(row_ptr), std::move(col_idx));
+      m_rowPattern.clear();
+      return false;
+    }
+    std::size_t width = cols - m_traceBegin;
+    if (width > CLAD_SPARSITY_TRACE_WIDTH)
+      width = CLAD_SPARSITY_TRACE_WIDTH;
+    m_seed = matrix<T>(cols, width);
+    for (std::size_t k = 0; k < width; ++k)
+      m_seed(m_traceBegin + k, k) = sparsity::trace_seed<T>();
+    m_product = matrix<T>(m_jac.rows(), width);
+    m_stage = stage::trace;
+    return true;
+  }
+
+  /// Records the nonzeros found by the current trace pass.
+  void end_trace_pass() {
+    for (std::size_t i = 0, e = m_jac.rows(); i < e; ++i)
+      for (std::size_t k = 0; k < m_product.cols(); ++k)
+        if (!(m_product(i, k) == static_cast<T>(0)))
+          m_rowPattern[i].push_back(m_traceBegin + k);
+    m_traceBegin += m_seed.cols();
+  }
+
+  /// Colors the columns and sets up the compressed pass.
+  void begin_compressed_pass() {
+    std::size_t cols = m_jac.cols();
+    m_colors.assign(cols, 0);
+    std::size_t numColors =
+        sparsity::color_columns(m_jac.rows(), cols, m_jac.row_ptr(),
+                                m_jac.col_idx(), m_colors.data());
+    // Keep at least one direction, the pushforward still computes the outputs.
+    std::size_t width = numColors ? numColors : 1;
+    m_seed = matrix<T>(cols, width);
+    for (std::size_t j = 0; j < cols; ++j)
+      m_seed(j, m_colors[j]) = 1;
+    m_product = matrix<T>(m_jac.rows(), width);
+    m_stage = stage::compressed;
+  }
+
+  /// Recovers the nonzeros from the product of the compressed pass. Columns
+  /// sharing a row have different colors, so each nonzero is the only one of
+  /// its row contributing to the tangent of its color.
+  void end_compressed_pass() {
+    const std::size_t* row_ptr = m_jac.row_ptr();
+    const std::size_t* col_idx = m_jac.col_idx();
+    T* values = m_jac.values();
+    for (std::size_t i = 0, e = m_jac.rows(); i < e; ++i)
+      for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+        values[k] = m_product(i, m_colors[col_idx[k]]);
+  }
+
+public:
+  explicit jacobian_sweep(csr_matrix<T>& jac)
+      : m_jac(jac), m_seed(0, 0), m_product(0, 0) {}
+
+  /// Consumes the result of the previous pass and sets up the next one.
+  /// Returns false when the jacobian is complete.
+  bool next() {
+    switch (m_stage) {
+    case stage::start:
+      if (!m_jac.has_pattern()) {
+        m_rowPattern.assign(m_jac.rows(), {});
+        if (begin_trace_pass())
+          return true;
+      }
+      begin_compressed_pass();
+      return true;
+    case stage::trace:
+      end_trace_pass();
+      if (begin_trace_pass())
+        return true;
+      begin_compressed_pass();
+      return true;
+    case stage::compressed:
+      end_compressed_pass();
+      m_stage = stage::done;
+      return false;
+    case stage::done:
+      return false;
+    }
+    return false;
+  }
+
+  /// Returns the directions of the independent array for the current pass.
+  matrix<T>& seed() { return m_seed; }
+
+  /// Returns the matrix receiving the tangents of the output array.
+  matrix<T>& product() { return m_product; }
+
+  /// Returns the number of directions of the current pass.
+  std::size_t width() const { return m_seed.cols(); }
+};
+
+/// Drives the hessian vector products that compute a sparse hessian into a
+/// clad::csr_matrix, holding both triangles of the symmetric matrix. This
+/// class is not meant to be used by the user, the function generated by
+/// clad::sparse_hessian calls the pullback of the pushforward of the
+/// differentiated function, which computes the product of the hessian with
+/// direction() into product(), for as long as next() returns true:
+///
+///   clad::hessian_sweep<double> _sweep(*_d_hess);
+///   while (_sweep.next())
+///     f_pushforward_pullback(x, _sweep.direction(), _d_y, _sweep.product(),
+///                            _sweep.gradient());
+///
+/// If the hessian has no sparsity pattern yet, it is traced one column per
+/// product, with the same pullback, as the forward mode cannot differentiate
+/// the tapes that the gradient of a loop uses. A known pattern can be set with
+/// csr_matrix::set_pattern() instead.
+/// Then the columns are star colored and one product per color computes all
+/// the nonzeros.
+template <typename T> class hessian_sweep {
+  enum class stage { start, trace, compressed, done };
+
+  /// The hessian being computed.
+  csr_matrix<T>& m_hess;
+  /// The pass for which direction() and product() are set up.
+  stage m_stage = stage::start;
+  /// The traced column, or the color of the current compressed pass.
+  std::size_t m_pass = 0;
+  /// The columns of the nonzeros of each row traced so far.
+  std::vector<std::vector<std::size_t>> m_rowPattern;
+  /// The color of each column.
+  std::vector<std::size_t> m_colors;
+  /// The number of colors.
+  std::size_t m_numColors = 0;
+  /// The direction of the current product.
+  std::vector<T> m_direction;
+  /// Receives the gradient computed along with the product, which is unused.
+  std::vector<T> m_gradient;
+  /// The products, one after the other in the compressed passes.
+  std::vector<T> m_products;
+
+  /// Zeroes the buffers accumulating the results of a pass.
+  void reset_gradient() { m_gradient.assign(m_hess.cols(), 0); }
+
+  /// Sets up the next trace pass. Stores the pattern in the hessian and
+  /// returns false if all the columns have been traced.
+  bool begin_trace_pass() {
+    std::size_t n = m_hess.cols();
+    if (m_pass >= n) {
+      clad::array<std::size_t> row_ptr(n + 1);
+      for (std::size_t i = 0; i < n; ++i) {
+        std::vector<std::size_t>& row = m_rowPattern[i];
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        row_ptr[i + 1] = row_ptr[i] + row.size();
+      }
+      clad::array<std::size_t> col_idx(row_ptr[n]);
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t k = 0; k < m_rowPattern[i].size(); ++k)
+          col_idx[row_ptr[i] + k] = m_rowPattern[i][k];
+      m_hess.set_pattern(std::move(row_ptr), std::move(col_idx));
+      m_rowPattern.clear();
+      return false;
+    }
+    m_direction.assign(n, 0);
+    m_direction[m_pass] = sparsity::trace_seed<T>();
+    m_products.assign(n, 0);
+    reset_gradient();
+    m_stage = stage::trace;
+    return true;
+  }
+
+  /// Records the nonzeros of the traced column, and of the symmetric row.
+  void end_trace_pass() {
+    for (std::size_t i = 0, n = m_hess.cols(); i < n; ++i) {
+      if (m_products[i] == static_cast<T>(0))
+        continue;
+      m_rowPattern[i].push_back(m_pass);
+      m_rowPattern[m_pass].push_back(i);
+    }
+  }
+
+  /// Sets up the product with the direction of the color m_pass.
+  void begin_compressed_pass() {
+    std::size_t n = m_hess.cols();
+    for (std::size_t j = 0; j < n; ++j)
+      m_direction[j] = m_colors[j] == m_pass ? 1 : 0;
+    reset_gradient();
+  }
+
+  /// Recovers the nonzeros from the products. The entry (i, j) is read from
+  /// row i of the product of the color of j if j is the only column of row i
+  /// with that color, otherwise the star coloring ensures that i is the only
+  /// column of row j with the color of i.
+  void recover() {
+    std::size_t n = m_hess.cols();
+    const std::size_t* row_ptr = m_hess.row_ptr();
+    const std::size_t* col_idx = m_hess.col_idx();
+    T* values = m_hess.values();
+    // count[c] is the number of nonzeros of color c in the current row, valid
+    // if stamp[c] is the current row + 1.
+    std::vector<std::size_t> count(m_numColors, 0);
+    std::vector<std::size_t> stamp(m_numColors, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+        std::size_t c = m_colors[col_idx[k]];
+        if (stamp[c] != i + 1) {
+          stamp[c] = i + 1;
+          count[c] = 0;
+        }
+        ++count[c];
+      }
+      for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+        std::size_t j = col_idx[k];
+        if (j == i || count[m_colors[j]] == 1)
+          values[k] = m_products[m_colors[j] * n + i];
+        else
+          values[k] = m_products[m_colors[i] * n + j];
+      }
+    }
+  }
+
+public:
+  explicit hessian_sweep(csr_matrix<T>& hess) : m_hess(hess) {
+    assert(hess.rows() == hess.cols() && "the hessian must be square");
+  }
+
+  /// Consumes the result of the previous product and sets up the next one.
+  /// Returns false when the hessian is complete.
+  bool next() {
+    switch (m_stage) {
+    case stage::start:
+      if (!m_hess.has_pattern()) {
+        m_rowPattern.assign(m_hess.cols(), {});
+        if (begin_trace_pass())
+          return true;
+      }
+      break;
+    case stage::trace:
+      end_trace_pass();
+      ++m_pass;
+      if (begin_trace_pass())
+        return true;
+      break;
+    case stage::compressed:
+      if (++m_pass < m_numColors) {
+        begin_compressed_pass();
+        return true;
+      }
+      recover();
+      m_stage = stage::done;
+      return false;
+    case stage::done:
+      return false;
+    }
+
+    // Color the columns and set up the first compressed pass.
+    std::size_t n = m_hess.cols();
+    m_colors.assign(n, 0);
+    m_numColors = sparsity::star_color(n, m_hess.row_ptr(), m_hess.col_idx(),
+                                       m_colors.data());
+    m_stage = stage::done;
+    if (!m_numColors)
+      return false;
+    m_direction.assign(n, 0);
+    m_products.assign(n * m_numColors, 0);
+    m_pass = 0;
+    begin_compressed_pass();
+    m_stage = stage::compressed;
+    return true;
+  }
+
+  /// Returns the direction of the current product.
+  T* direction() { return m_direction.data(); }
+
+  /// Returns the buffer receiving the current product.
+  T* product() {
+    if (m_stage == stage::compressed)
+      return m_products.data() + m_pass * m_hess.cols();
+    return m_products.data();
+  }
+
+  /// Returns the buffer receiving the gradient computed along the product.
+  T* gradient() { return m_gradient.data(); }
+};
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_SPARSITY_H
@@ -0,0 +1,353 @@
+#ifndef CLAD_DIFFERENTIATOR_SPILLINGTAPE_H
+#define CLAD_DIFFERENTIATOR_SPILLINGTAPE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define CLAD_HAS_TAPE_SPILL_FILE 1
+#endif
+
+#ifdef CLAD_TAPE_SPILL_LIMIT
+#define CLAD_TAPE_SPILL_LIMIT_DEFAULT CLAD_TAPE_SPILL_LIMIT
+#else
+#define CLAD_TAPE_SPILL_LIMIT_DEFAULT (std::size_t(1) << 30)
+#endif
+
+namespace clad {
+
+/// \returns the number of bytes of slabs a new `clad::spilling_tape_impl`
+/// keeps in memory. Defaults to CLAD_TAPE_SPILL_LIMIT, or 1 GiB if it is not
+/// defined. Changing it affects the tapes created afterwards.
+inline std::size_t& tape_spill_limit() {
+  static std::size_t limit = CLAD_TAPE_SPILL_LIMIT_DEFAULT;
+  return limit;
+}
+
+/// A variant of `clad::tape_impl` for tapes which do not fit in memory. Once
+/// its slabs exceed the byte limit, the oldest slabs are copied to a memory
+/// mapped temporary file and their storage is reused. The forward pass pushes
+/// and spills the slabs in order and the reverse pass pops them in reverse
+/// order, thus the file is written and read sequentially. When the reverse
+/// pass reaches a spilled slab, it is copied back and the kernel is asked to
+/// read the slabs before it asynchronously, and to drop the pages of the
+/// slabs copied back from the address space of the process.
+/// Only trivially copyable types are spilled, the tapes of other types keep
+/// all their slabs in memory. So do the tapes for which the file cannot be
+/// created.
+template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
+          bool is_multithread = false>
+class spilling_tape_impl {
+  struct Slab {
+    alignas(T) char raw_data[SLAB_SIZE * sizeof(T)];
+    T* elements() {
+#if __cplusplus >= 201703L
+      return std::launder(reinterpret_cast<T*>(raw_data));
+#else
+      return reinterpret_cast<T*>(raw_data);
+#endif
+    }
+  };
+
+  constexpr static std::size_t kSlabBytes = SLAB_SIZE * sizeof(T);
+  /// The number of slabs in each mapping of the file.
+  constexpr static std::size_t kChunkSlabs =
+      kSlabBytes < (std::size_t(8) << 20) ? (std::size_t(8) << 20) / kSlabBytes
+                                          : 1;
+  /// The number of spilled slabs read ahead of the reverse pass at once.
+  constexpr static std::size_t kPrefetchSlabs = 16;
+  constexpr static bool kSpillable =
+      std::is_trivially_copyable<typename std::remove_cv<T>::type>::value;
+
+  alignas(T) char m_static_buffer[SBO_SIZE * sizeof(T)];
+  /// The slabs in chain order. The first m_num_spilled slabs are spilled and
+  /// null, the ones after them are in memory.
+  std::vector<Slab*> m_slabs;
+  /// Emptied slabs kept to avoid an allocation per slab when the tape
+  /// oscillates around a slab boundary.
+  std::vector<Slab*> m_free;
+  std::size_t m_size = 0;
+  std::size_t m_num_spilled = 0;
+  /// The maximal number of slabs in memory.
+  std::size_t m_max_resident;
+  /// The mappings of consecutive parts of the file, kChunkSlabs slabs each.
+  std::vector<char*> m_chunks;
+  std::size_t m_chunk_bytes = 0;
+  int m_fd = -1;
+  bool m_spill_failed = false;
+  mutable std::mutex m_TapeMutex;
+
+  T* sbo_elements() {
+#if __cplusplus >= 201703L
+    return std::launder(reinterpret_cast<T*>(m_static_buffer));
+#else
+    return reinterpret_cast<T*>(m_static_buffer);
+#endif
+  }
+
+public:
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using value_type = T;
+
+  std::mutex& mutex() const { return m_TapeMutex; }
+
+  /// Creates a tape which keeps at most \p memory_limit bytes of slabs, and at
+  /// least two slabs, in memory.
+  spilling_tape_impl(std::size_t memory_limit = tape_spill_limit())
+      : m_max_resident(memory_limit / kSlabBytes > 2 ? memory_limit / kSlabBytes
+                                                     : 2) {}
+#ifdef CLAD_TAPE_INSTRUMENTATION
+  /// The tapes of the derivative functions are named when
+  /// CLAD_TAPE_INSTRUMENTATION is defined, but only `clad::tape_impl` records
+  /// their statistics.
+  spilling_tape_impl(const char* /*function*/, const char* /*name*/)
+      : spilling_tape_impl() {}
+#endif
+  spilling_tape_impl(const spilling_tape_impl&) = delete;
+  spilling_tape_impl& operator=(const spilling_tape_impl&) = delete;
+
+  ~spilling_tape_impl() { clear(); }
+
+  /// Add new value of type T constructed from args to the end of the tape.
+  template <typename... ArgsT> void emplace_back(ArgsT&&... args) {
+    T* elem;
+    if (m_size < SBO_SIZE) {
+      elem = sbo_elements() + m_size;
+    } else {
+      std::size_t index = m_size - SBO_SIZE;
+      if (index % SLAB_SIZE == 0)
+        add_slab();
+      elem = m_slabs.back()->elements() + index % SLAB_SIZE;
+    }
+    ::new (const_cast<void*>(static_cast<const volatile void*>(elem)))
+        T(std::forward<ArgsT>(args)...);
+    m_size++;
+  }
+
+  std::size_t size() const { return m_size; }
+
+  /// \returns the number of slabs currently stored in the file.
+  std::size_t num_spilled_slabs() const { return m_num_spilled; }
+
+  /// Access last value (must not be empty). The last slab is always in memory.
+  reference back() {
+    assert(m_size);
+    std::size_t index = m_size - 1;
+    if (index < SBO_SIZE)
+      return sbo_elements()[index];
+    return m_slabs.back()->elements()[(index - SBO_SIZE) % SLAB_SIZE];
+  }
+
+  /// Access the value at \p i, reading it from the file if its slab was
+  /// spilled.
+  reference operator[](std::size_t i) {
+    assert(i < m_size);
+    if (i < SBO_SIZE)
+      return sbo_elements()[i];
+    i -= SBO_SIZE;
+    std::size_t slab = i / SLAB_SIZE;
+    T* elements = m_slabs[slab] ? m_slabs[slab]->elements()
+                                : reinterpret_cast<T*>(spilled_data(slab));
+    return elements[i % SLAB_SIZE];
+  }
+
+  /// Remove the last value from the tape.
+  void pop_back() {
+    assert(m_size);
+    m_size--;
+    if (m_size < SBO_SIZE) {
+      destroy_element(sbo_elements() + m_size);
+      return;
+    }
+    std::size_t index = m_size - SBO_SIZE;
+    destroy_element(m_slabs.back()->elements() + index % SLAB_SIZE);
+    if (index % SLAB_SIZE)
+      return;
+    // The last slab is empty, make the one before it the last one.
+    release_slab(m_slabs.back());
+    m_slabs.pop_back();
+    if (!m_slabs.empty() && m_slabs.size() == m_num_spilled)
+      reload_slab();
+  }
+
+private:
+  /// Appends a slab to the chain, spilling the oldest slab in memory to reuse
+  /// its storage if the limit is reached.
+  void add_slab() {
+    Slab* slab = nullptr;
+    if (m_slabs.size() - m_num_spilled >= m_max_resident)
+      slab = spill_slab();
+    if (!slab && !m_free.empty()) {
+      slab = m_free.back();
+      m_free.pop_back();
+    }
+    if (!slab)
+      slab = new Slab();
+    m_slabs.push_back(slab);
+  }
+
+  /// Copies the oldest slab in memory to the file. \returns its storage, or
+  /// null if it could not be spilled.
+  Slab* spill_slab() {
+    if (!kSpillable || m_spill_failed)
+      return nullptr;
+    char* data = spilled_data(m_num_spilled);
+    if (!data)
+      return nullptr;
+    Slab* slab = m_slabs[m_num_spilled];
+    std::memcpy(data, slab->raw_data, kSlabBytes);
+    m_slabs[m_num_spilled++] = nullptr;
+    return slab;
+  }
+
+  /// Copies the last spilled slab back to memory and prefetches the slabs
+  /// spilled before it.
+  void reload_slab() {
+    Slab* slab;
+    if (!m_free.empty()) {
+      slab = m_free.back();
+      m_free.pop_back();
+    } else {
+      slab = new Slab();
+    }
+    std::size_t index = --m_num_spilled;
+    std::memcpy(slab->raw_data, spilled_data(index), kSlabBytes);
+    m_slabs[index] = slab;
+    // Keep at least kPrefetchSlabs slabs read ahead, and release the pages of
+    // the slabs copied back since the previous batch.
+    if (index % kPrefetchSlabs == 0) {
+#ifdef CLAD_HAS_TAPE_SPILL_FILE
+      advise(index > 2 * kPrefetchSlabs ? index - 2 * kPrefetchSlabs : 0,
+             index, MADV_WILLNEED);
+      advise(index, index + kPrefetchSlabs, MADV_DONTNEED);
+#endif
+    }
+  }
+
+#ifdef CLAD_HAS_TAPE_SPILL_FILE
+  /// Gives the kernel the \p advice for the pages of the spilled slabs
+  /// [first, last): MADV_WILLNEED reads them in the background, MADV_DONTNEED
+  /// drops them from the address space, the file keeps their content.
+  void advise(std::size_t first, std::size_t last, int advice) {
+    std::size_t page = sysconf(_SC_PAGESIZE);
+    if (last > m_chunks.size() * kChunkSlabs)
+      last = m_chunks.size() * kChunkSlabs;
+    while (first < last) {
+      std::size_t chunkBegin = first - first % kChunkSlabs;
+      std::size_t chunkEnd = chunkBegin + kChunkSlabs;
+      std::size_t end = last < chunkEnd ? last : chunkEnd;
+      std::size_t beginByte = (first - chunkBegin) * kSlabBytes / page * page;
+      std::size_t endByte = (end - chunkBegin) * kSlabBytes;
+      madvise(m_chunks[first / kChunkSlabs] + beginByte, endByte - beginByte,
+              advice);
+      first = end;
+    }
+  }
+#endif
+
+  /// \returns the location of the slab \p index in the file, growing and
+  /// mapping the file if needed, or null if the file cannot be used.
+  char* spilled_data(std::size_t index) {
+    std::size_t chunk = index / kChunkSlabs;
+    if (chunk >= m_chunks.size() && !map_chunks(chunk + 1))
+      return nullptr;
+    return m_chunks[chunk] + (index % kChunkSlabs) * kSlabBytes;
+  }
+
+  /// Grows the file to hold \p count chunks and maps the new ones.
+  bool map_chunks(std::size_t count) {
+#ifdef CLAD_HAS_TAPE_SPILL_FILE
+    if (m_fd < 0) {
+      const char* dir = std::getenv("TMPDIR");
+      std::string path = std::string(dir && *dir ? dir : "/tmp") +
+                         "/clad-tape-XXXXXX";
+      m_fd = mkstemp(&path[0]);
+      if (m_fd < 0) {
+        m_spill_failed = true;
+        return false;
+      }
+      // The file is removed once the tape closes it.
+      unlink(path.c_str());
+      std::size_t page = sysconf(_SC_PAGESIZE);
+      m_chunk_bytes = (kChunkSlabs * kSlabBytes + page - 1) / page * page;
+    }
+    if (ftruncate(m_fd, static_cast<off_t>(count * m_chunk_bytes))) {
+      m_spill_failed = true;
+      return false;
+    }
+    while (m_chunks.size() < count) {
+      void* chunk = mmap(nullptr, m_chunk_bytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, m_fd,
+                         static_cast<off_t>(m_chunks.size() * m_chunk_bytes));
+      if (chunk == MAP_FAILED) {
+        m_spill_failed = true;
+        return false;
+      }
+      m_chunks.push_back(static_cast<char*>(chunk));
+    }
+    return true;
+#else
+    m_spill_failed = true;
+    return false;
+#endif
+  }
+
+  void release_slab(Slab* slab) {
+    if (m_free.size() < 2)
+      m_free.push_back(slab);
+    else
+      delete slab;
+  }
+
+  /// Destroys all elements, deallocates the slabs and removes the file.
+  void clear() {
+    // The spillable elements are trivially destructible and the other ones
+    // are never spilled.
+    if (!kSpillable)
+      while (m_size)
+        pop_back();
+    for (Slab* slab : m_slabs)
+      delete slab;
+    for (Slab* slab : m_free)
+      delete slab;
+    m_slabs.clear();
+    m_free.clear();
+    m_size = 0;
+    m_num_spilled = 0;
+#ifdef CLAD_HAS_TAPE_SPILL_FILE
+    for (char* chunk : m_chunks)
+      munmap(chunk, m_chunk_bytes);
+    if (m_fd >= 0)
+      close(m_fd);
+#endif
+    m_chunks.clear();
+    m_fd = -1;
+  }
+
+  template <typename ElTy> void destroy_element(ElTy* elem) { elem->~ElTy(); }
+
+  template <typename ElTy, std::size_t N>
+  void destroy_element(ElTy (*arr)[N]) {
+    for (std::size_t i = 0; i < N; ++i)
+      (*arr)[i].~ElTy();
+  }
+};
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_SPILLINGTAPE_H
@@ -0,0 +1,198 @@
+#ifndef CLAD_STATIC_ARRAY_H
+#define CLAD_STATIC_ARRAY_H
+
+#include "clad/Differentiator/Array.h"
+#include "clad/Differentiator/ArrayExpression.h"
+#include "clad/Differentiator/ArrayExpressionSIMD.h"
+#include "clad/Differentiator/ArrayRef.h"
+#include "clad/Differentiator/CladConfig.h"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace clad {
+namespace detail {
+/// Returns the alignment used for the storage of bytes bytes, the largest
+/// power of two not larger than bytes and 64, but at least align.
+constexpr std::size_t static_array_alignment(std::size_t bytes,
+                                             std::size_t align) {
+  return (align * 2 <= bytes && align * 2 <= 64)
+             ? static_array_alignment(bytes, align * 2)
+             : align;
+}
+} // namespace detail
+
+/// A fixed-size array of N elements stored inline, used by clad as the
+/// direction vector type of vector forward mode when the number of
+/// independent variables is known at compile time. It takes part in the
+/// clad::array expression templates, and converts to clad::array so that it
+/// can be passed to vector mode pushforwards.
+///
+/// This class is not meant to be used by user. It is used by clad internally
+/// only.
+
+// NOLINTBEGIN(*-pointer-arithmetic)
+// NOLINTBEGIN(cppcoreguidelines-avoid-c-arrays)
+template <typename T, std::size_t N> class static_array {
+  static constexpr std::size_t ALIGNMENT =
+      detail::static_array_alignment(N * sizeof(T), alignof(T));
+
+  /// The elements of the array.
+  alignas(ALIGNMENT) T m_arr[N ? N : 1];
+
+public:
+  /// Creates an array with all elements set to zero.
+  CUDA_HOST_DEVICE static_array() : m_arr{} {}
+
+  /// Creates an array with all elements set to val.
+  template <typename U, typename std::enable_if<std::is_arithmetic<U>::value,
+                                                int>::type = 0>
+  CUDA_HOST_DEVICE explicit static_array(U val) {
+    for (std::size_t i = 0; i < N; ++i)
+      m_arr[i] = static_cast<T>(val);
+  }
+
+  template <typename U>
+  CUDA_HOST_DEVICE static_array(const array<U>& arr) {
+    (*this) = arr;
+  }
+
+  template <typename U>
+  CUDA_HOST_DEVICE static_array(const array_ref<U>& arr) {
+    (*this) = arr;
+  }
+
+  template <typename L, typename BinaryOp, typename R>
+  CUDA_HOST_DEVICE
+  static_array(const array_expression<L, BinaryOp, R>& expression) {
+    (*this) = expression;
+  }
+
+  /// Returns the size of the array
+  CUDA_HOST_DEVICE static constexpr std::size_t size() { return N; }
+  /// Iterator functions
+  CUDA_HOST_DEVICE T* begin() { return m_arr; }
+  CUDA_HOST_DEVICE const T* begin() const { return m_arr; }
+  CUDA_HOST_DEVICE T* end() { return m_arr + N; }
+  CUDA_HOST_DEVICE const T* end() const { return m_arr + N; }
+  /// Returns the ptr of the underlying array
+  CUDA_HOST_DEVICE PUREFUNC T* ptr() { return m_arr; }
+  CUDA_HOST_DEVICE PUREFUNC const T* ptr() const { return m_arr; }
+  /// Returns the reference to the location at the index of the underlying
+  /// array
+  CUDA_HOST_DEVICE PUREFUNC T& operator[](std::ptrdiff_t i) { return m_arr[i]; }
+  CUDA_HOST_DEVICE PUREFUNC const T& operator[](std::ptrdiff_t i) const {
+    return m_arr[i];
+  }
+
+  /// Initializes the array from the given clad::array
+  template <typename U>
+  CUDA_HOST_DEVICE static_array& operator=(const array<U>& arr) {
+    assert(arr.size() == N);
+    for (std::size_t i = 0; i < N; ++i)
+      m_arr[i] = static_cast<T>(arr[i]);
+    return *this;
+  }
+  /// Initializes the array from the given clad::array_ref
+  template <typename U>
+  CUDA_HOST_DEVICE static_array& operator=(const array_ref<U>& arr) {
+    assert(arr.size() == N);
+    for (std::size_t i = 0; i < N; ++i)
+      m_arr[i] = static_cast<T>(arr[i]);
+    return *this;
+  }
+  /// Initializes the array from the given clad::array_expression
+  template <typename L, typename BinaryOp, typename R>
+  CUDA_HOST_DEVICE static_array&
+  operator=(const array_expression<L, BinaryOp, R>& arr_exp) {
+    assert(arr_exp.size() == N);
+    simd::evaluate<simd::AssignOp>(m_arr, arr_exp, N);
+    return *this;
+  }
+
+#define CLAD_STATIC_ARRAY_COMPOUND_OP(OP, BINARY_OP)                           \
+  template <typename U, typename std::enable_if<std::is_arithmetic<U>::value,  \
+                                                int>::type = 0>                \
+  CUDA_HOST_DEVICE static_array& operator OP(U n) {                            \
+    for (std::size_t i = 0; i < N; ++i)                                        \
+      m_arr[i] OP n;                                                           \
+    return *this;                                                              \
+  }                                                                            \
+  CUDA_HOST_DEVICE static_array& operator OP(const static_array & arr) {       \
+    for (std::size_t i = 0; i < N; ++i)                                        \
+      m_arr[i] OP arr[i];                                                      \
+    return *this;                                                              \
+  }                                                                            \
+  template <typename U>                                                        \
+  CUDA_HOST_DEVICE static_array& operator OP(const array<U>& arr) {            \
+    assert(arr.size() == N);                                                   \
+    for (std::size_t i = 0; i < N; ++i)                                        \
+      m_arr[i] OP static_cast<T>(arr[i]);                                      \
+    return *this;                                                              \
+  }                                                                            \
+  template <typename L, typename BinaryOp, typename R>                         \
+  CUDA_HOST_DEVICE static_array& operator OP(                                  \
+      const array_expression<L, BinaryOp, R>& arr_exp) {                       \
+    assert(arr_exp.size() == N);                                               \
+    simd::evaluate<BINARY_OP>(m_arr, arr_exp, N);                              \
+    return *this;                                                              \
+  }
+  /// Element wise compound assignments with scalars, arrays and expressions.
+  CLAD_STATIC_ARRAY_COMPOUND_OP(+=, BinaryAdd)
+  CLAD_STATIC_ARRAY_COMPOUND_OP(-=, BinarySub)
+  CLAD_STATIC_ARRAY_COMPOUND_OP(*=, BinaryMul)
+  CLAD_STATIC_ARRAY_COMPOUND_OP(/=, BinaryDiv)
+#undef CLAD_STATIC_ARRAY_COMPOUND_OP
+
+  /// Negate the array and return a new array.
+  CUDA_HOST_DEVICE array_expression<T, BinarySub, const static_array&>
+  operator-() const {
+    return array_expression<T, BinarySub, const static_array&>(
+        static_cast<T>(0), *this);
+  }
+
+  /// Converts to a clad::array, e.g. to pass the directions to a vector mode
+  /// pushforward.
+  CUDA_HOST_DEVICE operator array<T>() const { return array<T>(m_arr, N); }
+
+  /// Implicitly converts to a pointer to the first element, like clad::array.
+  CUDA_HOST_DEVICE operator const T*() const { return m_arr; }
+}; // class static_array
+// NOLINTEND(cppcoreguidelines-avoid-c-arrays)
+
+template <typename T, std::size_t N>
+struct is_clad_type<static_array<T, N>> : std::true_type {};
+
+#ifdef CLAD_ARRAY_SIMD
+namespace simd {
+template <typename T, std::size_t N>
+struct is_packet_evaluable<static_array<T, N>, T, /*IsScalar=*/false>
+    : std::true_type {};
+
+template <typename P, typename T, std::size_t N>
+struct packet_evaluator<P, T, static_array<T, N>, /*IsScalar=*/false> {
+  const T* m_data;
+  explicit packet_evaluator(const static_array<T, N>& a) : m_data(a.ptr()) {}
+  P packet(std::size_t i) const { return P::load(m_data + i); }
+};
+} // namespace simd
+#endif // CLAD_ARRAY_SIMD
+// NOLINTEND(*-pointer-arithmetic)
+
+// Function to instantiate a one-hot array of size N with 1 at index i.
+template <typename T, std::size_t N>
+CUDA_HOST_DEVICE static_array<T, N> static_one_hot_vector(std::size_t i) {
+  static_array<T, N> arr;
+  arr[i] = 1;
+  return arr;
+}
+
+// Function to instantiate a zero vector of size N
+template <typename T, std::size_t N>
+CUDA_HOST_DEVICE static_array<T, N> static_zero_vector() {
+  return static_array<T, N>();
+}
+} // namespace clad
+
+#endif // CLAD_STATIC_ARRAY_H
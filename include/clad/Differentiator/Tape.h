@@ -11,9 +11,23 @@
 #include <type_traits>
 #include <utility>
 #ifndef __CUDACC__
+#include <atomic>
 #include <mutex>
 #endif
 
+/// Define CLAD_TAPE_INSTRUMENTATION to record the memory statistics of the
+/// tapes of the derivative functions, see clad/Differentiator/TapeStats.h.
+#if defined(CLAD_TAPE_INSTRUMENTATION) && !defined(__CUDACC__)
+#include "clad/Differentiator/TapeStats.h"
+#define CLAD_TAPE_INSTRUMENTED 1
+#endif
+
+#ifndef CLAD_TAPE_SLAB_POOL_SIZE
+/// The maximum number of free slabs each thread keeps for reuse by later tapes
+/// of the same type. Set to 0 to always return slabs to the system allocator.
+#define CLAD_TAPE_SLAB_POOL_SIZE 64
+#endif
+
 namespace clad {
 
 template <typename T, std::size_t SBO_SIZE, std::size_t SLAB_SIZE,
@@ -70,7 +84,8 @@ public:
 /// A dynamic slab-based vector-like container with Small Buffer Optimization
 /// (SBO), primarily used for storing values in reverse-mode AD. Stores elements
 /// in a static buffer first, then falls back to dynamically allocated linked
-/// slabs if capacity exceeds SBO.
+/// slabs if capacity exceeds SBO. A directory of slab pointers is kept next to
+/// the linked list so that random access is constant time.
 template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024,
           bool is_multithread = false>
 class tape_impl {
@@ -100,12 +115,21 @@ class tape_impl {
 
   Slab* m_head = nullptr;
   Slab* m_tail = nullptr;
+  /// Directory of all allocated slabs, in chain order. `m_slabs[i]` holds the
+  /// elements with indices in [SBO_SIZE + i * SLAB_SIZE, SBO_SIZE + (i + 1) *
+  /// SLAB_SIZE).
+  Slab** m_slabs = nullptr;
+  std::size_t m_num_slabs = 0;
+  std::size_t m_slabs_capacity = 0;
   std::size_t m_size = 0;
   std::size_t m_capacity = SBO_SIZE;
 
 #ifndef __CUDACC__
   mutable std::mutex m_TapeMutex;
 #endif
+#ifdef CLAD_TAPE_INSTRUMENTED
+  tape_stats m_stats;
+#endif
 
   CUDA_HOST_DEVICE T* sbo_elements() {
 #if __cplusplus >= 201703L
@@ -141,7 +165,26 @@ public:
 
   CUDA_HOST_DEVICE tape_impl() = default;
 
+#ifdef CLAD_TAPE_INSTRUMENTED
+  /// Creates a tape whose statistics are recorded under the given names when
+  /// it is destroyed. Used by the derivative functions.
+  tape_impl(const char* function, const char* name) {
+    m_stats.function = function;
+    m_stats.name = name;
+  }
+
+  ~tape_impl() {
+    if (*m_stats.name) {
+      m_stats.element_size = sizeof(T);
+      m_stats.tapes = 1;
+      m_stats.peak_bytes = m_capacity * sizeof(T);
+      tape_stats_registry::record(m_stats);
+    }
+    clear();
+  }
+#else
   CUDA_HOST_DEVICE ~tape_impl() { clear(); }
+#endif
 
   /// Add new value of type T constructed from args to the end of the tape.
   template <typename... ArgsT>
@@ -155,14 +198,18 @@ public:
       // Allocate new slab if required
       if (!offset) {
         if (m_size == m_capacity) {
-          Slab* new_slab = new Slab();
+          Slab* new_slab = allocate_slab();
           if (!m_head)
             m_head = new_slab;
           else {
             m_tail->next = new_slab;
             new_slab->prev = m_tail;
           }
+          add_to_directory(new_slab);
           m_capacity += SLAB_SIZE;
+#ifdef CLAD_TAPE_INSTRUMENTED
+          ++m_stats.slab_allocations;
+#endif
         }
         if (m_size == SBO_SIZE)
           m_tail = m_head;
@@ -175,6 +222,11 @@ public:
           m_tail->elements() + offset))) T(std::forward<ArgsT>(args)...);
     }
     m_size++;
+#ifdef CLAD_TAPE_INSTRUMENTED
+    ++m_stats.pushes;
+    if (m_size > m_stats.peak_size)
+      m_stats.peak_size = m_size;
+#endif
   }
 
   CUDA_HOST_DEVICE std::size_t size() const { return m_size; }
@@ -224,6 +276,9 @@ public:
   CUDA_HOST_DEVICE void pop_back() {
     assert(m_size);
     m_size--;
+#ifdef CLAD_TAPE_INSTRUMENTED
+    ++m_stats.pops;
+#endif
     if (m_size < SBO_SIZE)
       destroy_element(sbo_elements() + m_size);
     else {
@@ -241,21 +296,126 @@ private:
   CUDA_HOST_DEVICE T* at(std::size_t index) {
     if (index < SBO_SIZE)
       return sbo_elements() + index;
-    Slab* slab = m_head;
-    std::size_t idx = (index - SBO_SIZE) / SLAB_SIZE;
-    while (idx--)
-      slab = slab->next;
-    return slab->elements() + ((index - SBO_SIZE) % SLAB_SIZE);
+    index -= SBO_SIZE;
+    return m_slabs[index / SLAB_SIZE]->elements() + (index % SLAB_SIZE);
   }
 
   CUDA_HOST_DEVICE const T* at(std::size_t index) const {
     if (index < SBO_SIZE)
       return sbo_elements() + index;
-    Slab* slab = m_head;
-    std::size_t idx = (index - SBO_SIZE) / SLAB_SIZE;
-    while (idx--)
-      slab = slab->next;
-    return slab->elements() + ((index - SBO_SIZE) % SLAB_SIZE);
+    index -= SBO_SIZE;
+    return m_slabs[index / SLAB_SIZE]->elements() + (index % SLAB_SIZE);
+  }
+
+#ifndef __CUDACC__
+  /// A per-thread list of free slabs. Tapes are usually short-lived locals of
+  /// derivative functions which are called many times, so keeping the slabs
+  /// of destroyed tapes avoids an allocation per slab in the next call.
+  /// The pool is trivially destructible so that it stays usable for tapes
+  /// which are destroyed after the thread-local cleanup has run.
+  struct SlabPool {
+    Slab* m_free;
+    std::size_t m_size;
+    /// The largest released slab directory, handed to the next tape.
+    Slab** m_directory;
+    std::size_t m_directory_capacity;
+    bool m_disabled;
+  };
+
+  /// Deallocates the pooled slabs at thread exit.
+  struct SlabPoolCleanup {
+    SlabPool& m_pool;
+    explicit SlabPoolCleanup(SlabPool& pool) : m_pool(pool) {}
+    ~SlabPoolCleanup() {
+      while (m_pool.m_free) {
+        Slab* next = m_pool.m_free->next;
+        delete m_pool.m_free;
+        m_pool.m_free = next;
+      }
+      m_pool.m_size = 0;
+      delete[] m_pool.m_directory;
+      m_pool.m_directory = nullptr;
+      m_pool.m_directory_capacity = 0;
+      m_pool.m_disabled = true;
+    }
+  };
+
+  static SlabPool& slab_pool() {
+    thread_local SlabPool pool = {nullptr, 0, nullptr, 0, false};
+    thread_local SlabPoolCleanup cleanup(pool);
+    (void)cleanup;
+    return pool;
+  }
+#endif
+
+  /// Returns a slab from the thread's slab pool, or a new one if it is empty.
+  CUDA_HOST_DEVICE Slab* allocate_slab() {
+#ifndef __CUDACC__
+    SlabPool& pool = slab_pool();
+    if (Slab* slab = pool.m_free) {
+      pool.m_free = slab->next;
+      --pool.m_size;
+      slab->prev = nullptr;
+      slab->next = nullptr;
+      return slab;
+    }
+#endif
+    return new Slab();
+  }
+
+  /// Returns an empty slab to the thread's slab pool, or deallocates it if the
+  /// pool is full.
+  CUDA_HOST_DEVICE void release_slab(Slab* slab) {
+#ifndef __CUDACC__
+    SlabPool& pool = slab_pool();
+    if (!pool.m_disabled && pool.m_size < CLAD_TAPE_SLAB_POOL_SIZE) {
+      slab->next = pool.m_free;
+      pool.m_free = slab;
+      ++pool.m_size;
+      return;
+    }
+#endif
+    delete slab;
+  }
+
+  /// Releases the slab directory, keeping it in the thread's slab pool if it
+  /// is larger than the one already pooled.
+  CUDA_HOST_DEVICE void release_directory() {
+    if (!m_slabs)
+      return;
+#ifndef __CUDACC__
+    SlabPool& pool = slab_pool();
+    if (!pool.m_disabled && CLAD_TAPE_SLAB_POOL_SIZE &&
+        m_slabs_capacity > pool.m_directory_capacity) {
+      std::swap(pool.m_directory, m_slabs);
+      std::swap(pool.m_directory_capacity, m_slabs_capacity);
+    }
+#endif
+    delete[] m_slabs;
+    m_slabs = nullptr;
+    m_slabs_capacity = 0;
+  }
+
+  /// Appends a newly allocated slab to the slab directory, doubling the
+  /// directory storage when it is full.
+  CUDA_HOST_DEVICE void add_to_directory(Slab* slab) {
+#ifndef __CUDACC__
+    if (!m_slabs_capacity) {
+      SlabPool& pool = slab_pool();
+      std::swap(pool.m_directory, m_slabs);
+      std::swap(pool.m_directory_capacity, m_slabs_capacity);
+    }
+#endif
+    if (m_num_slabs == m_slabs_capacity) {
+      std::size_t new_capacity = m_slabs_capacity ? 2 * m_slabs_capacity : 8;
+      Slab** new_slabs = new Slab*[new_capacity];
+      for (std::size_t i = 0; i < m_num_slabs; ++i)
+        new_slabs[i] = m_slabs[i];
+      delete[] m_slabs;
+      m_slabs = new_slabs;
+      m_slabs_capacity = new_capacity;
+    }
+    m_slabs[m_num_slabs++] = slab;
   }
 
   template <typename It> using value_type_of = decltype(*std::declval<It>());
@@ -291,9 +451,12 @@ private:
         destroy_element(elems + i);
       Slab* tmp = slab;
       slab = slab->next;
-      delete tmp;
+      release_slab(tmp);
     }
 
+    release_directory();
+    m_num_slabs = 0;
+
     m_head = nullptr;
     m_tail = nullptr;
     m_size = 0;
@@ -307,6 +470,124 @@ private:
       (*arr)[i].~ElTy();
   }
 };
+
+#ifndef __CUDACC__
+/// A tape for multithreaded code which keeps a separate `clad::tape_impl`
+/// (shard) per thread. Pushes and pops of a thread only touch that thread's
+/// shard and therefore do not need any locking; values are popped in LIFO
+/// order with respect to the pushes of the same thread. A shard is created
+/// the first time a thread accesses the tape and registered in a lock-free
+/// list. The shards are owned by a per-thread token instead of the
+/// `std::thread::id`, which may be reused by a thread started after another
+/// one exited.
+template <typename T, std::size_t SBO_SIZE = 64, std::size_t SLAB_SIZE = 1024>
+class sharded_tape_impl {
+public:
+  using shard_type =
+      tape_impl<T, SBO_SIZE, SLAB_SIZE, /*is_multithread=*/false>;
+  using reference = typename shard_type::reference;
+  using const_reference = typename shard_type::const_reference;
+  using size_type = std::size_t;
+  using value_type = T;
+
+private:
+  struct Shard {
+    shard_type m_tape;
+    std::size_t m_owner;
+    Shard* m_next = nullptr;
+  };
+
+  /// Caches the shard of the current thread for the tape with the given id.
+  struct ShardCache {
+    std::size_t m_id;
+    Shard* m_shard;
+  };
+
+  /// The number of tapes whose shard is cached per thread. The cache is
+  /// indexed by the tape id, and the tapes of a derivative are created one
+  /// after the other, so alternating between them does not evict the entries.
+  static constexpr std::size_t shard_cache_size = 16;
+
+  std::atomic<Shard*> m_shards{nullptr};
+  /// Unique id of the tape. Used instead of `this` to validate the per-thread
+  /// shard cache, since a tape may be reallocated at the same address.
+  const std::size_t m_id = next_id();
+
+  static std::size_t next_id() {
+    static std::atomic<std::size_t> id{0};
+    return ++id;
+  }
+
+  /// \returns the token of the calling thread. Unlike the thread ids, the
+  /// tokens are never reused.
+  static std::size_t thread_token() {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t token = ++next;
+    return token;
+  }
+
+  Shard* get_shard() {
+    thread_local ShardCache cache[shard_cache_size] = {};
+    ShardCache& entry = cache[m_id % shard_cache_size];
+    if (entry.m_id == m_id)
+      return entry.m_shard;
+    std::size_t token = thread_token();
+    Shard* shard = m_shards.load(std::memory_order_acquire);
+    while (shard && shard->m_owner != token)
+      shard = shard->m_next;
+    if (!shard) {
+      shard = new Shard();
+      shard->m_owner = token;
+      shard->m_next = m_shards.load(std::memory_order_relaxed);
+      while (!m_shards.compare_exchange_weak(shard->m_next, shard,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+        ;
+    }
+    entry = {m_id, shard};
+    return shard;
+  }
+
+public:
+  sharded_tape_impl() = default;
+  sharded_tape_impl(const sharded_tape_impl&) = delete;
+  sharded_tape_impl& operator=(const sharded_tape_impl&) = delete;
+
+  ~sharded_tape_impl() {
+    Shard* shard = m_shards.load(std::memory_order_acquire);
+    while (shard) {
+      Shard* next = shard->m_next;
+      delete shard;
+      shard = next;
+    }
+  }
+
+  /// \returns the shard of the calling thread.
+  shard_type& local() { return get_shard()->m_tape; }
+
+  /// Add new value of type T constructed from args to the end of the calling
+  /// thread's shard.
+  template <typename... ArgsT> void emplace_back(ArgsT&&... args) {
+    local().emplace_back(std::forward<ArgsT>(args)...);
+  }
+
+  /// Access the last value pushed by the calling thread.
+  reference back() { return local().back(); }
+
+  /// Remove the last value pushed by the calling thread.
+  void pop_back() { local().pop_back(); }
+
+  /// \returns the total number of elements in all shards. The result is only
+  /// exact when no other thread modifies the tape concurrently.
+  std::size_t size() const {
+    std::size_t total = 0;
+    for (Shard* shard = m_shards.load(std::memory_order_acquire); shard;
+         shard = shard->m_next)
+      total += shard->m_tape.size();
+    return total;
+  }
+};
+#endif // __CUDACC__
 } // namespace clad
 
 #endif // CLAD_TAPE_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef CLAD_DIFFERENTIATOR_TAPESTATS_H
+#define CLAD_DIFFERENTIATOR_TAPESTATS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace clad {
+
+/// The memory statistics of a tape of a derivative function, collected when
+/// CLAD_TAPE_INSTRUMENTATION is defined. The statistics of the tapes created
+/// by different calls of the function are accumulated in one record.
+struct tape_stats {
+  /// The name of the derivative function, e.g. `f_grad`.
+  const char* function = "";
+  /// The name of the tape variable, e.g. `_t0`.
+  const char* name = "";
+  std::size_t element_size = 0;
+  /// The number of tapes, i.e. of calls of the derivative function.
+  std::size_t tapes = 0;
+  std::size_t pushes = 0;
+  std::size_t pops = 0;
+  /// The maximal number of elements stored at once in a tape.
+  std::size_t peak_size = 0;
+  /// The maximal number of bytes allocated for the elements of a tape.
+  std::size_t peak_bytes = 0;
+  /// The number of slabs the tapes took from the slab pool or the allocator.
+  std::size_t slab_allocations = 0;
+};
+
+/// Collects the statistics of the destroyed tapes.
+class tape_stats_registry {
+  std::mutex m_Mutex;
+  std::vector<tape_stats> m_Stats;
+
+  static tape_stats_registry& get() {
+    // Never destroyed, so that the tapes destroyed at exit can be recorded.
+    static auto* registry = new tape_stats_registry();
+    return *registry;
+  }
+
+public:
+  /// Adds the statistics of a destroyed tape to the record of its function
+  /// and name.
+  static void record(const tape_stats& stats) {
+    tape_stats_registry& registry = get();
+    std::lock_guard<std::mutex> lock(registry.m_Mutex);
+    auto it = std::find_if(registry.m_Stats.begin(), registry.m_Stats.end(),
+                           [&stats](const tape_stats& other) {
+                             return !std::strcmp(stats.function,
+                                                 other.function) &&
+                                    !std::strcmp(stats.name, other.name);
+                           });
+    if (it == registry.m_Stats.end()) {
+      registry.m_Stats.push_back(stats);
+      return;
+    }
+    it->element_size = stats.element_size;
+    it->tapes += stats.tapes;
+    it->pushes += stats.pushes;
+    it->pops += stats.pops;
+    it->peak_size = std::max(it->peak_size, stats.peak_size);
+    it->peak_bytes = std::max(it->peak_bytes, stats.peak_bytes);
+    it->slab_allocations += stats.slab_allocations;
+  }
+
+  /// \returns the records, the ones with the most memory first.
+  static std::vector<tape_stats> stats() {
+    tape_stats_registry& registry = get();
+    std::vector<tape_stats> res;
+    {
+      std::lock_guard<std::mutex> lock(registry.m_Mutex);
+      res = registry.m_Stats;
+    }
+    std::stable_sort(res.begin(), res.end(),
+                     [](const tape_stats& a, const tape_stats& b) {
+                       return a.peak_bytes > b.peak_bytes;
+                     });
+    return res;
+  }
+
+  static void reset() {
+    tape_stats_registry& registry = get();
+    std::lock_guard<std::mutex> lock(registry.m_Mutex);
+    registry.m_Stats.clear();
+  }
+};
+
+/// \returns the memory statistics of the tapes of the derivative functions
+/// destroyed so far, the ones with the most memory first.
+inline std::vector<tape_stats> tape_report() {
+  return tape_stats_registry::stats();
+}
+
+/// Prints the memory statistics of the tapes destroyed so far to \p out, one
+/// line per tape followed by the peak memory of each function.
+inline void print_tape_report(FILE* out = stderr) {
+  std::vector<tape_stats> stats = tape_report();
+  std::fprintf(out, "%-24s %-6s %6s %8s %10s %10s %10s %12s %8s\n",
+               "function", "tape", "elem", "calls", "pushes", "pops",
+               "peak size", "peak bytes", "slabs");
+  for (const tape_stats& s : stats)
+    std::fprintf(out, "%-24s %-6s %6zu %8zu %10zu %10zu %10zu %12zu %8zu\n",
+                 s.function, s.name, s.element_size, s.tapes, s.pushes, s.pops,
+                 s.peak_size, s.peak_bytes, s.slab_allocations);
+  // The tapes of a call are alive at the same time, thus the sum of their
+  // peaks bounds the tape memory of the call.
+  std::vector<const char*> functions;
+  for (const tape_stats& s : stats) {
+    auto sameFunction = [&s](const char* f) {
+      return !std::strcmp(f, s.function);
+    };
+    if (std::none_of(functions.begin(), functions.end(), sameFunction))
+      functions.push_back(s.function);
+  }
+  for (const char* function : functions) {
+    std::size_t bytes = 0;
+    for (const tape_stats& s : stats)
+      if (!std::strcmp(s.function, function))
+        bytes += s.peak_bytes;
+    std::fprintf(out, "%-24s peak bytes of all tapes: %zu\n", function, bytes);
+  }
+}
+
+/// Forgets the statistics of the tapes destroyed so far.
+inline void reset_tape_report() { tape_stats_registry::reset(); }
+} // namespace clad
+
+#endif // CLAD_DIFFERENTIATOR_TAPESTATS_H
@@ -1,6 +1,8 @@
 #ifndef CLAD_DIFFERENTIATOR_THRUSTDERIVATIVES_H
 #define CLAD_DIFFERENTIATOR_THRUSTDERIVATIVES_H
 
+#include <clad/Differentiator/FunctionTraits.h>
+
 #include <cstddef>
 #include <iterator>
 #include <thrust/adjacent_difference.h>
@@ -24,37 +26,6 @@
 
 namespace clad::custom_derivatives::thrust {
 
-namespace detail {
-// Detection of functor operator_call_pullback for unary and binary ops
-template <typename, typename, typename = void>
-struct has_unary_operator_call_pullback : ::std::false_type {};
-
-template <typename Op, typename T>
-struct has_unary_operator_call_pullback<
-    Op, T,
-    ::std::void_t<decltype(::std::declval<Op&>().operator_call_pullback(
-        ::std::declval<T>(),                   // x
-        ::std::declval<T>(),                   // d_y
-        (::std::add_pointer_t<Op>)(nullptr),   // d_op
-        (::std::add_pointer_t<T>)(nullptr)))>> // d_x
-    : ::std::true_type {};
-
-template <typename, typename, typename = void>
-struct has_binary_operator_call_pullback : ::std::false_type {};
-
-template <typename Op, typename T>
-struct has_binary_operator_call_pullback<
-    Op, T,
-    ::std::void_t<decltype(::std::declval<Op&>().operator_call_pullback(
-        ::std::declval<T>(),                   // x1
-        ::std::declval<T>(),                   // x2
-        ::std::declval<T>(),                   // d_y
-        (::std::add_pointer_t<Op>)(nullptr),   // d_op
-        (::std::add_pointer_t<T>)(nullptr),    // d_x1
-        (::std::add_pointer_t<T>)(nullptr)))>> // d_x2
-    : ::std::true_type {};
-} // namespace detail
-
 template <typename Iterator, typename OutputIterator>
 void copy_pullback(Iterator first, Iterator last, OutputIterator result,
                    OutputIterator d_return, Iterator* d_first, Iterator* d_last,
@@ -681,8 +652,8 @@ void transform_pullback(InputIt first, InputIt last, OutputIt result,
     auto iter = ::thrust::make_zip_iterator(
         ::thrust::make_tuple(d_src_dev_ptr, d_dst_dev_ptr));
     ::thrust::for_each(iter, iter + n, grad_functor());
-  } else if constexpr (detail::has_unary_operator_call_pullback<UnaryOp,
-                                                                Value>::value) {
+  } else if constexpr (::clad::has_unary_operator_call_pullback<
+                           UnaryOp, Value>::value) {
     ::thrust::device_vector<UnaryOp> d_op_storage;
     UnaryOp* d_op_device_ptr = nullptr;
     if (d_op) {
@@ -811,7 +782,7 @@ void transform_pullback(InputIt1 first1, InputIt1 last1, InputIt2 first2,
     auto iter = ::thrust::make_zip_iterator(::thrust::make_tuple(
         d_first1_dev_ptr, d_first2_dev_ptr, d_result_dev_ptr, first1, first2));
     ::thrust::for_each(iter, iter + n, grad_functor());
-  } else if constexpr (detail::has_binary_operator_call_pullback<
+  } else if constexpr (::clad::has_binary_operator_call_pullback<
                            BinaryOp, Value>::value) {
     ::thrust::device_vector<BinaryOp> d_op_storage;
     BinaryOp* d_op_device_ptr = nullptr;
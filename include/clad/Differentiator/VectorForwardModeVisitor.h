@@ -22,6 +22,10 @@ protected:
   /// size of the corresponding clad array they provide at runtime for storing
   /// the derivatives.
   clang::Expr* m_IndVarCountExpr;
+  /// Whether the direction vectors are fixed-size clad::static_array objects
+  /// instead of clad::array objects. This is possible if the number of
+  /// independent variables is known at compile time.
+  bool m_StaticDirections = false;
 
 public:
   VectorForwardModeVisitor(DerivativeBuilder& builder,
@@ -71,6 +75,22 @@ public:
   /// For example: for size = 4, the returned expression is: {0, 0, 0, 0}
   clang::Expr* getZeroInitListExpr(size_t size, clang::QualType type);
 
+  /// Returns the type of the direction vectors of a variable of type T,
+  /// clad::static_array<T, N> if m_StaticDirections is set and clad::array<T>
+  /// otherwise.
+  clang::QualType GetDirectionVectorType(clang::QualType T);
+
+  /// Builds a call creating a direction vector of type T with all elements
+  /// set to 0.
+  clang::Expr* BuildZeroDirectionVector(clang::QualType T,
+                                        clang::SourceLocation loc);
+
+  /// Builds a call creating a direction vector of type T with all elements
+  /// set to 0 except for the element at offset, which is set to 1.
+  clang::Expr* BuildOneHotDirectionVector(clang::QualType T,
+                                          clang::Expr* offset,
+                                          clang::SourceLocation loc);
+
   StmtDiff VisitFloatingLiteral(const clang::FloatingLiteral* FL) override;
   StmtDiff VisitIntegerLiteral(const clang::IntegerLiteral* IL) override;
   StmtDiff
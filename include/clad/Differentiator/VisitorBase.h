@@ -618,6 +618,27 @@ namespace clad {
                                          bool pushOnScopeChains = false,
                                          bool cloneDefaultArg = true,
                                          clang::SourceLocation Loc = noLoc);
+    /// Declares the function \p name of type \p FnTy, with the parameters of
+    /// the differentiated function followed by the parameters \p extraParams,
+    /// whose types are the trailing parameter types of \p FnTy, and starts its
+    /// body. The parameters are stored in \p params. The caller saves and
+    /// restores the current context and scope, and finishes the function with
+    /// EndDerivedFunction.
+    clang::FunctionDecl*
+    BeginDerivedFunction(const std::string& name, clang::DeclContext* DC,
+                         clang::QualType FnTy,
+                         llvm::ArrayRef<llvm::StringRef> extraParams,
+                         llvm::SmallVectorImpl<clang::ParmVarDecl*>& params);
+
+    /// Sets the body of the function started by BeginDerivedFunction.
+    DerivativeAndOverload EndDerivedFunction(clang::FunctionDecl* FD);
+    /// If CLAD_NUM_DIFF_COMPLEX_STEP is defined and \p targetFuncCall refers
+    /// to a specialization of a function template, pairs it with the
+    /// specialization on complex numbers, so that the numerical
+    /// differentiation can use the complex step.
+    ///
+    /// \returns The target to pass to the numerical differentiation.
+    clang::Expr* BuildComplexStepTarget(clang::Expr* targetFuncCall);
     /// A function to get the single argument "forward_central_difference"
     /// call expression for the given arguments.
     ///
@@ -906,29 +906,32 @@ namespace clad {
 
     clang::QualType GetRestoreTrackerType(clang::Sema& S) {
       static QualType T;
-      if (!T.isNull())
-        return T;
+      if (T.isNull())
+        T = GetCladClassType(S, "restore_tracker");
+      return T;
+    }
+
+    clang::QualType GetCladClassType(clang::Sema& S,
+                                     llvm::StringRef ClassName) {
       NamespaceDecl* CladNS = GetCladNamespace(S);
       CXXScopeSpec CSS;
       CSS.Extend(S.getASTContext(), CladNS, noLoc, noLoc);
-      DeclarationName TrackerName =
-          &S.getASTContext().Idents.get("restore_tracker");
-      LookupResult TrackerR(S, TrackerName, noLoc, Sema::LookupUsingDeclName,
-                            CLAD_COMPAT_Sema_ForVisibleRedeclaration);
-      S.LookupQualifiedName(TrackerR, CladNS, CSS);
-      assert(!TrackerR.empty() && "cannot find clad::restore_tracker");
-
-      // This will instantiate restore_tracker<T> type and return it.
-      auto* RD = cast<RecordDecl>(TrackerR.getFoundDecl());
+      DeclarationName Name = &S.getASTContext().Idents.get(ClassName);
+      LookupResult R(S, Name, noLoc, Sema::LookupUsingDeclName,
+                     CLAD_COMPAT_Sema_ForVisibleRedeclaration);
+      S.LookupQualifiedName(R, CladNS, CSS);
+      assert(!R.empty() && "cannot find the class in the clad namespace");
+
+      auto* RD = cast<RecordDecl>(R.getFoundDecl());
       ASTContext& C = S.getASTContext();
-      T = C.getRecordType(RD);
+      QualType T = C.getRecordType(RD);
       // Get clad namespace and its identifier clad::.
       NestedNameSpecifier* NS = CSS.getScopeRep();
 
       // Create elaborated type with namespace specifier,
-      // i.e. class<T> -> clad::class<T>
-      T = C.getElaboratedType(clad_compat::ElaboratedTypeKeyword_None, NS, T);
-      return T;
+      // i.e. class -> clad::class
+      return C.getElaboratedType(clad_compat::ElaboratedTypeKeyword_None, NS,
+                                 T);
     }
 
     TemplateDecl* LookupTemplateDeclInCladNamespace(Sema& S,
@@ -1108,6 +1111,26 @@ namespace clad {
       return utils::InstantiateTemplate(S, arrayDecl, {T});
     }
 
+    QualType GetCladStaticArrayOfType(Sema& S, clang::QualType T,
+                                      std::size_t N) {
+      static TemplateDecl* staticArrayDecl = nullptr;
+      if (!staticArrayDecl)
+        staticArrayDecl = LookupTemplateDeclInCladNamespace(
+            S, /*ClassName=*/"static_array");
+      ASTContext& C = S.getASTContext();
+      TemplateArgumentListInfo TLI{};
+      TLI.addArgument(TemplateArgumentLoc(TemplateArgument(T),
+                                          C.getTrivialTypeSourceInfo(T)));
+      TLI.addArgument(TemplateArgumentLoc(GetSizeTemplateArgument(C, N),
+                                          TemplateArgumentLocInfo()));
+      return utils::InstantiateTemplate(S, staticArrayDecl, TLI);
+    }
+
+    TemplateArgument GetSizeTemplateArgument(ASTContext& C, std::size_t N) {
+      QualType sizeTy = C.getSizeType();
+      return TemplateArgument(C, C.MakeIntValue(N, sizeTy), sizeTy);
+    }
+
     bool IsDifferentiableType(QualType T) {
       QualType origType = T;
       T = T.getCanonicalType();
@@ -1262,6 +1285,33 @@ namespace clad {
         QualType argTy = C.getPointerType(oRetTy);
         FnTypes.push_back(argTy);
         return C.getFunctionType(dRetTy, FnTypes, EPI);
+      } else if (mode == DiffMode::hessian_vector_product) {
+        // The vector v and the output parameter for H.v.
+        QualType argTy = C.getPointerType(oRetTy);
+        FnTypes.push_back(argTy);
+        FnTypes.push_back(argTy);
+        return C.getFunctionType(dRetTy, FnTypes, EPI);
+      } else if (mode == DiffMode::sparse_hessian) {
+        // The output parameter for the hessian, a clad::csr_matrix of the
+        // return type.
+        TemplateDecl* csrMatrixDecl =
+            utils::LookupTemplateDeclInCladNamespace(S, "csr_matrix");
+        QualType argTy = C.getPointerType(
+            utils::InstantiateTemplate(S, csrMatrixDecl, {oRetTy}));
+        FnTypes.push_back(argTy);
+        return C.getFunctionType(dRetTy, FnTypes, EPI);
+      } else if (mode == DiffMode::sparse_jacobian) {
+        // The output parameter for the jacobian, a clad::csr_matrix of the
+        // value type of the output array, which is the last parameter.
+        QualType valueTy = oRetTy;
+        if (!FnTypes.empty())
+          valueTy = utils::GetNonConstValueType(FnTypes.back());
+        TemplateDecl* csrMatrixDecl =
+            utils::LookupTemplateDeclInCladNamespace(S, "csr_matrix");
+        QualType argTy = C.getPointerType(
+            utils::InstantiateTemplate(S, csrMatrixDecl, {valueTy}));
+        FnTypes.push_back(argTy);
+        return C.getFunctionType(dRetTy, FnTypes, EPI);
       } else if (!returnVoid && !oRetTy->isVoidType()) {
         // Handle pushforwards
         TemplateDecl* valueAndPushforward =
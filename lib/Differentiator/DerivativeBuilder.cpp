@@ -600,10 +600,13 @@ static void registerDerivative(Decl* D, Sema& S, const DiffRequest& R) {
       ReverseModeForwPassVisitor V(*this, request);
       result = V.Derive();
     } else if (request.Mode == DiffMode::hessian ||
-               request.Mode == DiffMode::hessian_diagonal) {
+               request.Mode == DiffMode::hessian_diagonal ||
+               request.Mode == DiffMode::hessian_vector_product ||
+               request.Mode == DiffMode::sparse_hessian) {
       HessianModeVisitor H(*this, request);
       result = H.Derive();
-    } else if (request.Mode == DiffMode::jacobian) {
+    } else if (request.Mode == DiffMode::jacobian ||
+               request.Mode == DiffMode::sparse_jacobian) {
       JacobianModeVisitor J(*this, request);
       result = J.Derive();
     } else if (const VarDecl* VD = request.Global) {
@@ -12,11 +12,15 @@ DerivedFnInfo::DerivedFnInfo(const DiffRequest& request,
       m_DiffVarsInfo(request.DVI),
       m_CUDAGlobalArgsIndexes(request.CUDAGlobalArgsIndexes),
       m_UsesEnzyme(request.use_enzyme),
+      m_StaticDirections(request.StaticDirections),
+      m_VectorHessian(request.VectorHessian),
       m_DeclarationOnly(request.DeclarationOnly) {}
 
 bool DerivedFnInfo::SatisfiesRequest(const DiffRequest& request) const {
   return (request.Function == m_OriginalFn && request.Mode == m_Mode &&
           request.DVI == m_DiffVarsInfo && request.use_enzyme == m_UsesEnzyme &&
+          request.StaticDirections == m_StaticDirections &&
+          request.VectorHessian == m_VectorHessian &&
           request.DeclarationOnly == m_DeclarationOnly &&
           request.CUDAGlobalArgsIndexes == m_CUDAGlobalArgsIndexes);
 }
@@ -28,6 +32,8 @@ bool DerivedFnInfo::RepresentsSameDerivative(const DerivedFnInfo& lhs,
   return lhs.m_OriginalFn == rhs.m_OriginalFn && lhs.m_Mode == rhs.m_Mode &&
          lhs.m_DiffVarsInfo == rhs.m_DiffVarsInfo &&
          lhs.m_UsesEnzyme == rhs.m_UsesEnzyme &&
+         lhs.m_StaticDirections == rhs.m_StaticDirections &&
+         lhs.m_VectorHessian == rhs.m_VectorHessian &&
          lhs.m_DeclarationOnly == rhs.m_DeclarationOnly &&
          lhs.m_CUDAGlobalArgsIndexes == rhs.m_CUDAGlobalArgsIndexes;
 }
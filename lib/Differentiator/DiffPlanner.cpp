@@ -345,6 +345,33 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
     return false;
   }
 
+  /// \returns true if \p FD is Kokkos::parallel_for or parallel_reduce.
+  static bool isKokkosLoop(const FunctionDecl* FD) {
+    const auto* NSD =
+        dyn_cast<NamespaceDecl>(FD->getDeclContext()->getRedeclContext());
+    if (!NSD || NSD->getName() != "Kokkos" || !FD->getIdentifier())
+      return false;
+    return FD->getName() == "parallel_for" ||
+           FD->getName() == "parallel_reduce";
+  }
+
+  void DiffCollector::AddKokkosLoopFunctors(const CallExpr* E) {
+    for (const Expr* Arg : E->arguments())
+      if (const CXXRecordDecl* RD = Arg->getType()->getAsCXXRecordDecl())
+        m_KokkosLoopFunctors.insert(RD->getCanonicalDecl());
+    // The functor may be called, and its pullback planned, before the loop.
+    for (DiffRequest& R : m_DiffRequestGraph.getNodes())
+      if (isKokkosLoopFunctorPullback(R))
+        R.CalledFromKokkosLoop = true;
+  }
+
+  bool DiffCollector::isKokkosLoopFunctorPullback(const DiffRequest& R) const {
+    const auto* MD = dyn_cast_or_null<CXXMethodDecl>(R.Function);
+    return R.Mode == DiffMode::pullback && MD &&
+           MD->getOverloadedOperator() == OO_Call &&
+           m_KokkosLoopFunctors.count(MD->getParent()->getCanonicalDecl());
+  }
+
   void DiffRequest::UpdateDiffParamsInfo(Sema& semaRef) {
     // Diff info for pullbacks is generated automatically,
     // its parameters are not provided by the user.
@@ -767,9 +794,10 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
     }
 
     if (Mode == DiffMode::vector_forward_mode) {
+      std::string suffix = StaticDirections ? "_dsvec" : "_dvec";
       if (DVI.size() != Function->getNumParams())
-        return BaseFunctionName + "_dvec" + argInfo;
-      return BaseFunctionName + "_dvec";
+        return BaseFunctionName + suffix + argInfo;
+      return BaseFunctionName + suffix;
     }
 
     if (Mode == DiffMode::reverse) {
@@ -803,6 +831,14 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
     return false;
   }
 
+  /// \returns true if the derivative of the request differentiates the
+  /// gradient of the function, whose callees are then planned like in the
+  /// reverse mode.
+  static bool DifferentiatesGradient(const DiffRequest& request) {
+    return request.Mode == DiffMode::hessian_vector_product ||
+           (request.Mode == DiffMode::hessian && request.VectorHessian);
+  }
+
   ///\returns true on error.
   static bool ProcessInvocationArgs(Sema& S, SourceLocation BeginLoc,
                                     const RequestOptions& ReqOpts,
@@ -821,13 +857,22 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
       request.Mode = DiffMode::forward;
     else if (Annotation == "H")
       request.Mode = DiffMode::hessian;
+    else if (Annotation == "HVP")
+      request.Mode = DiffMode::hessian_vector_product;
+    else if (Annotation == "SH")
+      request.Mode = DiffMode::sparse_hessian;
     else if (Annotation == "J")
       request.Mode = DiffMode::jacobian;
+    else if (Annotation == "SJ")
+      request.Mode = DiffMode::sparse_jacobian;
     else if (Annotation == "G")
       request.Mode = DiffMode::reverse;
     else
       llvm_unreachable("unknown mode");
-    if (request.Mode == DiffMode::reverse || request.Mode == DiffMode::hessian)
+    if (request.Mode == DiffMode::reverse ||
+        request.Mode == DiffMode::hessian ||
+        request.Mode == DiffMode::hessian_vector_product ||
+        request.Mode == DiffMode::sparse_hessian)
       request.EnableTBRAnalysis = ReqOpts.EnableTBRAnalysis;
     request.EnableVariedAnalysis = ReqOpts.EnableVariedAnalysis;
     request.EnableUsefulAnalysis = ReqOpts.EnableUsefulAnalysis;
@@ -902,6 +947,19 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
     if (enable_ua_in_req || disable_ua_in_req)
       request.EnableUsefulAnalysis = enable_ua_in_req && !disable_ua_in_req;
 
+    // Check for clad::hessian<vector_mode>.
+    if (request.Mode == DiffMode::hessian &&
+        clad::HasOption(bitmasked_opts_value, clad::opts::vector_mode)) {
+      if (clad::HasOption(bitmasked_opts_value, clad::opts::diagonal_only)) {
+        utils::diag(S, DiagnosticsEngine::Error, BeginLoc,
+                    "vector mode is not supported for the diagonal of the "
+                    "hessian")
+            << BeginLoc;
+        return true;
+      }
+      request.VectorHessian = true;
+    }
+
     // Check for clad::hessian<diagonal_only>.
     if (clad::HasOption(bitmasked_opts_value, clad::opts::diagonal_only)) {
       if (request.Mode == DiffMode::hessian) {
@@ -945,9 +1003,23 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
               << BeginLoc;
           return true;
         }
+
+        // Check for clad::differentiate<vector_mode, static_directions>.
+        if (clad::HasOption(bitmasked_opts_value,
+                            clad::opts::static_directions))
+          request.StaticDirections = true;
       }
     }
 
+    if (clad::HasOption(bitmasked_opts_value, clad::opts::static_directions) &&
+        !request.StaticDirections) {
+      utils::diag(S, DiagnosticsEngine::Error, BeginLoc,
+                  "static directions option is only valid for vector forward "
+                  "mode")
+          << BeginLoc;
+      return true;
+    }
+
     return false;
   }
 
@@ -1012,6 +1084,19 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
             utils::MatchOverloadType(S, dTy, Found, FailedCandidates))
       return overload;
 
+    // Custom reverse_forw functions may take a clad::restore_tracker to save
+    // what they overwrite, e.g. the in-place STL algorithms.
+    if (R.Mode == DiffMode::reverse_mode_forward_pass) {
+      QualType trackerDTy = utils::GetDerivativeType(
+          S, R.Function, R.Mode, diffParams, /*forCustomDerv=*/true,
+          /*shouldUseRestoreTracker=*/true);
+      TemplateSpecCandidateSet TrackerCandidates(R.CallContext->getBeginLoc(),
+                                                 /*ForTakingAddress=*/false);
+      if (Expr* overload = utils::MatchOverloadType(S, trackerDTy, Found,
+                                                    TrackerCandidates))
+        return overload;
+    }
+
     if (!enableDiagnostics)
       return nullptr;
 
@@ -1111,7 +1196,8 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
 
       std::string Annotation = A->getAnnotation().str();
       if (Annotation != "D" && Annotation != "G" && Annotation != "H" &&
-          Annotation != "J" && Annotation != "E")
+          Annotation != "HVP" && Annotation != "SH" && Annotation != "J" &&
+          Annotation != "SJ" && Annotation != "E")
         return true;
 
       // A call to clad::differentiate or clad::gradient was not found.
@@ -1129,7 +1215,34 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
 
       request.Args = E->getArg(1);
       request.UpdateDiffParamsInfo(m_Sema);
-      if (request.Mode == DiffMode::reverse && request.EnableVariedAnalysis) {
+
+      // The vectorized hessian differentiates the gradient of the function in
+      // vector forward mode. The number of rows of the tangent of array
+      // parameters and the derivative of the implicit this object are not
+      // known, fall back to the per-parameter second derivatives there.
+      if (request.VectorHessian) {
+        const auto* MD = dyn_cast<CXXMethodDecl>(request.Function);
+        bool hasThis =
+            MD && MD->isInstance() && !MD->getParent()->isLambda();
+        bool hasArrayParam =
+            std::any_of(request.DVI.begin(), request.DVI.end(),
+                        [](const DiffInputVarInfo& dParam) {
+                          return utils::isArrayOrPointerType(
+                              dParam.param->getType());
+                        });
+        if (hasThis || hasArrayParam) {
+          utils::diag(m_Sema, DiagnosticsEngine::Warning, E->getBeginLoc(),
+                      "vector mode hessian is not supported for %select{array "
+                      "or pointer parameters|member functions}0, falling back "
+                      "to the per-parameter hessian")
+              << hasThis << E->getSourceRange();
+          request.VectorHessian = false;
+        }
+      }
+
+      if ((request.Mode == DiffMode::reverse ||
+           DifferentiatesGradient(request)) &&
+          request.EnableVariedAnalysis) {
         if (request.Args)
           for (const auto& dParam : request.DVI)
             request.addVariedDecl(cast<VarDecl>(dParam.param));
@@ -1147,6 +1260,8 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
         nonDiff = true;
 
       request.VerboseDiags = false;
+      bool plansGradient = m_TopMostReq->Mode == DiffMode::reverse ||
+                           DifferentiatesGradient(*m_TopMostReq);
       request.EnableTBRAnalysis = m_TopMostReq->EnableTBRAnalysis;
       request.EnableVariedAnalysis = m_TopMostReq->EnableVariedAnalysis;
       request.EnableUsefulAnalysis = m_TopMostReq->EnableUsefulAnalysis;
@@ -1155,8 +1270,7 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
 
       const auto* MD = dyn_cast<CXXMethodDecl>(FD);
       if (MD) {
-        if (isLambdaCallOperator(MD) &&
-            m_TopMostReq->Mode == DiffMode::reverse) {
+        if (isLambdaCallOperator(MD) && plansGradient) {
           request.EnableVariedAnalysis = false;
           return true;
         }
@@ -1175,17 +1289,16 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
         nonDiff = true;
       // In the reverse mode, such functions don't have dfdx()
       if (!utils::hasMemoryTypeParams(FD) && hasPointerOrRefReturn &&
-          m_TopMostReq->Mode == DiffMode::reverse)
+          plansGradient)
         nonDiff = true;
 
-      if (nonDiff && m_TopMostReq->Mode != DiffMode::reverse)
+      if (nonDiff && !plansGradient)
         return true;
 
       request.Function = FD;
       request.CallContext = E;
       bool canUsePushforwardInRevMode =
-          m_TopMostReq->Mode == DiffMode::reverse &&
-          !request.EnableErrorEstimation &&
+          plansGradient && !request.EnableErrorEstimation &&
           utils::canUsePushforwardInRevMode(FD);
 
       std::string FDName = FD->getNameAsString();
@@ -1200,14 +1313,16 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
           m_ParentReq->Mode == DiffMode::unknown)
         request.Mode = DiffMode::unknown;
       else if (m_TopMostReq->Mode == DiffMode::forward ||
-               m_TopMostReq->Mode == DiffMode::hessian ||
+               (m_TopMostReq->Mode == DiffMode::hessian && !plansGradient) ||
+               m_TopMostReq->Mode == DiffMode::sparse_hessian ||
                canUsePushforwardInRevMode)
         request.Mode = DiffMode::pushforward;
-      else if (m_TopMostReq->Mode == DiffMode::reverse)
+      else if (plansGradient)
         request.Mode = DiffMode::pullback;
       else if (m_TopMostReq->Mode == DiffMode::vector_forward_mode ||
                m_TopMostReq->Mode == DiffMode::jacobian ||
-               m_TopMostReq->Mode == DiffMode::vector_pushforward) {
+               m_TopMostReq->Mode == DiffMode::vector_pushforward ||
+               m_TopMostReq->Mode == DiffMode::sparse_jacobian) {
         request.Mode = DiffMode::vector_pushforward;
       } else {
         assert(0 && "unexpected mode.");
@@ -1219,6 +1334,12 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
           (FDName == "cudaMemcpy" || FDName == "begin" || FDName == "end"))
         return true;
 
+      // The pullbacks of the Kokkos loops call the pullback of the functor
+      // from all iterations with the same adjoint of the functor.
+      if (request.Mode == DiffMode::pullback && isKokkosLoop(FD))
+        AddKokkosLoopFunctors(E);
+      request.CalledFromKokkosLoop = isKokkosLoopFunctorPullback(request);
+
       if (request.Mode != DiffMode::pushforward &&
           request.Mode != DiffMode::vector_pushforward) {
         // CUDA device function call in global kernel gradient
@@ -1251,8 +1372,7 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
       }
 
       // Warn if we find pullbacks.
-      if (canUsePushforwardInRevMode &&
-          m_TopMostReq->Mode == DiffMode::reverse) {
+      if (canUsePushforwardInRevMode) {
         DiffRequest R = request;
         R.BaseFunctionName = utils::ComputeEffectiveFnName(R.Function);
         R.Mode = DiffMode::pullback;
@@ -1349,7 +1469,7 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
         Saved.get()->addFunctionUsedParams(FD, usedParams[FD]);
       }
 
-      if (request.Mode == DiffMode::hessian ||
+      if ((request.Mode == DiffMode::hessian && !request.VectorHessian) ||
           request.Mode == DiffMode::hessian_diagonal) {
         DiffRequest forwRequest = request;
         forwRequest.Mode = DiffMode::forward;
@@ -1379,6 +1499,18 @@ static QualType GetDerivedFunctionType(const CallExpr* CE) {
           }
         }
       }
+
+      // Plan the gradient of the function with the analyses of the request,
+      // like the first derivatives of the hessian above.
+      if (DifferentiatesGradient(request)) {
+        DiffRequest gradRequest = request;
+        gradRequest.Mode = DiffMode::reverse;
+        gradRequest.VectorHessian = false;
+        gradRequest.CallUpdateRequired = false;
+        gradRequest.UpdateDiffParamsInfo(m_Sema);
+        LookupCustomDerivativeDecl(gradRequest);
+        m_DiffRequestGraph.addNode(gradRequest, /*isSource=*/true);
+      }
     }
 
     if (request.Mode == DiffMode::pullback) {
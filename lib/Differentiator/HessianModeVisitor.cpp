@@ -6,6 +6,7 @@
 
 #include "clad/Differentiator/HessianModeVisitor.h"
 
+#include "ConstantFolder.h"
 #include "clad/Differentiator/CladUtils.h"
 #include "clad/Differentiator/Compatibility.h"
 #include "clad/Differentiator/DiffPlanner.h"
@@ -27,6 +28,7 @@
 #include "llvm/Support/SaveAndRestore.h"
 
 #include <algorithm>
+#include <tuple>
 
 using namespace clang;
 
@@ -100,6 +102,12 @@ DerivativeAndOverload HessianModeVisitor::Derive() {
   std::string hessianFuncName = m_DiffReq.BaseFunctionName + "_hessian";
   if (m_DiffReq.Mode == DiffMode::hessian_diagonal)
     hessianFuncName += "_diagonal";
+  else if (m_DiffReq.Mode == DiffMode::hessian_vector_product)
+    hessianFuncName += "_vector_product";
+  else if (m_DiffReq.Mode == DiffMode::sparse_hessian)
+    hessianFuncName += "_sparse";
+  else if (m_DiffReq.VectorHessian)
+    hessianFuncName += "_dvec";
   // To be consistent with older tests, nothing is appended to 'f_hessian' if
   // we differentiate w.r.t. all the parameters at once.
   if (args.size() != FD->getNumParams() ||
@@ -120,6 +128,14 @@ DerivativeAndOverload HessianModeVisitor::Derive() {
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto* DC = const_cast<DeclContext*>(m_DiffReq->getDeclContext());
 
+  if (m_DiffReq.Mode == DiffMode::hessian_vector_product)
+    return DeriveHessianVectorProduct(args, indexIntervalTable,
+                                      hessianFuncName, DC, hessianFunctionType);
+  if (m_DiffReq.Mode == DiffMode::sparse_hessian)
+    return DeriveSparse(args, hessianFuncName, DC, hessianFunctionType);
+  if (m_DiffReq.VectorHessian)
+    return DeriveVectorized(args, hessianFuncName, DC, hessianFunctionType);
+
   // Ascertains the independent arguments and differentiates the function
   // in forward and reverse mode by calling ProcessDiffRequest twice each
   // iteration, storing each generated second derivative function
@@ -393,4 +409,446 @@ DerivativeAndOverload HessianModeVisitor::Derive() {
     return DerivativeAndOverload{result.first,
                                  /*OverloadFunctionDecl=*/nullptr};
   }
+
+std::pair<FunctionDecl*, FunctionDecl*>
+HessianModeVisitor::DeriveGradientTangent(DiffMode mode) {
+  // The gradient is planned along with the request, see
+  // DiffCollector::VisitCallExpr, thus its callees are analyzed.
+  DiffRequest gradientRequest{};
+  gradientRequest.Mode = DiffMode::reverse;
+  gradientRequest.Function = m_DiffReq.Function;
+  gradientRequest.Args = m_DiffReq.Args;
+  gradientRequest.BaseFunctionName = m_DiffReq.BaseFunctionName;
+  FunctionDecl* gradientFD = m_Builder.HandleNestedDiffRequest(gradientRequest);
+  if (!gradientFD)
+    return {};
+
+  DiffRequest tangentRequest{};
+  tangentRequest.Mode = mode;
+  tangentRequest.Function = gradientFD;
+  tangentRequest.BaseFunctionName = gradientFD->getNameAsString();
+  FunctionDecl* tangentFD = m_Builder.HandleNestedDiffRequest(tangentRequest);
+  if (!tangentFD)
+    return {};
+  return {gradientFD, tangentFD};
+}
+
+DerivativeAndOverload HessianModeVisitor::DeriveVectorized(
+    const DiffParams& args, const std::string& hessianFuncName,
+    DeclContext* DC, QualType hessianFunctionType) {
+  const FunctionDecl* FD = m_DiffReq.Function;
+
+  // Differentiate the gradient in vector forward mode w.r.t. the same args.
+  // The tangent of the adjoint of the i-th arg is then the i-th row of the
+  // hessian, and the whole matrix is computed with a single reverse sweep.
+  FunctionDecl* gradientFD = nullptr;
+  FunctionDecl* tangentFD = nullptr;
+  std::tie(gradientFD, tangentFD) =
+      DeriveGradientTangent(DiffMode::vector_pushforward);
+  if (!tangentFD)
+    return {};
+
+  llvm::SaveAndRestore<DeclContext*> SaveContext(m_Sema.CurContext);
+  llvm::SaveAndRestore<Scope*> SaveScope(getCurrentScope(),
+                                         getEnclosingNamespaceOrTUScope());
+  llvm::SmallVector<ParmVarDecl*, 4> params;
+  FunctionDecl* hessianFD = BeginDerivedFunction(
+      hessianFuncName, DC, hessianFunctionType, {"hessianMatrix"}, params);
+  ParmVarDecl* hessianMatrixPVD = params.back();
+
+  // size_t indepVarCount = <number of independent args>;
+  Expr* indepVarCountLiteral = ConstantFolder::synthesizeLiteral(
+      m_Context.UnsignedLongTy, m_Context, args.size());
+  VarDecl* indepVarCountVD = BuildVarDecl(
+      m_Context.UnsignedLongTy, "indepVarCount", indepVarCountLiteral);
+  addToCurrentBlock(BuildDeclStmt(indepVarCountVD));
+
+  // The arguments of the call to the vector pushforward of the gradient: the
+  // original args, the adjoints, the direction vectors of the original args
+  // and the matrices receiving the tangents of the adjoints.
+  llvm::SmallVector<Expr*, 16> callArgs;
+  llvm::SmallVector<Expr*, 8> directionArgs;
+  llvm::SmallVector<Expr*, 8> rowArgs;
+  size_t independentArgIdx = 0;
+  for (size_t i = 0, e = FD->getNumParams(); i < e; ++i) {
+    ParmVarDecl* PVD = params[i];
+    callArgs.push_back(BuildDeclRef(PVD));
+    if (!utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    QualType valueType = utils::GetNonConstValueType(PVD->getType())
+                             .getDesugaredType(m_Context);
+    Expr* indepVarCount = BuildDeclRef(indepVarCountVD);
+    if (std::find(args.begin(), args.end(), FD->getParamDecl(i)) ==
+        args.end()) {
+      // clad::zero_vector(indepVarCount);
+      directionArgs.push_back(BuildCallExprToCladFunction(
+          "zero_vector", {indepVarCount}, {valueType}, noLoc));
+      continue;
+    }
+    // clad::one_hot_vector(indepVarCount, independentArgIdx);
+    Expr* offset = ConstantFolder::synthesizeLiteral(
+        m_Context.UnsignedLongTy, m_Context, independentArgIdx++);
+    llvm::SmallVector<Expr*, 2> oneHotArgs = {indepVarCount, offset};
+    directionArgs.push_back(BuildCallExprToCladFunction(
+        "one_hot_vector", oneHotArgs, {valueType}, noLoc));
+  }
+
+  // The gradient stores the adjoints of the independent args, in the order of
+  // the parameters, after the original parameters.
+  llvm::SmallVector<VarDecl*, 8> rowDecls;
+  for (size_t i = FD->getNumParams(), e = gradientFD->getNumParams(); i < e;
+       ++i) {
+    const ParmVarDecl* adjointPVD = gradientFD->getParamDecl(i);
+    QualType adjointType = adjointPVD->getType()->getPointeeType();
+    // double _d_x = 0;
+    VarDecl* adjointVD = BuildVarDecl(adjointType, adjointPVD->getName(),
+                                      getZeroInit(adjointType));
+    addToCurrentBlock(BuildDeclStmt(adjointVD));
+    callArgs.push_back(BuildOp(UO_AddrOf, BuildDeclRef(adjointVD)));
+
+    // clad::matrix<double> _d_vector__d_x(1, indepVarCount);
+    Expr* one =
+        ConstantFolder::synthesizeLiteral(m_Context.UnsignedLongTy, m_Context,
+                                          /*val=*/1);
+    llvm::SmallVector<Expr*, 2> matrixSize = {one,
+                                              BuildDeclRef(indepVarCountVD)};
+    Expr* rowInit = m_Sema.ActOnParenListExpr(noLoc, noLoc, matrixSize).get();
+    VarDecl* rowVD = BuildVarDecl(
+        utils::GetCladMatrixOfType(m_Sema, adjointType),
+        "_d_vector_" + adjointPVD->getNameAsString(), rowInit,
+        /*DirectInit=*/true);
+    addToCurrentBlock(BuildDeclStmt(rowVD));
+    rowArgs.push_back(BuildDeclRef(rowVD));
+    rowDecls.push_back(rowVD);
+  }
+  callArgs.append(directionArgs.begin(), directionArgs.end());
+  callArgs.append(rowArgs.begin(), rowArgs.end());
+  addToCurrentBlock(BuildCallExprToFunction(tangentFD, callArgs));
+
+  // Copy the rows of the hessian to the output parameter:
+  // clad::array_ref<double>(hessianMatrix + i * indepVarCount, indepVarCount)
+  //     = *_d_vector__d_x;
+  QualType elementType = hessianMatrixPVD->getType()->getPointeeType();
+  QualType rowType = utils::GetCladArrayRefOfType(m_Sema, elementType);
+  for (size_t i = 0, e = rowDecls.size(); i < e; ++i) {
+    Expr* offset = ConstantFolder::synthesizeLiteral(
+        m_Context.UnsignedLongTy, m_Context, i * args.size());
+    Expr* rowBegin = BuildOp(BO_Add, BuildDeclRef(hessianMatrixPVD), offset);
+    llvm::SmallVector<Expr*, 2> rowRefArgs = {rowBegin,
+                                              BuildDeclRef(indepVarCountVD)};
+    Expr* rowRef =
+        m_Sema
+            .BuildCXXTypeConstructExpr(
+                m_Context.getTrivialTypeSourceInfo(rowType, noLoc), noLoc,
+                rowRefArgs, noLoc, /*ListInitialization=*/false)
+            .get();
+    Expr* row = BuildOp(UO_Deref, BuildDeclRef(rowDecls[i]));
+    addToCurrentBlock(BuildOp(BO_Assign, rowRef, row));
+  }
+
+  return EndDerivedFunction(hessianFD);
+}
+
+DerivativeAndOverload HessianModeVisitor::DeriveHessianVectorProduct(
+    const DiffParams& args, const IndexIntervalTable& indexIntervalTable,
+    const std::string& hessianFuncName, DeclContext* DC,
+    QualType hessianFunctionType) {
+  const FunctionDecl* FD = m_DiffReq.Function;
+  SourceLocation L = FD->getLocation();
+  if (m_DiffReq.Args)
+    L = m_DiffReq.Args->getExprLoc();
+
+  // FIXME: Add support for the implicit this object, the product would need
+  // an adjoint and a direction for it.
+  if (const auto* MD = dyn_cast<CXXMethodDecl>(FD)) {
+    if (MD->isInstance() && !MD->getParent()->isLambda()) {
+      diag(DiagnosticsEngine::Error, L,
+           "hessian vector product of member functions is not supported yet");
+      return {};
+    }
+  }
+
+  // The sizes of the independent args, in the order of the parameters. The
+  // adjoints of array args and their directions need a known size, which is
+  // the size of the requested index interval.
+  llvm::SmallVector<size_t, 16> independentArgsSize;
+  for (const ParmVarDecl* PVD : FD->parameters()) {
+    const auto* it = std::find(args.begin(), args.end(), PVD);
+    bool isArray = utils::isArrayOrPointerType(PVD->getType());
+    if (it == args.end()) {
+      if (isArray && utils::IsDifferentiableType(PVD->getType())) {
+        diag(DiagnosticsEngine::Error, L,
+             "hessian vector product requires the array or pointer parameter "
+             "'%0' to be an independent parameter")
+            << PVD->getName() << L;
+        return {};
+      }
+      continue;
+    }
+    if (!isArray) {
+      independentArgsSize.push_back(1);
+      continue;
+    }
+    size_t argIndex = it - args.begin();
+    if (indexIntervalTable.size() <= argIndex ||
+        indexIntervalTable[argIndex].size() == 0 ||
+        indexIntervalTable[argIndex].Start != 0) {
+      diag(DiagnosticsEngine::Error, L,
+           "hessian vector product w.r.t. array or pointer parameters needs "
+           "explicit declaration of the indices of the array starting at 0; "
+           "did you mean '%0[0:<last index of %0>]'")
+          << PVD->getName() << L;
+      return {};
+    }
+    independentArgsSize.push_back(indexIntervalTable[argIndex].size());
+  }
+
+  // Derive the pushforward of the gradient. Seeded with v, the tangents of the
+  // adjoints are H.v, at the cost of a single forward-over-reverse pass.
+  FunctionDecl* tangentFD = DeriveGradientTangent(DiffMode::pushforward).second;
+  if (!tangentFD)
+    return {};
+
+  llvm::SaveAndRestore<DeclContext*> SaveContext(m_Sema.CurContext);
+  llvm::SaveAndRestore<Scope*> SaveScope(getCurrentScope(),
+                                         getEnclosingNamespaceOrTUScope());
+  llvm::SmallVector<ParmVarDecl*, 4> params;
+  FunctionDecl* hvpFD = BeginDerivedFunction(hessianFuncName, DC,
+                                             hessianFunctionType,
+                                             {"v", "hvp"}, params);
+  ParmVarDecl* vPVD = params[params.size() - 2];
+  ParmVarDecl* hvpPVD = params.back();
+
+  // The arguments of the call to the pushforward of the gradient: the original
+  // args, the adjoints, the slices of v as the directions of the original args
+  // and the slices of hvp receiving the tangents of the adjoints.
+  llvm::SmallVector<Expr*, 16> callArgs;
+  llvm::SmallVector<Expr*, 8> directionArgs;
+  llvm::SmallVector<Expr*, 8> productArgs;
+  llvm::SmallVector<Expr*, 8> adjointArgs;
+  size_t independentArgIdx = 0;
+  size_t offset = 0;
+  for (size_t i = 0, e = FD->getNumParams(); i < e; ++i) {
+    ParmVarDecl* PVD = params[i];
+    callArgs.push_back(BuildDeclRef(PVD));
+    if (!utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    if (std::find(args.begin(), args.end(), FD->getParamDecl(i)) ==
+        args.end()) {
+      directionArgs.push_back(
+          getZeroInit(PVD->getType().getNonReferenceType()));
+      continue;
+    }
+
+    size_t size = independentArgsSize[independentArgIdx++];
+    Expr* offsetExpr = ConstantFolder::synthesizeLiteral(
+        m_Context.UnsignedLongTy, m_Context, offset);
+    // hvp + offset
+    productArgs.push_back(BuildOp(BO_Add, BuildDeclRef(hvpPVD), offsetExpr));
+    offsetExpr = ConstantFolder::synthesizeLiteral(m_Context.UnsignedLongTy,
+                                                   m_Context, offset);
+    offset += size;
+
+    QualType adjointType = utils::GetNonConstValueType(PVD->getType());
+    std::string adjointName = "_d_" + PVD->getNameAsString();
+    if (!utils::isArrayOrPointerType(PVD->getType())) {
+      // v[offset]
+      directionArgs.push_back(
+          BuildArraySubscript(BuildDeclRef(vPVD), offsetExpr));
+      // double _d_x = 0;
+      VarDecl* adjointVD = BuildVarDecl(adjointType, adjointName,
+                                        getZeroInit(adjointType));
+      addToCurrentBlock(BuildDeclStmt(adjointVD));
+      adjointArgs.push_back(BuildOp(UO_AddrOf, BuildDeclRef(adjointVD)));
+      continue;
+    }
+    // v + offset
+    directionArgs.push_back(BuildOp(BO_Add, BuildDeclRef(vPVD), offsetExpr));
+    // double _d_p[size] = {0};
+    Expr* sizeExpr =
+        ConstantFolder::synthesizeLiteral(m_Context.IntTy, m_Context, size);
+    QualType adjointArrayType = clad_compat::getConstantArrayType(
+        m_Context, adjointType,
+        llvm::APInt(m_Context.getTargetInfo().getIntWidth(), size),
+        /*SizeExpr=*/sizeExpr,
+        /*ASM=*/clad_compat::ArraySizeModifier_Normal,
+        /*IndexTypeQuals*/ 0);
+    Expr* zero =
+        ConstantFolder::synthesizeLiteral(m_Context.IntTy, m_Context, 0);
+    Expr* init = m_Sema.ActOnInitList(noLoc, {zero}, noLoc).get();
+    VarDecl* adjointVD = BuildVarDecl(adjointArrayType, adjointName, init);
+    addToCurrentBlock(BuildDeclStmt(adjointVD));
+    adjointArgs.push_back(BuildDeclRef(adjointVD));
+  }
+
+  // The pushforward accumulates the product into hvp.
+  // clad::zero_init(hvp, <number of independent args>);
+  llvm::SmallVector<Expr*, 2> zeroInitArgs = {
+      BuildDeclRef(hvpPVD),
+      ConstantFolder::synthesizeLiteral(m_Context.UnsignedLongTy, m_Context,
+                                        offset)};
+  addToCurrentBlock(GetCladZeroInit(zeroInitArgs));
+
+  callArgs.append(adjointArgs.begin(), adjointArgs.end());
+  callArgs.append(directionArgs.begin(), directionArgs.end());
+  callArgs.append(productArgs.begin(), productArgs.end());
+  addToCurrentBlock(BuildCallExprToFunction(tangentFD, callArgs));
+
+  return EndDerivedFunction(hvpFD);
+}
+
+DerivativeAndOverload HessianModeVisitor::DeriveSparse(
+    const DiffParams& args, const std::string& hessianFuncName,
+    DeclContext* DC, QualType hessianFunctionType) {
+  const FunctionDecl* FD = m_DiffReq.Function;
+  SourceLocation L = FD->getLocation();
+  if (m_DiffReq.Args)
+    L = m_DiffReq.Args->getExprLoc();
+
+  if (const auto* MD = dyn_cast<CXXMethodDecl>(FD)) {
+    if (MD->isInstance()) {
+      diag(DiagnosticsEngine::Error, L,
+           "sparse hessian of member functions is not supported yet");
+      return {};
+    }
+  }
+
+  // The hessian is computed w.r.t. a single array, its size is the size of
+  // the csr_matrix.
+  const ValueDecl* indepArg = nullptr;
+  for (const ValueDecl* arg : args) {
+    if (!utils::IsDifferentiableType(arg->getType()))
+      continue;
+    if (indepArg || !utils::isArrayOrPointerType(arg->getType())) {
+      indepArg = nullptr;
+      break;
+    }
+    indepArg = arg;
+  }
+  if (!indepArg) {
+    diag(DiagnosticsEngine::Error, L,
+         "sparse hessian requires a single independent array parameter");
+    return {};
+  }
+  for (const ParmVarDecl* PVD : FD->parameters()) {
+    if (PVD == indepArg || !utils::isArrayOrPointerType(PVD->getType()) ||
+        !utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    diag(DiagnosticsEngine::Error, L,
+         "sparse hessian does not support the array parameter '%0' which is "
+         "not the independent array")
+        << PVD->getName() << L;
+    return {};
+  }
+
+  // Derive the pushforward and differentiate it in reverse mode. Seeding the
+  // adjoint of its tangent output with 1, the adjoint of the array is the
+  // product of the hessian with the direction of the array.
+  DiffRequest pushforwardRequest{};
+  pushforwardRequest.Mode = DiffMode::pushforward;
+  pushforwardRequest.Function = FD;
+  pushforwardRequest.BaseFunctionName = m_DiffReq.BaseFunctionName;
+  FunctionDecl* pushforwardFD =
+      m_Builder.HandleNestedDiffRequest(pushforwardRequest);
+  if (!pushforwardFD)
+    return {};
+
+  DiffRequest pullbackRequest{};
+  pullbackRequest.Mode = DiffMode::pullback;
+  pullbackRequest.Function = pushforwardFD;
+  pullbackRequest.BaseFunctionName = pushforwardFD->getNameAsString();
+  for (const ParmVarDecl* PVD : pushforwardFD->parameters())
+    pullbackRequest.DVI.push_back(PVD);
+  FunctionDecl* pullbackFD = m_Builder.HandleNestedDiffRequest(pullbackRequest);
+  if (!pullbackFD)
+    return {};
+
+  llvm::SaveAndRestore<DeclContext*> SaveContext(m_Sema.CurContext);
+  llvm::SaveAndRestore<Scope*> SaveScope(getCurrentScope(),
+                                         getEnclosingNamespaceOrTUScope());
+  llvm::SmallVector<ParmVarDecl*, 4> params;
+  FunctionDecl* hessianFD = BeginDerivedFunction(
+      hessianFuncName, DC, hessianFunctionType, {"_d_hess"}, params);
+  ParmVarDecl* hessianPVD = params.back();
+
+  // clad::hessian_sweep<double> _sweep(*_d_hess);
+  QualType valueType = FD->getReturnType();
+  TemplateDecl* sweepDecl =
+      utils::LookupTemplateDeclInCladNamespace(m_Sema, "hessian_sweep");
+  QualType sweepType =
+      utils::InstantiateTemplate(m_Sema, sweepDecl, {valueType});
+  llvm::SmallVector<Expr*, 1> sweepArgs = {
+      BuildOp(UO_Deref, BuildDeclRef(hessianPVD))};
+  Expr* sweepInit = m_Sema.ActOnParenListExpr(noLoc, noLoc, sweepArgs).get();
+  VarDecl* sweepVD =
+      BuildVarDecl(sweepType, "_sweep", sweepInit, /*DirectInit=*/true);
+  addToCurrentBlock(BuildDeclStmt(sweepVD));
+
+  // The arguments of the call to the pullback of the pushforward: the original
+  // args, their directions, the adjoint of the return value, and the adjoints
+  // of the original args and of their directions.
+  llvm::SmallVector<Expr*, 16> callArgs;
+  for (ParmVarDecl* PVD : params) {
+    if (PVD != hessianPVD)
+      callArgs.push_back(BuildDeclRef(PVD));
+  }
+  for (const ParmVarDecl* PVD : FD->parameters()) {
+    if (!utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    if (PVD == indepArg)
+      callArgs.push_back(
+          BuildCallExprToMemFn(BuildDeclRef(sweepVD), "direction", {}));
+    else
+      callArgs.push_back(getZeroInit(PVD->getType().getNonReferenceType()));
+  }
+
+  // clad::ValueAndPushforward<double, double> _d_y = {0, 1};
+  unsigned numPushforwardParams = pushforwardFD->getNumParams();
+  const ParmVarDecl* returnAdjointPVD =
+      pullbackFD->getParamDecl(numPushforwardParams);
+  llvm::SmallVector<Expr*, 2> returnAdjointInit = {
+      ConstantFolder::synthesizeLiteral(m_Context.IntTy, m_Context, 0),
+      ConstantFolder::synthesizeLiteral(m_Context.IntTy, m_Context, 1)};
+  VarDecl* returnAdjointVD = BuildVarDecl(
+      returnAdjointPVD->getType(), returnAdjointPVD->getName(),
+      m_Sema.ActOnInitList(noLoc, returnAdjointInit, noLoc).get());
+  addToCurrentBlock(BuildDeclStmt(returnAdjointVD));
+  callArgs.push_back(BuildDeclRef(returnAdjointVD));
+
+  // The adjoints of the array and of its direction receive the product and
+  // the gradient. The adjoints of the other args are not used.
+  for (unsigned i = 0; i < numPushforwardParams; ++i) {
+    const ParmVarDecl* adjointPVD =
+        pullbackFD->getParamDecl(numPushforwardParams + 1 + i);
+    const ParmVarDecl* pushforwardPVD = pushforwardFD->getParamDecl(i);
+    if (utils::isArrayOrPointerType(pushforwardPVD->getType())) {
+      // The original args come first, the other array is the direction.
+      llvm::StringRef buffer = i < FD->getNumParams() ? "product" : "gradient";
+      callArgs.push_back(
+          BuildCallExprToMemFn(BuildDeclRef(sweepVD), buffer, {}));
+      continue;
+    }
+    // double _d_h = 0;
+    QualType adjointType = adjointPVD->getType()->getPointeeType();
+    VarDecl* adjointVD = BuildVarDecl(adjointType, adjointPVD->getName(),
+                                      getZeroInit(adjointType));
+    addToCurrentBlock(BuildDeclStmt(adjointVD));
+    callArgs.push_back(BuildOp(UO_AddrOf, BuildDeclRef(adjointVD)));
+  }
+  Expr* pullbackCall = BuildCallExprToFunction(pullbackFD, callArgs);
+
+  // while (_sweep.next())
+  //   f_pushforward_pullback(...);
+  Expr* cond = BuildCallExprToMemFn(BuildDeclRef(sweepVD), "next", {});
+  Sema::ConditionResult condRes = m_Sema.ActOnCondition(
+      getCurrentScope(), noLoc, cond, Sema::ConditionKind::Boolean);
+  Stmt* sweepLoop =
+      m_Sema
+          .ActOnWhileStmt(/*WhileLoc=*/noLoc, /*LParenLoc=*/noLoc, condRes,
+                          /*RParenLoc=*/noLoc, pullbackCall)
+          .get();
+  addToCurrentBlock(sweepLoop);
+
+  return EndDerivedFunction(hessianFD);
+}
 } // end namespace clad
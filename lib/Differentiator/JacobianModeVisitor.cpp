@@ -14,6 +14,9 @@ JacobianModeVisitor::JacobianModeVisitor(DerivativeBuilder& builder,
     : VectorPushForwardModeVisitor(builder, request) {}
 
 DerivativeAndOverload JacobianModeVisitor::Derive() {
+  if (m_DiffReq.Mode == DiffMode::sparse_jacobian)
+    return DeriveSparse();
+
   const FunctionDecl* FD = m_DiffReq.Function;
   assert(m_DiffReq.Mode == DiffMode::jacobian);
 
@@ -260,6 +263,143 @@ DerivativeAndOverload JacobianModeVisitor::Derive() {
   return DerivativeAndOverload{vectorDiffFD, overloadFD};
 }
 
+DerivativeAndOverload JacobianModeVisitor::DeriveSparse() {
+  const FunctionDecl* FD = m_DiffReq.Function;
+  SourceLocation L = FD->getLocation();
+  if (m_DiffReq.Args)
+    L = m_DiffReq.Args->getExprLoc();
+
+  if (const auto* MD = dyn_cast<CXXMethodDecl>(FD)) {
+    if (MD->isInstance()) {
+      diag(DiagnosticsEngine::Error, L,
+           "sparse jacobian of member functions is not supported yet");
+      return {};
+    }
+  }
+
+  // The output array is the last parameter.
+  const ParmVarDecl* outPVD = nullptr;
+  if (FD->getNumParams())
+    outPVD = FD->getParamDecl(FD->getNumParams() - 1);
+  if (!outPVD || !utils::isArrayOrPointerType(outPVD->getType()) ||
+      utils::GetValueType(outPVD->getType()).isConstQualified()) {
+    diag(DiagnosticsEngine::Error, L,
+         "sparse jacobian requires the last parameter to be the output array");
+    return {};
+  }
+
+  // The jacobian is computed w.r.t. a single array, the sizes of its
+  // directions and of the output are the sizes of the csr_matrix.
+  const ParmVarDecl* indepPVD = nullptr;
+  for (const DiffInputVarInfo& dParam : m_DiffReq.DVI) {
+    if (dParam.param == outPVD)
+      continue;
+    const auto* PVD = cast<ParmVarDecl>(dParam.param);
+    if (indepPVD || !utils::isArrayOrPointerType(PVD->getType())) {
+      indepPVD = nullptr;
+      break;
+    }
+    indepPVD = PVD;
+  }
+  if (!indepPVD) {
+    diag(DiagnosticsEngine::Error, L,
+         "sparse jacobian requires a single independent array parameter");
+    return {};
+  }
+  for (const ParmVarDecl* PVD : FD->parameters()) {
+    if (PVD == indepPVD || PVD == outPVD ||
+        !utils::isArrayOrPointerType(PVD->getType()) ||
+        !utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    diag(DiagnosticsEngine::Error, L,
+         "sparse jacobian does not support the array parameter '%0' which is "
+         "neither the independent nor the output array")
+        << PVD->getName() << L;
+    return {};
+  }
+
+  DiffRequest pushforwardRequest{};
+  pushforwardRequest.Mode = DiffMode::vector_pushforward;
+  pushforwardRequest.Function = FD;
+  pushforwardRequest.BaseFunctionName = m_DiffReq.BaseFunctionName;
+  FunctionDecl* pushforwardFD =
+      m_Builder.HandleNestedDiffRequest(pushforwardRequest);
+  if (!pushforwardFD)
+    return {};
+
+  std::string derivedFnName = m_DiffReq.BaseFunctionName + "_jac_sparse";
+  if (m_DiffReq.DVI.size() != FD->getNumParams()) {
+    const auto* it = std::find(FD->param_begin(), FD->param_end(), indepPVD);
+    derivedFnName += '_' + std::to_string(std::distance(FD->param_begin(), it));
+  }
+
+  // FIXME: We should not use const_cast to get the decl context here.
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  auto* DC = const_cast<DeclContext*>(m_DiffReq->getDeclContext());
+  llvm::SaveAndRestore<DeclContext*> SaveContext(m_Sema.CurContext);
+  llvm::SaveAndRestore<Scope*> SaveScope(getCurrentScope(),
+                                         getEnclosingNamespaceOrTUScope());
+  llvm::SmallVector<ParmVarDecl*, 4> params;
+  FunctionDecl* sparseJacFD = BeginDerivedFunction(
+      derivedFnName, DC, GetDerivativeType(), {"_d_jac"}, params);
+  ParmVarDecl* jacPVD = params.back();
+
+  // clad::jacobian_sweep<double> _sweep(*_d_jac);
+  QualType valueType = utils::GetNonConstValueType(outPVD->getType());
+  TemplateDecl* sweepDecl =
+      utils::LookupTemplateDeclInCladNamespace(m_Sema, "jacobian_sweep");
+  QualType sweepType =
+      utils::InstantiateTemplate(m_Sema, sweepDecl, {valueType});
+  llvm::SmallVector<Expr*, 1> sweepArgs = {
+      BuildOp(UO_Deref, BuildDeclRef(jacPVD))};
+  Expr* sweepInit = m_Sema.ActOnParenListExpr(noLoc, noLoc, sweepArgs).get();
+  VarDecl* sweepVD =
+      BuildVarDecl(sweepType, "_sweep", sweepInit, /*DirectInit=*/true);
+  addToCurrentBlock(BuildDeclStmt(sweepVD));
+
+  // The arguments of the call to the vector pushforward: the original args,
+  // the directions of the independent array, zero directions for the other
+  // differentiable args, and the tangents of the output array.
+  llvm::SmallVector<Expr*, 16> callArgs;
+  llvm::SmallVector<Expr*, 8> directionArgs;
+  for (size_t i = 0, e = FD->getNumParams(); i < e; ++i) {
+    const ParmVarDecl* PVD = FD->getParamDecl(i);
+    callArgs.push_back(BuildDeclRef(params[i]));
+    if (!utils::IsDifferentiableType(PVD->getType()))
+      continue;
+    if (PVD == indepPVD) {
+      directionArgs.push_back(
+          BuildCallExprToMemFn(BuildDeclRef(sweepVD), "seed", {}));
+    } else if (PVD == outPVD) {
+      directionArgs.push_back(
+          BuildCallExprToMemFn(BuildDeclRef(sweepVD), "product", {}));
+    } else {
+      // clad::zero_vector(_sweep.width());
+      QualType dParamType = utils::GetNonConstValueType(PVD->getType())
+                                .getDesugaredType(m_Context);
+      Expr* width = BuildCallExprToMemFn(BuildDeclRef(sweepVD), "width", {});
+      directionArgs.push_back(BuildCallExprToCladFunction(
+          "zero_vector", {width}, {dParamType}, noLoc));
+    }
+  }
+  callArgs.append(directionArgs.begin(), directionArgs.end());
+  Expr* pushforwardCall = BuildCallExprToFunction(pushforwardFD, callArgs);
+
+  // while (_sweep.next())
+  //   f_vector_pushforward(...);
+  Expr* cond = BuildCallExprToMemFn(BuildDeclRef(sweepVD), "next", {});
+  Sema::ConditionResult condRes = m_Sema.ActOnCondition(
+      getCurrentScope(), noLoc, cond, Sema::ConditionKind::Boolean);
+  Stmt* sweepLoop =
+      m_Sema
+          .ActOnWhileStmt(/*WhileLoc=*/noLoc, /*LParenLoc=*/noLoc, condRes,
+                          /*RParenLoc=*/noLoc, pushforwardCall)
+          .get();
+  addToCurrentBlock(sweepLoop);
+
+  return EndDerivedFunction(sparseJacFD);
+}
+
 StmtDiff JacobianModeVisitor::VisitReturnStmt(const clang::ReturnStmt* RS) {
   // If there is no return value, we must not attempt to differentiate
   if (!RS->getRetValue())
@@ -8,6 +8,10 @@
 
 namespace clad {
 class JacobianModeVisitor : public VectorPushForwardModeVisitor {
+  /// Builds f_jac_sparse, which computes the jacobian in a clad::csr_matrix
+  /// by calling the vector pushforward of the function with the compressed
+  /// directions of a clad::jacobian_sweep.
+  DerivativeAndOverload DeriveSparse();
 
 public:
   JacobianModeVisitor(DerivativeBuilder& builder, const DiffRequest& request);
@@ -28,6 +28,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/OperationKinds.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Stmt.h"
 #include "clang/AST/TemplateBase.h"
 #include "clang/AST/Type.h"
@@ -41,6 +42,7 @@
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Basic/TypeTraits.h"
 #include "clang/Basic/Version.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Overload.h"
@@ -54,6 +56,8 @@
 
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
@@ -115,8 +119,20 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     QualType TapeType = GetCladTapeOfType(type);
     LookupResult& Push = GetCladTapePush();
     LookupResult& Pop = GetCladTapePop();
-    Expr* TapeRef =
-        BuildDeclRef(GlobalStoreImpl(TapeType, prefix, getZeroInit(TapeType)));
+    IdentifierInfo* II = CreateUniqueIdentifier(prefix);
+    Expr* init = getZeroInit(TapeType);
+    // Name the tapes in their memory report, see clad/Differentiator/Tape.h.
+    // The tapes are not instrumented, and have no such constructor, in CUDA.
+    Preprocessor& PP = m_Sema.getPreprocessor();
+    if (PP.isMacroDefined("CLAD_TAPE_INSTRUMENTATION") &&
+        !PP.isMacroDefined("__CUDACC__")) {
+      Expr* names[] = {
+          utils::CreateStringLiteral(m_Context,
+                                     m_Derivative->getNameAsString()),
+          utils::CreateStringLiteral(m_Context, II->getName())};
+      init = m_Sema.ActOnInitList(noLoc, names, noLoc).get();
+    }
+    Expr* TapeRef = BuildDeclRef(GlobalStoreImpl(TapeType, II, init));
     auto* VD = cast<VarDecl>(cast<DeclRefExpr>(TapeRef)->getDecl());
     // Add fake location, since Clang AST does assert(Loc.isValid()) somewhere.
     VD->setLocation(m_DiffReq->getLocation());
@@ -182,6 +198,14 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return false;
   }
 
+  bool ReverseModeVisitor::shouldUseKokkosAtomicOps(const MemberExpr* ME) {
+    // The pullbacks of the Kokkos loops call the pullback of the functor from
+    // all iterations with the same adjoint of the functor.
+    return m_DiffReq.CalledFromKokkosLoop &&
+           ME->getType()->isRealFloatingType() &&
+           isa<CXXThisExpr>(ME->getBase()->IgnoreParenImpCasts());
+  }
+
   clang::Expr* ReverseModeVisitor::BuildCallToCudaAtomicAdd(clang::Expr* LHS,
                                                             clang::Expr* RHS) {
     DeclarationName atomicAddId = &m_Context.Idents.get("atomicAdd");
@@ -385,6 +409,95 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return DerivativeAndOverload{result.first, CreateDerivativeOverload()};
   }
 
+  /// \returns the parameter whose value or pointee \p E designates, e.g. `p`
+  /// for `p`, `*p`, `p[i]` or `*(p + i)`, or null.
+  static const ParmVarDecl* getBaseParam(const Expr* E) {
+    E = E->IgnoreParenImpCasts();
+    if (const auto* ASE = dyn_cast<ArraySubscriptExpr>(E))
+      return getBaseParam(ASE->getBase());
+    if (const auto* UO = dyn_cast<UnaryOperator>(E))
+      return UO->getOpcode() == UO_Deref ? getBaseParam(UO->getSubExpr())
+                                         : nullptr;
+    if (const auto* BO = dyn_cast<BinaryOperator>(E)) {
+      if (!BO->isAdditiveOp() || !BO->getType()->isPointerType())
+        return nullptr;
+      if (BO->getLHS()->getType()->isPointerType())
+        return getBaseParam(BO->getLHS());
+      return getBaseParam(BO->getRHS());
+    }
+    if (const auto* DRE = dyn_cast<DeclRefExpr>(E))
+      return dyn_cast<ParmVarDecl>(DRE->getDecl());
+    return nullptr;
+  }
+
+  /// \returns true if \p T is a pointer or a reference through which the
+  /// pointee can be written.
+  static bool isMutableAlias(QualType T) {
+    if (utils::isNonConstReferenceType(T))
+      return true;
+    return T->isPointerType() && !T->getPointeeType().isConstQualified();
+  }
+
+  /// Collects the parameters which are assigned or incremented in \p S, or
+  /// whose pointee is. The parameters whose address is taken, which
+  /// initialize or are assigned to a mutable pointer or reference, or which
+  /// are passed to a mutable pointer or reference parameter, may be written
+  /// through an alias and are collected too.
+  static void
+  collectWrittenParams(const Stmt* S,
+                       llvm::SmallPtrSetImpl<const ParmVarDecl*>& Written) {
+    auto insert = [&Written](const Expr* E) {
+      if (const ParmVarDecl* PVD = getBaseParam(E))
+        Written.insert(PVD);
+    };
+    if (const auto* BO = dyn_cast<BinaryOperator>(S)) {
+      if (BO->isAssignmentOp()) {
+        insert(BO->getLHS());
+        if (isMutableAlias(BO->getLHS()->getType()))
+          insert(BO->getRHS());
+      }
+    } else if (const auto* UO = dyn_cast<UnaryOperator>(S)) {
+      if (UO->isIncrementDecrementOp() || UO->getOpcode() == UO_AddrOf)
+        insert(UO->getSubExpr());
+    } else if (const auto* DS = dyn_cast<DeclStmt>(S)) {
+      for (const Decl* D : DS->decls())
+        if (const auto* VD = dyn_cast<VarDecl>(D))
+          if (VD->getInit() && isMutableAlias(VD->getType()))
+            insert(VD->getInit());
+    } else if (const auto* CE = dyn_cast<CallExpr>(S)) {
+      const FunctionDecl* FD = CE->getDirectCallee();
+      // The object of a member operator call is its first argument.
+      unsigned offset =
+          FD && isa<CXXOperatorCallExpr>(CE) && isa<CXXMethodDecl>(FD) ? 1
+                                                                        : 0;
+      for (unsigned i = 0, e = CE->getNumArgs(); i < e; ++i) {
+        const Expr* Arg = CE->getArg(i);
+        if (!FD || i < offset || i - offset >= FD->getNumParams()) {
+          if (isMutableAlias(Arg->getType()))
+            insert(Arg);
+          continue;
+        }
+        if (isMutableAlias(FD->getParamDecl(i - offset)->getType()))
+          insert(Arg);
+      }
+    }
+    for (const Stmt* Child : S->children())
+      if (Child)
+        collectWrittenParams(Child, Written);
+  }
+
+  /// \returns true if \p S contains a return statement, apart from the ones
+  /// of the lambdas it defines.
+  static bool containsReturnStmt(const Stmt* S) {
+    if (isa<ReturnStmt>(S))
+      return true;
+    if (isa<LambdaExpr>(S))
+      return false;
+    return llvm::any_of(S->children(), [](const Stmt* Child) {
+      return Child && containsReturnStmt(Child);
+    });
+  }
+
   void ReverseModeVisitor::DifferentiateWithClad() {
     if (m_DiffReq.Mode == DiffMode::reverse && !m_ExternalSource) {
       // create derived variables for parameters which are not part of
@@ -471,6 +584,13 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
       }
     }
 
+    m_WrittenParams.clear();
+    collectWrittenParams(m_DiffReq->getBody(), m_WrittenParams);
+    m_ReducesPrivatizedOverBlock =
+        m_Context.getLangOpts().CUDA &&
+        m_DiffReq->hasAttr<clang::CUDAGlobalAttr>() &&
+        !containsReturnStmt(m_DiffReq->getBody());
+
     // Start the visitation process which outputs the statements in the
     // current block.
     StmtDiff BodyDiff = Visit(m_DiffReq->getBody());
@@ -494,6 +614,24 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
       addToCurrentBlock(Reverse, direction::forward);
     for (auto S = initsDiff.rbegin(), S_end = initsDiff.rend(); S != S_end; ++S)
       addToCurrentBlock(*S, direction::forward);
+    // Add the privately accumulated adjoints to the shared ones.
+    for (const PrivatizedAdjoint& A : m_PrivatizedAdjoints) {
+      if (!m_ReducesPrivatizedOverBlock) {
+        addToCurrentBlock(
+            BuildCallToCudaAtomicAdd(Clone(A.Shared), BuildDeclRef(A.Private)),
+            direction::forward);
+        continue;
+      }
+      Expr* Address = nullptr;
+      const auto* UO = dyn_cast<UnaryOperator>(A.Shared);
+      if (UO && UO->getOpcode() == UO_Deref)
+        Address = Clone(UO->getSubExpr()->IgnoreImpCasts());
+      else
+        Address = BuildOp(UO_AddrOf, Clone(A.Shared));
+      llvm::SmallVector<Expr*, 2> Args = {Address, BuildDeclRef(A.Private)};
+      addToCurrentBlock(GetFunctionCall("block_atomic_add", "clad", Args),
+                        direction::forward);
+    }
     // Add delete statements present in m_DeallocExprs to the current block.
     for (auto* S : m_DeallocExprs)
       if (auto* CS = dyn_cast<CompoundStmt>(S))
@@ -998,6 +1136,27 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return StmtDiff(condExpr, ResultRef);
   }
 
+  /// Returns the `#pragma clad checkpoint loop` of the loop with the given
+  /// body, if any.
+  static LoopCheckpoint* getCheckpointingPragma(ASTContext& C,
+                                                const Stmt* body,
+                                                const DiffRequest& request) {
+    SourceLocation bodyLoc = body->getBeginLoc();
+    // Find the last pragma location before the loop.
+    // Note: m_CladLoopCheckpoints has reversed order.
+    auto found = request.m_CladLoopCheckpoints.upper_bound(bodyLoc);
+    if (found == request.m_CladLoopCheckpoints.end())
+      return nullptr;
+    clang::SourceManager& SM = C.getSourceManager();
+    unsigned bodyLine = SM.getPresumedLoc(bodyLoc).getLine();
+    unsigned pragmaLine = SM.getPresumedLoc(found->first).getLine();
+    // Check if the pragma is on the previous line.
+    if (bodyLine != pragmaLine + 1)
+      return nullptr;
+    found->second.Used = true;
+    return &found->second;
+  }
+
   StmtDiff
   ReverseModeVisitor::VisitCXXForRangeStmt(const CXXForRangeStmt* FRS) {
     const auto* RangeDecl = cast<VarDecl>(FRS->getRangeStmt()->getSingleDecl());
@@ -1055,6 +1214,14 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     Expr* d_decBegin = BuildOp(UO_PostDec, d_beginDeclRef);
     Expr* forwardCond = BuildOp(BO_NE, beginDeclRef, endExpr);
     const Stmt* body = FRS->getBody();
+    // The loop variable is assigned outside of the body, which thus cannot
+    // advance the state of the loop. Recompute the iterations instead.
+    LoopCheckpoint* CP = getCheckpointingPragma(m_Context, body, m_DiffReq);
+    if (CP && CP->Snapshots) {
+      diag(DiagnosticsEngine::Error, FRS->getBeginLoc(),
+           "'snapshots' is not supported for range-based for loops");
+      CP->Snapshots = 0;
+    }
     StmtDiff bodyDiff =
         DifferentiateLoopBody(body, loopCounter, nullptr, nullptr,
                               /*isForLoop=*/true);
@@ -1181,10 +1348,9 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     }
 
     const Stmt* body = FS->getBody();
-    StmtDiff BodyDiff = DifferentiateLoopBody(body, loopCounter,
-                                              condVarRes.getStmt_dx(),
-                                              incDiff.getStmt_dx(),
-                                              /*isForLoop=*/true);
+    StmtDiff BodyDiff = DifferentiateLoopBody(
+        body, loopCounter, condVarRes.getStmt_dx(), incDiff.getStmt_dx(),
+        /*isForLoop=*/true, incDiff.getExpr());
 
     /// FIXME: This part in necessary to replace local variables inside loops
     /// with function globals and replace initializations with assignments.
@@ -1431,14 +1597,96 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return StmtDiff(clonedILE, ILEDiff);
   }
 
+  bool ReverseModeVisitor::isWrittenParam(const ParmVarDecl* PVD,
+                                          llvm::StringRef prefix) const {
+    llvm::StringRef name = PVD->getName();
+    if (!name.consume_front(prefix))
+      return false;
+    return llvm::any_of(m_WrittenParams, [name](const ParmVarDecl* W) {
+      return W->getName() == name;
+    });
+  }
+
+  bool ReverseModeVisitor::dependsOnParamsOnly(const Stmt* S) const {
+    if (const auto* DRE = dyn_cast<DeclRefExpr>(S)) {
+      if (const auto* PVD = dyn_cast<ParmVarDecl>(DRE->getDecl()))
+        return !isWrittenParam(PVD);
+      return isa<EnumConstantDecl>(DRE->getDecl());
+    }
+    if (isa<CallExpr>(S) || isa<MemberExpr>(S))
+      return false;
+    if (const auto* BO = dyn_cast<BinaryOperator>(S))
+      if (BO->isAssignmentOp())
+        return false;
+    if (const auto* UO = dyn_cast<UnaryOperator>(S))
+      if (UO->isIncrementDecrementOp())
+        return false;
+    return llvm::all_of(S->children(), [this](const Stmt* Child) {
+      return !Child || dependsOnParamsOnly(Child);
+    });
+  }
+
+  bool ReverseModeVisitor::isThreadInvariantAdjoint(const Expr* E) {
+    E = E->IgnoreParenImpCasts();
+    const Expr* Base = nullptr;
+    const Expr* Idx = nullptr;
+    if (const auto* UO = dyn_cast<UnaryOperator>(E)) {
+      if (UO->getOpcode() != UO_Deref)
+        return false;
+      Base = UO->getSubExpr();
+    } else if (const auto* ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+      Base = ASE->getBase();
+      Idx = ASE->getIdx();
+    } else {
+      return false;
+    }
+    const auto* BaseDRE = dyn_cast<DeclRefExpr>(Base->IgnoreParenImpCasts());
+    if (!BaseDRE || !isa<ParmVarDecl>(BaseDRE->getDecl()))
+      return false;
+    // The adjoint of a written element is read by the reverse pass, thus it
+    // must be updated in place.
+    if (isWrittenParam(cast<ParmVarDecl>(BaseDRE->getDecl()), "_d_"))
+      return false;
+    return !Idx || dependsOnParamsOnly(Idx);
+  }
+
+  Expr* ReverseModeVisitor::BuildPrivatizedIncrement(
+      Expr* E, llvm::SmallVectorImpl<PrivatizedAdjoint>& Privatized) {
+    llvm::FoldingSetNodeID ID;
+    E->Profile(ID, m_Context, /*Canonical=*/true);
+    auto It = llvm::find_if(Privatized, [&ID](const PrivatizedAdjoint& A) {
+      return A.ID == ID;
+    });
+    if (It == Privatized.end()) {
+      QualType Type = utils::getNonConstType(E->getType(), m_Sema);
+      VarDecl* Private = GlobalStoreImpl(Type, "_acc", getZeroInit(Type));
+      Privatized.push_back({ID, E, Private});
+      It = std::prev(Privatized.end());
+    }
+    return BuildOp(BO_AddAssign, BuildDeclRef(It->Private), dfdx());
+  }
+
   Expr* ReverseModeVisitor::BuildDiffIncrement(Expr* E) {
     if (!dfdx() || !E || !E->getType()->isRealType())
       return nullptr;
     Expr* base = E;
     if (auto* UO = dyn_cast<UnaryOperator>(E))
       base = UO->getSubExpr()->IgnoreImpCasts();
-    if (shouldUseCudaAtomicOps(base))
+    // The threads accumulate the updates of a loop to an adjoint they all
+    // update in a private variable and add it to the adjoint once. When all
+    // the threads of the block reach the end of the kernel, the updates
+    // outside the loops are accumulated too and reduced over the block.
+    if (shouldUseCudaAtomicOps(base)) {
+      if ((isInsideLoop || m_ReducesPrivatizedOverBlock) &&
+          isThreadInvariantAdjoint(E))
+        return BuildPrivatizedIncrement(E, m_PrivatizedAdjoints);
       return BuildCallToCudaAtomicAdd(E, dfdx());
+    }
+    if (shouldUseOMPAtomicOps(E)) {
+      if (isThreadInvariantAdjoint(E))
+        return BuildPrivatizedIncrement(E, m_OMPRegion->Privatized);
+      return BuildCallToAtomicAdd(E, dfdx());
+    }
     return BuildOp(BO_AddAssign, E, dfdx());
   }
 
@@ -1825,6 +2073,10 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     m_DerivativeFnScope = getCurrentScope();
     Stmts OuterGlobals;
     std::swap(m_Globals, OuterGlobals);
+    llvm::SmallVector<PrivatizedAdjoint, 4> OuterPrivatizedAdjoints;
+    std::swap(m_PrivatizedAdjoints, OuterPrivatizedAdjoints);
+    llvm::SaveAndRestore<bool> SaveReduces(m_ReducesPrivatizedOverBlock,
+                                           false);
 
     beginBlock();
 
@@ -1833,6 +2085,9 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
       addToCurrentBlock(S);
     for (auto* S : cast<CompoundStmt>(BodyDiff.getStmt_dx())->body())
       addToCurrentBlock(S);
+    for (const PrivatizedAdjoint& A : m_PrivatizedAdjoints)
+      addToCurrentBlock(
+          BuildCallToCudaAtomicAdd(Clone(A.Shared), BuildDeclRef(A.Private)));
 
     CompoundStmt* DerivedBody = endBlock();
 
@@ -1848,6 +2103,7 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     }
     m_Globals.clear();
     std::swap(m_Globals, OuterGlobals);
+    std::swap(m_PrivatizedAdjoints, OuterPrivatizedAdjoints);
 
     Expr* lambda =
         m_Sema
@@ -2419,6 +2675,8 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
       Expr* CUDAExecConfig /*=nullptr*/) {
     int printErrorInf = m_Builder.shouldPrintNumDiffErrs();
     llvm::SmallVector<Expr*, 16U> NumDiffArgs = {};
+    if (!CUDAExecConfig)
+      targetFuncCall = BuildComplexStepTarget(targetFuncCall);
     NumDiffArgs.push_back(targetFuncCall);
     // build the output array declaration.
     Expr* size =
@@ -3533,8 +3791,15 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
       derivedME = utils::BuildMemberExpr(m_Sema, getCurrentScope(),
                                          baseDiff.getExpr_dx(), fieldName);
     if (dfdx() && clonedME->getType()->isRealType()) {
-      Expr* addAssign =
-          BuildOp(BinaryOperatorKind::BO_AddAssign, derivedME, dfdx());
+      Expr* addAssign = nullptr;
+      if (shouldUseKokkosAtomicOps(ME)) {
+        llvm::SmallVector<Expr*, 2> Args = {BuildOp(UO_AddrOf, derivedME),
+                                            dfdx()};
+        addAssign = GetFunctionCall("atomic_add", "Kokkos", Args);
+      } else {
+        addAssign =
+            BuildOp(BinaryOperatorKind::BO_AddAssign, derivedME, dfdx());
+      }
       addToCurrentBlock(addAssign, direction::reverse);
     }
     return {clonedME, derivedME};
@@ -3581,13 +3846,18 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
                                                Expr* init) {
     // Create identifier before going to topmost scope
     // to let Sema::LookupName see the whole scope.
-    auto* identifier = CreateUniqueIdentifier(prefix);
+    return GlobalStoreImpl(Type, CreateUniqueIdentifier(prefix), init);
+  }
+
+  VarDecl* ReverseModeVisitor::GlobalStoreImpl(QualType Type,
+                                               IdentifierInfo* II,
+                                               Expr* init) {
     // Save current scope and temporarily go to topmost function scope.
     llvm::SaveAndRestore<Scope*> SaveScope(getCurrentScope());
     assert(m_DerivativeFnScope && "must be set");
     setCurrentScope(m_DerivativeFnScope);
 
-    VarDecl* Var = BuildVarDecl(Type, identifier, init);
+    VarDecl* Var = BuildVarDecl(Type, II, init);
 
     // Add the declaration to the body of the gradient function.
     addToBlock(BuildDeclStmt(Var), m_Globals);
@@ -4110,34 +4380,19 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return {endBlock(direction::forward), endBlock(direction::reverse)};
   }
 
-  static bool hasCheckpointingPragma(ASTContext& C, const Stmt* body,
-                                     const DiffRequest& request) {
-    SourceLocation bodyLoc = body->getBeginLoc();
-    // Find the last pragma location before the loop.
-    // Note: m_CladLoopCheckpoints has reversed order.
-    auto found = request.m_CladLoopCheckpoints.upper_bound(bodyLoc);
-    if (found == request.m_CladLoopCheckpoints.end())
-      return false;
-    clang::SourceManager& SM = C.getSourceManager();
-    unsigned bodyLine = SM.getPresumedLoc(bodyLoc).getLine();
-    unsigned pragmaLine = SM.getPresumedLoc(found->first).getLine();
-    // Check if the pragma is on the previous line.
-    bool pragmaFound = (bodyLine == pragmaLine + 1);
-    if (pragmaFound)
-      found->second = true;
-    return pragmaFound;
-  }
-
   StmtDiff ReverseModeVisitor::DifferentiateLoopBody(const Stmt* body,
                                                      LoopCounter& loopCounter,
                                                      Stmt* condVarDiff,
                                                      Stmt* forLoopIncDiff,
-                                                     bool isForLoop) {
+                                                     bool isForLoop,
+                                                     Expr* forLoopInc) {
     // If the user marked this loop with a checkpointing pragma,
     // we should avoid using tapes inside it in favor of recomputations.
     llvm::SaveAndRestore<bool> Saved(isInsideLoop);
     llvm::SaveAndRestore<bool> SavedCP(m_IsInsideCheckpointedLoop);
-    bool shouldCheckpoint = hasCheckpointingPragma(m_Context, body, m_DiffReq);
+    const LoopCheckpoint* checkpoint =
+        getCheckpointingPragma(m_Context, body, m_DiffReq);
+    bool shouldCheckpoint = checkpoint;
     if (shouldCheckpoint) {
       isInsideLoop = false;
       m_IsInsideCheckpointedLoop = true;
@@ -4193,6 +4448,11 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
            llvm::reverse(cast<CompoundStmt>(bodyDiff.getStmt())->body()))
         bodyDiff.updateStmtDx(utils::PrependAndCreateCompoundStmt(
             m_Context, bodyDiff.getStmt_dx(), S));
+      // With snapshots, the recomputation starts from the stored state of the
+      // iteration instead of the current one.
+      if (checkpoint->Snapshots)
+        AddBinomialCheckpointing(bodyDiff, body, loopCounter,
+                                 checkpoint->Snapshots, forLoopInc, isForLoop);
     }
     // Increment statement in the for-loop is executed for every case
     if (forLoopIncDiff) {
@@ -4239,6 +4499,227 @@ Expr* ReverseModeVisitor::getStdInitListSizeExpr(const Expr* E) {
     return bodyDiff;
   }
 
+  /// Returns true if S contains a `break` or `continue` statement of the loop
+  /// whose body is S.
+  static bool hasLoopJump(const Stmt* S, bool inSwitch = false) {
+    if (!S)
+      return false;
+    if (isa<ContinueStmt>(S) || (isa<BreakStmt>(S) && !inSwitch))
+      return true;
+    if (isa<ForStmt>(S) || isa<WhileStmt>(S) || isa<DoStmt>(S) ||
+        isa<CXXForRangeStmt>(S))
+      return false;
+    inSwitch |= isa<SwitchStmt>(S);
+    for (const Stmt* child : S->children())
+      if (hasLoopJump(child, inSwitch))
+        return true;
+    return false;
+  }
+
+  namespace {
+  /// Collects the variables modified by the forward pass statements of a
+  /// loop iteration, which are stored in the snapshots of its binomial
+  /// checkpointing. Finds the first modification which cannot be stored.
+  class LoopStateCollector : public RecursiveASTVisitor<LoopStateCollector> {
+    const NamespaceDecl* m_CladNS;
+    llvm::SmallPtrSet<const VarDecl*, 8> m_Locals;
+
+  public:
+    llvm::SetVector<VarDecl*> State;
+    /// The first modification through a pointer or of a non trivially
+    /// copyable variable, if any.
+    const Expr* Unsupported = nullptr;
+
+    LoopStateCollector(const NamespaceDecl* CladNS) : m_CladNS(CladNS) {}
+
+    void addModified(const Expr* E, bool throughPointer = false) {
+      const Expr* Orig = E;
+      while (true) {
+        E = E->IgnoreParenImpCasts();
+        if (const auto* ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+          E = ASE->getBase();
+          throughPointer = true;
+        } else if (const auto* ME = dyn_cast<MemberExpr>(E)) {
+          E = ME->getBase();
+          throughPointer |= ME->isArrow();
+        } else if (const auto* UO = dyn_cast<UnaryOperator>(E)) {
+          if (UO->getOpcode() == UO_Deref)
+            throughPointer = true;
+          else if (UO->getOpcode() == UO_AddrOf)
+            throughPointer = false;
+          else
+            break;
+          E = UO->getSubExpr();
+        } else if (const auto* BO = dyn_cast<BinaryOperator>(E)) {
+          // Pointer arithmetic, e.g. `arr + i`.
+          if (!BO->getType()->isPointerType())
+            break;
+          E = BO->getLHS()->getType()->isPointerType() ? BO->getLHS()
+                                                       : BO->getRHS();
+        } else {
+          break;
+        }
+      }
+      const auto* DRE = dyn_cast<DeclRefExpr>(E);
+      const auto* VD = DRE ? dyn_cast<VarDecl>(DRE->getDecl()) : nullptr;
+      if (!VD) {
+        if (throughPointer && !Unsupported)
+          Unsupported = Orig;
+        return;
+      }
+      if (m_Locals.count(VD))
+        return;
+      QualType T = VD->getType().getNonReferenceType();
+      // The tapes and the trackers of the iteration are not a part of its
+      // state.
+      if (const auto* RD = T->getAsCXXRecordDecl())
+        if (RD->getEnclosingNamespaceContext() == m_CladNS)
+          return;
+      if ((throughPointer && T->isPointerType()) ||
+          !T.isTriviallyCopyableType(VD->getASTContext())) {
+        if (!Unsupported)
+          Unsupported = Orig;
+        return;
+      }
+      State.insert(const_cast<VarDecl*>(VD));
+    }
+
+    bool VisitVarDecl(VarDecl* VD) {
+      m_Locals.insert(VD);
+      return true;
+    }
+
+    bool VisitBinaryOperator(BinaryOperator* BO) {
+      if (BO->isAssignmentOp())
+        addModified(BO->getLHS());
+      return true;
+    }
+
+    bool VisitUnaryOperator(UnaryOperator* UO) {
+      if (UO->isIncrementDecrementOp() || UO->getOpcode() == UO_AddrOf)
+        addModified(UO->getSubExpr());
+      return true;
+    }
+
+    bool VisitCallExpr(CallExpr* CE) {
+      const FunctionDecl* FD = CE->getDirectCallee();
+      if (!FD)
+        return true;
+      unsigned argOffset = 0;
+      if (const auto* MD = dyn_cast<CXXMethodDecl>(FD)) {
+        if (MD->isInstance()) {
+          const Expr* object = nullptr;
+          if (const auto* MCE = dyn_cast<CXXMemberCallExpr>(CE)) {
+            object = MCE->getImplicitObjectArgument();
+          } else if (isa<CXXOperatorCallExpr>(CE)) {
+            object = CE->getArg(0);
+            argOffset = 1;
+          }
+          if (object && !MD->isConst())
+            addModified(object, object->getType()->isPointerType());
+        }
+      }
+      for (unsigned i = argOffset, e = CE->getNumArgs(); i < e; ++i) {
+        if (i - argOffset >= FD->getNumParams())
+          break;
+        QualType paramTy = FD->getParamDecl(i - argOffset)->getType();
+        if ((paramTy->isLValueReferenceType() || paramTy->isPointerType()) &&
+            !paramTy->getPointeeType().isConstQualified())
+          addModified(CE->getArg(i), paramTy->isPointerType());
+      }
+      return true;
+    }
+  };
+  } // namespace
+
+  bool ReverseModeVisitor::AddBinomialCheckpointing(
+      StmtDiff& bodyDiff, const Stmt* body, LoopCounter& loopCounter,
+      unsigned snapshots, Expr* forLoopInc, bool isForLoop) {
+    SourceLocation L = body->getBeginLoc();
+    // The iterations of a nested loop are reversed once for every iteration of
+    // the outer loop while the snapshots are stored once.
+    if (!m_LoopBlock.empty()) {
+      diag(DiagnosticsEngine::Error, L,
+           "'snapshots' is not supported for loops nested in other loops");
+      return false;
+    }
+    if (hasLoopJump(body)) {
+      diag(DiagnosticsEngine::Error, L,
+           "'snapshots' is not supported for loops containing 'break' or "
+           "'continue' statements");
+      return false;
+    }
+
+    // Find the variables modified by an iteration.
+    auto* forward = cast<CompoundStmt>(bodyDiff.getStmt());
+    LoopStateCollector collector(utils::GetCladNamespace(m_Sema));
+    collector.TraverseStmt(forward);
+    if (forLoopInc)
+      collector.TraverseStmt(forLoopInc);
+    if (collector.Unsupported) {
+      SourceLocation UL = collector.Unsupported->getBeginLoc();
+      if (UL.isInvalid())
+        UL = L;
+      diag(DiagnosticsEngine::Error, UL,
+           "'snapshots' requires the loop to only modify variables of "
+           "trivially copyable types, not memory accessed through pointers")
+          << UL;
+      return false;
+    }
+
+    // clad::revolve _cp0 = {N};
+    QualType revolveTy = utils::GetCladClassType(m_Sema, "revolve");
+    llvm::SmallVector<Expr*, 1> revolveArgs = {
+        ConstantFolder::synthesizeLiteral(m_Context.UnsignedIntTy, m_Context,
+                                          snapshots)};
+    Expr* revolveInit = m_Sema.ActOnInitList(noLoc, revolveArgs, noLoc).get();
+    VarDecl* revolveVD = GlobalStoreImpl(revolveTy, "_cp", revolveInit);
+
+    auto buildStateRefs = [this, &collector]() {
+      llvm::SmallVector<Expr*, 8> refs;
+      for (VarDecl* VD : collector.State)
+        refs.push_back(BuildDeclRef(VD));
+      return refs;
+    };
+
+    // Restore the state at the beginning of the reverse pass iteration, the
+    // counter of the `for` loops is decremented at its end.
+    // while (_cp0.restore(_t0 - 1, i, u)) {
+    //   ... // the forward pass iteration
+    //   ++i;
+    // }
+    Expr* target = Clone(loopCounter.getRef());
+    if (isForLoop)
+      target = BuildOp(BO_Sub, target,
+                       ConstantFolder::synthesizeLiteral(m_Context.IntTy,
+                                                         m_Context, 1));
+    llvm::SmallVector<Expr*, 8> restoreArgs = {target};
+    llvm::SmallVector<Expr*, 8> stateRefs = buildStateRefs();
+    restoreArgs.append(stateRefs.begin(), stateRefs.end());
+    Expr* restoreCall =
+        BuildCallExprToMemFn(BuildDeclRef(revolveVD), "restore", restoreArgs);
+    Stmts advance(forward->body_begin(), forward->body_end());
+    if (forLoopInc)
+      advance.push_back(forLoopInc);
+    Sema::ConditionResult condRes = m_Sema.ActOnCondition(
+        getCurrentScope(), noLoc, restoreCall, Sema::ConditionKind::Boolean);
+    Stmt* advanceLoop =
+        m_Sema
+            .ActOnWhileStmt(/*WhileLoc=*/noLoc, /*LParenLoc=*/noLoc, condRes,
+                            /*RParenLoc=*/noLoc, MakeCompoundStmt(advance))
+            .get();
+    bodyDiff.updateStmtDx(utils::PrependAndCreateCompoundStmt(
+        m_Context, bodyDiff.getStmt_dx(), advanceLoop));
+
+    // Store the state of the first iteration.
+    // _cp0.forward(i, u);
+    Expr* forwardCall = BuildCallExprToMemFn(BuildDeclRef(revolveVD), "forward",
+                                             buildStateRefs());
+    bodyDiff.updateStmt(
+        utils::PrependAndCreateCompoundStmt(m_Context, forward, forwardCall));
+    return true;
+  }
+
   StmtDiff ReverseModeVisitor::VisitContinueStmt(const ContinueStmt* CS) {
     beginBlock(direction::forward);
     Stmt* newCS = m_Sema.ActOnContinueStmt(noLoc, getCurrentScope()).get();
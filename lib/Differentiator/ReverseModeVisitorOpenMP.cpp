@@ -0,0 +1,503 @@
+#include "clad/Differentiator/CladUtils.h"
+#include "clad/Differentiator/Compatibility.h"
+#include "clad/Differentiator/ReverseModeVisitor.h"
+
+#include "clang/AST/DeclarationName.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/OpenMPClause.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/StmtOpenMP.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/OpenMPKinds.h"
+#include "clang/Basic/OperatorKinds.h"
+#include "clang/Sema/DeclSpec.h"
+#include "clang/Sema/Scope.h"
+#include "clang/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Frontend/OpenMP/OMP.h.inc"
+#include "llvm/Support/SaveAndRestore.h"
+
+#include <cstddef>
+#include <tuple>
+
+using namespace clang;
+using namespace llvm::omp;
+
+namespace clad {
+namespace {
+/// The variables listed by the data-sharing clauses of a parallel loop.
+struct OMPDataSharing {
+  llvm::SmallVector<Expr*, 8> Private;
+  llvm::SmallVector<Expr*, 8> Firstprivate;
+  llvm::SmallVector<Expr*, 8> Lastprivate;
+  llvm::SmallVector<Expr*, 8> Shared;
+  llvm::SmallVector<Expr*, 8> Reduction;
+  /// The operator of the reduction, `+` if not set.
+  DeclarationNameInfo ReductionId;
+};
+
+/// Collects the variables declared by \p S and its children.
+void CollectDeclaredVars(const Stmt* S,
+                         llvm::SmallPtrSetImpl<const VarDecl*>& Vars) {
+  if (!S)
+    return;
+  if (const auto* DS = dyn_cast<DeclStmt>(S))
+    for (const Decl* D : DS->decls())
+      if (const auto* VD = dyn_cast<VarDecl>(D))
+        Vars.insert(VD);
+  for (const Stmt* Child : S->children())
+    CollectDeclaredVars(Child, Vars);
+}
+
+/// \returns true if \p S continues the loop it belongs to.
+bool ContinuesLoop(const Stmt* S) {
+  if (!S || isa<ForStmt>(S) || isa<WhileStmt>(S) || isa<DoStmt>(S) ||
+      isa<CXXForRangeStmt>(S))
+    return false;
+  if (isa<ContinueStmt>(S))
+    return true;
+  return llvm::any_of(S->children(), ContinuesLoop);
+}
+
+/// \returns the variable holding the memory designated by the lvalue \p E,
+/// e.g. `x` for `x[i]`, `*x` or `x.a`.
+const VarDecl* GetBaseVar(const Expr* E) {
+  E = E->IgnoreParenImpCasts();
+  while (true) {
+    if (const auto* ASE = dyn_cast<ArraySubscriptExpr>(E))
+      E = ASE->getBase()->IgnoreParenImpCasts();
+    else if (const auto* ME = dyn_cast<MemberExpr>(E))
+      E = ME->getBase()->IgnoreParenImpCasts();
+    else if (const auto* UO = dyn_cast<UnaryOperator>(E);
+             UO && UO->getOpcode() == UO_Deref)
+      E = UO->getSubExpr()->IgnoreParenImpCasts();
+    else
+      break;
+  }
+  if (const auto* DRE = dyn_cast<DeclRefExpr>(E))
+    return dyn_cast<VarDecl>(DRE->getDecl());
+  return nullptr;
+}
+
+/// Counts in \p Refs the references to the variables in \p S and in
+/// \p Stored the ones which only store to them, i.e. the bases of the
+/// left-hand sides of the plain assignments. The variables written by \p S
+/// are collected in \p Written.
+void CollectAccesses(const Stmt* S,
+                     llvm::DenseMap<const VarDecl*, unsigned>& Refs,
+                     llvm::DenseMap<const VarDecl*, unsigned>& Stored,
+                     llvm::SmallPtrSetImpl<const VarDecl*>& Written) {
+  if (!S)
+    return;
+  if (const auto* DRE = dyn_cast<DeclRefExpr>(S))
+    if (const auto* VD = dyn_cast<VarDecl>(DRE->getDecl()))
+      ++Refs[VD];
+  const Expr* LHS = nullptr;
+  if (const auto* BO = dyn_cast<BinaryOperator>(S)) {
+    if (BO->isAssignmentOp()) {
+      LHS = BO->getLHS();
+      if (!BO->isCompoundAssignmentOp())
+        if (const VarDecl* VD = GetBaseVar(LHS))
+          ++Stored[VD];
+    }
+  } else if (const auto* UO = dyn_cast<UnaryOperator>(S)) {
+    if (UO->isIncrementDecrementOp())
+      LHS = UO->getSubExpr();
+  }
+  if (LHS)
+    if (const VarDecl* VD = GetBaseVar(LHS))
+      Written.insert(VD);
+  for (const Stmt* Child : S->children())
+    CollectAccesses(Child, Refs, Stored, Written);
+}
+
+/// \returns true if an iteration of the parallel loop \p D, whose loop is
+/// \p FS, writes to shared memory which the loop also reads, e.g.
+/// `x[i] = x[i] * x[i]`. The reverse pass recomputes the iterations, which
+/// would read the values written by the forward pass.
+bool OverwritesSharedInputs(const OMPParallelForDirective* D,
+                            const ForStmt* FS) {
+  llvm::SmallPtrSet<const VarDecl*, 16> Private;
+  CollectDeclaredVars(FS, Private);
+  if (const auto* BO = dyn_cast_or_null<BinaryOperator>(FS->getInit()))
+    if (const VarDecl* VD = GetBaseVar(BO->getLHS()))
+      Private.insert(VD);
+  auto AddVars = [&Private](auto VarList) {
+    for (const Expr* Var : VarList)
+      if (const VarDecl* VD = GetBaseVar(Var))
+        Private.insert(VD);
+  };
+  for (const OMPClause* C : D->clauses()) {
+    if (const auto* PC = dyn_cast<OMPPrivateClause>(C))
+      AddVars(CLAD_COMPAT_CLANG20_getvarlist(PC));
+    else if (const auto* FPC = dyn_cast<OMPFirstprivateClause>(C))
+      AddVars(CLAD_COMPAT_CLANG20_getvarlist(FPC));
+    else if (const auto* LPC = dyn_cast<OMPLastprivateClause>(C))
+      AddVars(CLAD_COMPAT_CLANG20_getvarlist(LPC));
+    else if (const auto* RC = dyn_cast<OMPReductionClause>(C))
+      AddVars(CLAD_COMPAT_CLANG20_getvarlist(RC));
+  }
+  llvm::DenseMap<const VarDecl*, unsigned> Refs;
+  llvm::DenseMap<const VarDecl*, unsigned> Stored;
+  llvm::SmallPtrSet<const VarDecl*, 16> Written;
+  CollectAccesses(FS->getBody(), Refs, Stored, Written);
+  return llvm::any_of(Written, [&](const VarDecl* VD) {
+    return !Private.count(VD) && Refs.lookup(VD) > Stored.lookup(VD);
+  });
+}
+
+/// \returns the variable initialized or assigned by the init statement of a
+/// canonical loop.
+VarDecl* GetLoopVar(Stmt* Init) {
+  if (auto* DS = dyn_cast_or_null<DeclStmt>(Init))
+    return dyn_cast<VarDecl>(DS->getSingleDecl());
+  if (auto* BO = dyn_cast_or_null<BinaryOperator>(Init))
+    if (auto* DRE = dyn_cast<DeclRefExpr>(BO->getLHS()->IgnoreParenImpCasts()))
+      return dyn_cast<VarDecl>(DRE->getDecl());
+  return nullptr;
+}
+
+/// Builds `#pragma omp parallel for` with the loop built by \p BuildLoop and
+/// the clauses listing the variables of \p DSA, built once the loop is.
+Stmt* BuildParallelFor(Sema& S, Scope* CurScope, SourceLocation BeginLoc,
+                       SourceLocation EndLoc,
+                       llvm::function_ref<Stmt*()> BuildLoop,
+                       llvm::function_ref<void(OMPDataSharing&)> BuildDSA) {
+  auto& OMP = CLAD_COMPAT_CLANG19_SemaOpenMP(S);
+  DeclarationNameInfo DirName;
+  OMP.StartOpenMPDSABlock(OMPD_parallel_for, DirName, CurScope, BeginLoc);
+  OMP.ActOnOpenMPRegionStart(OMPD_parallel_for, CurScope);
+  Stmt* Loop = nullptr;
+  {
+    Sema::CompoundScopeRAII CompoundScope(S);
+    Loop = BuildLoop();
+  }
+  OMPDataSharing DSA;
+  BuildDSA(DSA);
+
+  llvm::SmallVector<OMPClause*, 8> Clauses;
+  auto AddClause = [&](OpenMPClauseKind Kind, ArrayRef<Expr*> Vars) {
+    if (Vars.empty())
+      return;
+    OMP.StartOpenMPClause(Kind);
+    SourceLocation L;
+    OMPClause* C = nullptr;
+    switch (Kind) {
+    case OMPC_private:
+      C = OMP.ActOnOpenMPPrivateClause(Vars, L, L, L);
+      break;
+    case OMPC_firstprivate:
+      C = OMP.ActOnOpenMPFirstprivateClause(Vars, L, L, L);
+      break;
+    case OMPC_lastprivate:
+      C = OMP.ActOnOpenMPLastprivateClause(Vars, OMPC_LASTPRIVATE_unknown, L, L,
+                                           L, L, L);
+      break;
+    case OMPC_shared:
+      C = OMP.ActOnOpenMPSharedClause(Vars, L, L, L);
+      break;
+    case OMPC_reduction: {
+      CXXScopeSpec ReductionIdScopeSpec;
+      DeclarationNameInfo ReductionId = DSA.ReductionId;
+      if (!ReductionId.getName())
+        ReductionId.setName(
+            S.getASTContext().DeclarationNames.getCXXOperatorName(OO_Plus));
+      C = OMP.ActOnOpenMPReductionClause(
+          Vars, CLAD_COMPAT_CLANG21_DefaultReductionModifier, L, L, L, L, L,
+          ReductionIdScopeSpec, ReductionId);
+      break;
+    }
+    default:
+      llvm_unreachable("not a data-sharing clause");
+    }
+    OMP.EndOpenMPClause();
+    if (C)
+      Clauses.push_back(C);
+  };
+  AddClause(OMPC_shared, DSA.Shared);
+  AddClause(OMPC_firstprivate, DSA.Firstprivate);
+  AddClause(OMPC_private, DSA.Private);
+  AddClause(OMPC_lastprivate, DSA.Lastprivate);
+  AddClause(OMPC_reduction, DSA.Reduction);
+
+  Stmt* Region = OMP.ActOnOpenMPRegionEnd(Loop, Clauses).get();
+  OpenMPDirectiveKind CancelRegion = OMPD_unknown;
+  Stmt* Res = OMP.ActOnOpenMPExecutableDirective(OMPD_parallel_for, DirName,
+                                                 CancelRegion, Clauses, Region,
+                                                 BeginLoc, EndLoc)
+                  .get();
+  OMP.EndOpenMPDSABlock(Res);
+  return Res;
+}
+} // namespace
+
+bool ReverseModeVisitor::shouldUseOMPAtomicOps(Expr* E) {
+  if (!m_OMPRegion)
+    return false;
+  E = E->IgnoreParenImpCasts();
+  if (auto* DRE = dyn_cast<DeclRefExpr>(E)) {
+    auto* VD = dyn_cast<VarDecl>(DRE->getDecl());
+    if (!VD || VD->getType()->isReferenceType())
+      return true;
+    // The private copies of the adjoint are summed by a reduction clause, or
+    // the adjoint is private to the iteration.
+    m_OMPRegion->ReducedAdjoints.insert(VD);
+    return false;
+  }
+  // The iteration `i` is the only one updating `_d_x[i]`.
+  if (const auto* ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+    const auto* Idx =
+        dyn_cast<DeclRefExpr>(ASE->getIdx()->IgnoreParenImpCasts());
+    if (Idx && Idx->getDecl() == m_OMPRegion->LoopVar &&
+        isa<DeclRefExpr>(ASE->getBase()->IgnoreParenImpCasts()))
+      return false;
+  }
+  return true;
+}
+
+Expr* ReverseModeVisitor::BuildCallToAtomicAdd(Expr* LHS, Expr* RHS) {
+  Expr* Ptr = nullptr;
+  auto* UO = dyn_cast<UnaryOperator>(LHS->IgnoreParens());
+  if (UO && UO->getOpcode() == UO_Deref)
+    Ptr = UO->getSubExpr()->IgnoreImplicit();
+  else
+    Ptr = BuildOp(UO_AddrOf, LHS);
+  llvm::SmallVector<Expr*, 2> Args = {Ptr, RHS};
+  return GetFunctionCall("atomic_add", "clad", Args);
+}
+
+StmtDiff ReverseModeVisitor::DifferentiateOMPLoopBody(const Stmt* body) {
+  // The iterations run concurrently, thus nothing is pushed to a tape. The
+  // values stored by an iteration are kept in the copies of its thread.
+  llvm::SaveAndRestore<bool> SaveIsInsideLoop(isInsideLoop, false);
+  llvm::SaveAndRestore<bool> SaveCP(m_IsInsideCheckpointedLoop, true);
+  m_LoopBlock.emplace_back();
+  StmtDiff bodyDiff = nullptr;
+  beginBlock(direction::forward);
+  if (isa<CompoundStmt>(body)) {
+    bodyDiff = Visit(body);
+    for (Stmt* S : cast<CompoundStmt>(bodyDiff.getStmt())->body())
+      addToCurrentBlock(S);
+  } else {
+    beginScope(Scope::DeclScope);
+    bodyDiff = DifferentiateSingleStmt(body, /*dfdS=*/nullptr);
+    addToCurrentBlock(bodyDiff.getStmt());
+    endScope();
+  }
+  bodyDiff.updateStmt(endBlock(direction::forward));
+  Stmts revLoopBlock = m_LoopBlock.back();
+  utils::AppendIndividualStmts(revLoopBlock, bodyDiff.getStmt_dx());
+  m_LoopBlock.pop_back();
+  bodyDiff.updateStmtDx(revLoopBlock.empty() ? nullptr
+                                             : MakeCompoundStmt(revLoopBlock));
+  return bodyDiff;
+}
+
+/// The forward pass runs the differentiated iterations in parallel. The
+/// reverse pass is a parallel loop over the same iterations, every iteration
+/// recomputing its forward pass and running its reverse pass right after, so
+/// that the values it stores stay private to the thread running it:
+/// ```
+/// #pragma omp parallel for reduction(+: total)
+/// for (i = 0; i < n; ++i)
+///   total += x[i] * scale;
+/// ```
+/// is differentiated to
+/// ```
+/// #pragma omp parallel for reduction(+: total)
+/// for (i = 0; i < n; ++i)
+///   total += x[i] * scale;
+/// ...
+/// #pragma omp parallel for firstprivate(total,_d_total) reduction(+: _acc0)
+/// for (i = 0; i < n; ++i) {
+///   total += x[i] * scale;
+///   _d_x[i] += _d_total * scale;
+///   _acc0 += x[i] * _d_total;
+/// }
+/// *_d_scale += _acc0;
+/// ```
+/// The adjoints of the variables shared by the iterations are combined by a
+/// reduction clause. So are the adjoints which all iterations update, such as
+/// `*_d_scale`, through a private accumulator. The other shared adjoints are
+/// updated atomically unless the iteration `i` updates the element `i` only.
+/// The loops whose iterations overwrite the shared memory they read, e.g.
+/// `x[i] = x[i] * x[i]`, are differentiated sequentially, storing the values
+/// they overwrite.
+StmtDiff ReverseModeVisitor::VisitOMPParallelForDirective(
+    const OMPParallelForDirective* D) {
+  const Stmt* Associated =
+      D->getInnermostCapturedStmt()->getCapturedStmt()->IgnoreContainers(
+          /*IgnoreCaptured=*/true);
+  const auto* FS = dyn_cast<ForStmt>(Associated);
+  if (!FS || FS->getConditionVariable() || !FS->getCond() || !FS->getInc() ||
+      ContinuesLoop(FS->getBody())) {
+    diag(DiagnosticsEngine::Warning, D->getBeginLoc(),
+         "only canonical loops without 'continue' are supported in the "
+         "reverse mode of 'omp parallel for'");
+    return VisitStmt(D);
+  }
+  if (OverwritesSharedInputs(D, FS)) {
+    diag(DiagnosticsEngine::Warning, D->getBeginLoc(),
+         "the iterations of 'omp parallel for' overwrite shared memory they "
+         "read, the loop is differentiated as a sequential loop");
+    return Visit(FS);
+  }
+
+  // Maps the clauses of the loop to the ones of the forward and the reverse
+  // pass. The reduction variables are recomputed on a private copy by the
+  // reverse pass, their adjoints are read by every iteration. The adjoints of
+  // the private variables start from zero in every thread.
+  OMPDataSharing ForwardDSA, ReverseDSA;
+  llvm::SmallVector<Expr*, 8> Adjoints;
+  auto GetAdjointVar = [this](const Expr* Var) -> Expr* {
+    Expr* Adjoint = Visit(Var).getExpr_dx();
+    if (Adjoint && isa<DeclRefExpr>(Adjoint->IgnoreParenImpCasts()))
+      return Clone(Adjoint);
+    return nullptr;
+  };
+  for (const OMPClause* C : D->clauses()) {
+    if (const auto* PC = dyn_cast<OMPPrivateClause>(C)) {
+      for (const Expr* Var : CLAD_COMPAT_CLANG20_getvarlist(PC)) {
+        ForwardDSA.Private.push_back(Visit(Var).getExpr());
+        ReverseDSA.Private.push_back(Visit(Var).getExpr());
+        if (Expr* Adjoint = GetAdjointVar(Var))
+          Adjoints.push_back(Adjoint);
+      }
+    } else if (const auto* FPC = dyn_cast<OMPFirstprivateClause>(C)) {
+      for (const Expr* Var : CLAD_COMPAT_CLANG20_getvarlist(FPC)) {
+        ForwardDSA.Firstprivate.push_back(Visit(Var).getExpr());
+        ReverseDSA.Firstprivate.push_back(Visit(Var).getExpr());
+      }
+    } else if (const auto* LPC = dyn_cast<OMPLastprivateClause>(C)) {
+      // The adjoint of the value of the last iteration is read by every
+      // iteration and only the last one uses it.
+      for (const Expr* Var : CLAD_COMPAT_CLANG20_getvarlist(LPC)) {
+        ForwardDSA.Lastprivate.push_back(Visit(Var).getExpr());
+        ReverseDSA.Private.push_back(Visit(Var).getExpr());
+        if (Expr* Adjoint = GetAdjointVar(Var))
+          Adjoints.push_back(Adjoint);
+      }
+    } else if (const auto* SC = dyn_cast<OMPSharedClause>(C)) {
+      for (const Expr* Var : CLAD_COMPAT_CLANG20_getvarlist(SC)) {
+        ForwardDSA.Shared.push_back(Visit(Var).getExpr());
+        ReverseDSA.Shared.push_back(Visit(Var).getExpr());
+      }
+    } else if (const auto* RC = dyn_cast<OMPReductionClause>(C)) {
+      if (RC->getNameInfo().getName().getCXXOverloadedOperator() != OO_Plus)
+        diag(DiagnosticsEngine::Warning, RC->getBeginLoc(),
+             "only 'reduction(+: ...)' is supported in the reverse mode of "
+             "'omp parallel for'");
+      ForwardDSA.ReductionId = RC->getNameInfo();
+      for (const Expr* Var : CLAD_COMPAT_CLANG20_getvarlist(RC)) {
+        ForwardDSA.Reduction.push_back(Visit(Var).getExpr());
+        ReverseDSA.Firstprivate.push_back(Visit(Var).getExpr());
+        if (Expr* Adjoint = GetAdjointVar(Var))
+          Adjoints.push_back(Adjoint);
+      }
+    } else {
+      diag(DiagnosticsEngine::Warning, C->getBeginLoc(),
+           "clause is ignored in the reverse mode of 'omp parallel for'");
+    }
+  }
+
+  // The reverse pass is built first: its iterations are differentiated once
+  // and the forward pass runs a copy of their forward part. The variables
+  // declared by the loop are moved to the function scope, every thread works
+  // on copies of them.
+  OMPRegion Region;
+  Stmt* Init = nullptr;
+  StmtDiff Cond, Inc;
+  Stmt* ForwardBody = nullptr;
+  llvm::SmallVector<Expr*, 8> Globals;
+  auto IsAccumulator = [&Region](const VarDecl* VD) {
+    return llvm::any_of(Region.Privatized, [VD](const PrivatizedAdjoint& A) {
+      return A.Private == VD;
+    });
+  };
+  llvm::SmallPtrSet<const VarDecl*, 16> RegionVars;
+  auto BuildReverseLoop = [&]() -> Stmt* {
+    std::size_t NumGlobals = m_Globals.size();
+    beginScope(Scope::DeclScope | Scope::ControlScope | Scope::BreakScope |
+               Scope::ContinueScope);
+    Init = DifferentiateSingleStmt(FS->getInit()).getStmt();
+    Region.LoopVar = GetLoopVar(Init);
+    StmtDiff Unused;
+    std::tie(Unused, Cond) = DifferentiateSingleExpr(FS->getCond());
+    std::tie(Unused, Inc) = DifferentiateSingleExpr(FS->getInc());
+    StmtDiff BodyDiff = DifferentiateOMPLoopBody(FS->getBody());
+    endScope();
+    ForwardBody = BodyDiff.getStmt();
+    CollectDeclaredVars(BodyDiff.getStmt(), RegionVars);
+    CollectDeclaredVars(BodyDiff.getStmt_dx(), RegionVars);
+    for (std::size_t i = NumGlobals; i < m_Globals.size(); ++i)
+      if (auto* DS = dyn_cast<DeclStmt>(m_Globals[i]))
+        for (Decl* Dcl : DS->decls())
+          if (auto* VD = dyn_cast<VarDecl>(Dcl))
+            if (VD != Region.LoopVar && !IsAccumulator(VD))
+              Globals.push_back(BuildDeclRef(VD));
+    Stmts Body;
+    utils::AppendIndividualStmts(Body, BodyDiff.getStmt());
+    utils::AppendIndividualStmts(Body, BodyDiff.getStmt_dx());
+    return new (m_Context)
+        ForStmt(m_Context, Init, Cond.getExpr(), /*condVar=*/nullptr,
+                Inc.getExpr(), MakeCompoundStmt(Body), noLoc, noLoc, noLoc);
+  };
+
+  Stmt* Reverse = nullptr;
+  {
+    llvm::SaveAndRestore<OMPRegion*> SaveRegion(m_OMPRegion, &Region);
+    Reverse = BuildParallelFor(
+        m_Sema, getCurrentScope(), D->getBeginLoc(), D->getEndLoc(),
+        BuildReverseLoop, [&](OMPDataSharing& DSA) {
+          DSA = ReverseDSA;
+          DSA.Firstprivate.append(Adjoints.begin(), Adjoints.end());
+          DSA.Firstprivate.append(Globals.begin(), Globals.end());
+          // Sum the private copies of the other adjoints incremented by the
+          // iterations.
+          llvm::SmallPtrSet<const Decl*, 16> Listed;
+          for (const auto* Vars : {&DSA.Private, &DSA.Firstprivate})
+            for (Expr* Var : *Vars)
+              if (auto* DRE = dyn_cast<DeclRefExpr>(Var->IgnoreParenImpCasts()))
+                Listed.insert(DRE->getDecl());
+          for (VarDecl* VD : Region.ReducedAdjoints)
+            if (VD != Region.LoopVar && !RegionVars.count(VD) &&
+                !Listed.count(VD))
+              DSA.Reduction.push_back(BuildDeclRef(VD));
+          for (const PrivatizedAdjoint& A : Region.Privatized)
+            DSA.Reduction.push_back(BuildDeclRef(A.Private));
+        });
+  }
+
+  Stmt* Forward = BuildParallelFor(
+      m_Sema, getCurrentScope(), D->getBeginLoc(), D->getEndLoc(),
+      [&]() -> Stmt* {
+        return new (m_Context)
+            ForStmt(m_Context, Clone(Init), Clone(Cond.getExpr()),
+                    /*condVar=*/nullptr, Clone(Inc.getExpr()),
+                    Clone(ForwardBody), noLoc, noLoc, noLoc);
+      },
+      [&](OMPDataSharing& DSA) {
+        DSA = ForwardDSA;
+        DSA.Firstprivate.append(Globals.begin(), Globals.end());
+      });
+  if (Region.Privatized.empty())
+    return {Forward, Reverse};
+
+  // Add the sums of the private accumulators to the shared adjoints.
+  beginBlock(direction::reverse);
+  if (isInsideLoop)
+    for (const PrivatizedAdjoint& A : Region.Privatized)
+      addToCurrentBlock(BuildOp(BO_Assign, BuildDeclRef(A.Private),
+                                getZeroInit(A.Private->getType())),
+                        direction::reverse);
+  addToCurrentBlock(Reverse, direction::reverse);
+  for (const PrivatizedAdjoint& A : Region.Privatized)
+    addToCurrentBlock(
+        BuildOp(BO_AddAssign, Clone(A.Shared), BuildDeclRef(A.Private)),
+        direction::reverse);
+  return {Forward, endBlock(direction::reverse)};
+}
+} // namespace clad
@@ -11,6 +11,8 @@
 
 #include "llvm/Support/SaveAndRestore.h"
 
+#include <algorithm>
+
 using namespace clang;
 
 namespace clad {
@@ -72,18 +74,37 @@ DerivativeAndOverload VectorForwardModeVisitor::Derive() {
       clad_compat::makeArrayRef(params.data(), params.size()));
   vectorDiffFD->setBody(nullptr);
 
+  // The number of independent variables is a compile-time constant if none
+  // of them is an array, in which case fixed-size direction vectors can be
+  // used if requested.
+  if (m_DiffReq.StaticDirections) {
+    m_StaticDirections =
+        std::none_of(m_IndependentVars.begin(), m_IndependentVars.end(),
+                     [](const ValueDecl* VD) {
+                       return utils::isArrayOrPointerType(VD->getType());
+                     });
+    if (!m_StaticDirections)
+      diag(DiagnosticsEngine::Warning, loc,
+           "fixed-size direction vectors are not supported for array "
+           "independent variables, falling back to clad::array")
+          << loc;
+  }
+
   // Create the body of the derivative.
   beginScope(Scope::FnScope | Scope::DeclScope);
   m_DerivativeFnScope = getCurrentScope();
   beginBlock();
 
   // Instantiate a variable indepVarCount to store the total number of
-  // independent variables requested.
+  // independent variables requested. It is not needed by fixed-size direction
+  // vectors, which carry their size in their type.
   // size_t indepVarCount = m_IndVarCountExpr;
-  auto* totalIndVars = BuildVarDecl(m_Context.UnsignedLongTy, "indepVarCount",
-                                    m_IndVarCountExpr);
-  addToCurrentBlock(BuildDeclStmt(totalIndVars));
-  m_IndVarCountExpr = BuildDeclRef(totalIndVars);
+  if (!m_StaticDirections) {
+    auto* totalIndVars = BuildVarDecl(m_Context.UnsignedLongTy,
+                                      "indepVarCount", m_IndVarCountExpr);
+    addToCurrentBlock(BuildDeclStmt(totalIndVars));
+    m_IndVarCountExpr = BuildDeclRef(totalIndVars);
+  }
 
   // Expression for maintaining the number of independent variables processed
   // till now present as array elements. This will be sum of sizes of all such
@@ -137,9 +158,7 @@ DerivativeAndOverload VectorForwardModeVisitor::Derive() {
         }
       } else {
         // Create a one hot vector for the parameter.
-        llvm::SmallVector<Expr*, 2> args = {m_IndVarCountExpr, offsetExpr};
-        dVectorParam = BuildCallExprToCladFunction("one_hot_vector", args,
-                                                   {dParamType}, loc);
+        dVectorParam = BuildOneHotDirectionVector(dParamType, offsetExpr, loc);
         ++nonArrayIndVarCount;
       }
       ++independentVarIndex;
@@ -150,8 +169,7 @@ DerivativeAndOverload VectorForwardModeVisitor::Derive() {
         continue;
       // This parameter is not an independent variable.
       // Initialize by all zeros.
-      dVectorParam = BuildCallExprToCladFunction(
-          "zero_vector", {m_IndVarCountExpr}, {dParamType}, loc);
+      dVectorParam = BuildZeroDirectionVector(dParamType, loc);
     }
 
     // For each function arg to be differentiated, create a variable
@@ -165,7 +183,7 @@ DerivativeAndOverload VectorForwardModeVisitor::Derive() {
     if (is_array)
       dVectorParamType = utils::GetCladMatrixOfType(m_Sema, dParamType);
     else
-      dVectorParamType = utils::GetCladArrayOfType(m_Sema, dParamType);
+      dVectorParamType = GetDirectionVectorType(dParamType);
     auto dVectorParamDecl =
         BuildVarDecl(dVectorParamType, "_d_vector_" + param->getNameAsString(),
                      dVectorParam);
@@ -449,7 +467,7 @@ StmtDiff VectorForwardModeVisitor::VisitReturnStmt(const ReturnStmt* RS) {
   // If we are in vector mode, we need to wrap the return value in a
   // vector.
   QualType cladArrayType =
-      utils::GetCladArrayOfType(m_Sema, utils::GetNonConstValueType(retType));
+      GetDirectionVectorType(utils::GetNonConstValueType(retType));
   VarDecl* dVectorParamDecl = BuildVarDecl(cladArrayType, "_d_vector_return",
                                            derivedRetValE, /*DirectInit=*/true);
   // Create an array of statements to hold the return statement and the
@@ -527,11 +545,10 @@ VectorForwardModeVisitor::DifferentiateVarDecl(const VarDecl* VD) {
   // This may not necessarily be true in the future.
   VarDecl* VDClone = BuildVarDecl(VD->getType(), VD->getNameAsString(),
                                   initDiff.getExpr(), VD->isDirectInit());
-  VarDecl* VDDerived =
-      BuildVarDecl(utils::GetCladArrayOfType(
-                       m_Sema, utils::GetNonConstValueType(VD->getType())),
-                   "_d_vector_" + VD->getNameAsString(), initDiff.getExpr_dx(),
-                   /*DirectInit=*/true);
+  VarDecl* VDDerived = BuildVarDecl(
+      GetDirectionVectorType(utils::GetNonConstValueType(VD->getType())),
+      "_d_vector_" + VD->getNameAsString(), initDiff.getExpr_dx(),
+      /*DirectInit=*/true);
 
   m_Variables.emplace(VDClone, BuildDeclRef(VDDerived));
   return DeclDiff<VarDecl>(VDClone, VDDerived);
@@ -540,17 +557,48 @@ VectorForwardModeVisitor::DifferentiateVarDecl(const VarDecl* VD) {
 StmtDiff VectorForwardModeVisitor::VisitFloatingLiteral(
     const clang::FloatingLiteral* FL) {
   SourceLocation fakeLoc = utils::GetValidSLoc(m_Sema);
-  auto* zero_vec = BuildCallExprToCladFunction(
-      "zero_vector", {m_IndVarCountExpr}, {FL->getType()}, fakeLoc);
+  auto* zero_vec = BuildZeroDirectionVector(FL->getType(), fakeLoc);
   return StmtDiff(Clone(FL), zero_vec);
 }
 
 StmtDiff
 VectorForwardModeVisitor::VisitIntegerLiteral(const clang::IntegerLiteral* IL) {
   SourceLocation fakeLoc = utils::GetValidSLoc(m_Sema);
-  auto* zero_vec = BuildCallExprToCladFunction(
-      "zero_vector", {m_IndVarCountExpr}, {IL->getType()}, fakeLoc);
+  auto* zero_vec = BuildZeroDirectionVector(IL->getType(), fakeLoc);
   return StmtDiff(Clone(IL), zero_vec);
 }
 
+QualType VectorForwardModeVisitor::GetDirectionVectorType(QualType T) {
+  if (m_StaticDirections)
+    return utils::GetCladStaticArrayOfType(m_Sema, T,
+                                           m_IndependentVars.size());
+  return utils::GetCladArrayOfType(m_Sema, T);
+}
+
+Expr* VectorForwardModeVisitor::BuildZeroDirectionVector(QualType T,
+                                                         SourceLocation loc) {
+  if (!m_StaticDirections)
+    return BuildCallExprToCladFunction("zero_vector", {m_IndVarCountExpr}, {T},
+                                       loc);
+  // clad::static_zero_vector<T, N>()
+  TemplateArgument templateArgs[] = {
+      T, utils::GetSizeTemplateArgument(m_Context, m_IndependentVars.size())};
+  return BuildCallExprToCladFunction("static_zero_vector", {}, templateArgs,
+                                     loc);
+}
+
+Expr* VectorForwardModeVisitor::BuildOneHotDirectionVector(QualType T,
+                                                           Expr* offset,
+                                                           SourceLocation loc) {
+  if (!m_StaticDirections) {
+    llvm::SmallVector<Expr*, 2> args = {m_IndVarCountExpr, offset};
+    return BuildCallExprToCladFunction("one_hot_vector", args, {T}, loc);
+  }
+  // clad::static_one_hot_vector<T, N>(offset)
+  TemplateArgument templateArgs[] = {
+      T, utils::GetSizeTemplateArgument(m_Context, m_IndependentVars.size())};
+  return BuildCallExprToCladFunction("static_one_hot_vector", offset,
+                                     templateArgs, loc);
+}
+
 } // namespace clad
@@ -20,6 +20,7 @@
 #include "clang/AST/Attrs.inc"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/OperationKinds.h"
@@ -27,6 +28,7 @@
 #include "clang/AST/TemplateBase.h"
 #include "clang/Basic/OperatorKinds.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Overload.h"
@@ -752,6 +754,77 @@ namespace clad {
            QT.getAsString().find("clad::array_ref") != std::string::npos;
   }
 
+  Expr* VisitorBase::BuildComplexStepTarget(Expr* targetFuncCall) {
+    if (!m_Sema.getPreprocessor().isMacroDefined("CLAD_NUM_DIFF_COMPLEX_STEP"))
+      return targetFuncCall;
+    const auto* DRE =
+        dyn_cast<DeclRefExpr>(targetFuncCall->IgnoreParenImpCasts());
+    const auto* FD = DRE ? dyn_cast<FunctionDecl>(DRE->getDecl()) : nullptr;
+    if (!FD || isa<CXXMethodDecl>(FD) || !FD->getPrimaryTemplate())
+      return targetFuncCall;
+
+    NamespaceDecl* StdNS =
+        utils::LookupNSD(m_Sema, "std", /*shouldExist=*/false);
+    if (!StdNS)
+      return targetFuncCall;
+    LookupResult R(m_Sema, &m_Context.Idents.get("complex"), noLoc,
+                   Sema::LookupOrdinaryName);
+    m_Sema.LookupQualifiedName(R, StdNS);
+    auto* complexDecl = R.isSingleResult()
+                            ? dyn_cast<ClassTemplateDecl>(R.getFoundDecl())
+                            : nullptr;
+    if (!complexDecl)
+      return targetFuncCall;
+
+    // Replace the floating-point type arguments of the specialization by
+    // complex numbers, e.g. g<double> by g<std::complex<double>>.
+    llvm::SmallVector<TemplateArgument, 4> complexArgs;
+    bool hasComplexArg = false;
+    for (const TemplateArgument& arg :
+         FD->getTemplateSpecializationArgs()->asArray()) {
+      if (arg.getKind() != TemplateArgument::Type ||
+          !arg.getAsType()->isRealFloatingType()) {
+        complexArgs.push_back(arg);
+        continue;
+      }
+      QualType T = arg.getAsType().getCanonicalType();
+      complexArgs.push_back(
+          utils::InstantiateTemplate(m_Sema, complexDecl, {T}));
+      hasComplexArg = true;
+    }
+    if (!hasComplexArg)
+      return targetFuncCall;
+#if CLANG_VERSION_MAJOR < 19
+    clang::TemplateArgumentList TL(TemplateArgumentList::OnStack,
+                                   complexArgs);
+#else
+    auto& TL = *TemplateArgumentList::CreateCopy(m_Context, complexArgs);
+#endif
+    FunctionDecl* complexFD = nullptr;
+    {
+      // The declaration may not be valid for complex numbers, e.g. if the
+      // template is constrained to floating-point types.
+      Sema::SFINAETrap Trap(m_Sema);
+      complexFD = m_Sema.InstantiateFunctionDeclaration(
+          FD->getPrimaryTemplate(), &TL, noLoc);
+      if (Trap.hasErrorOccurred())
+        complexFD = nullptr;
+    }
+    if (!complexFD)
+      return targetFuncCall;
+
+    // numerical_diff::make_complex_step_target(g<double>,
+    //                                          g<std::complex<double>>)
+    llvm::SmallVector<Expr*, 2> args = {targetFuncCall,
+                                        BuildDeclRef(complexFD)};
+    Expr* target = m_Builder.BuildCallToCustomDerivativeOrNumericalDiff(
+        "make_complex_step_target", args, getCurrentScope(),
+        /*callSite=*/nullptr,
+        /*forCustomDerv=*/false,
+        /*namespaceShouldExist=*/false);
+    return target ? target : targetFuncCall;
+  }
+
   Expr* VisitorBase::GetSingleArgCentralDiffCall(
       Expr* targetFuncCall, Expr* targetArg, unsigned targetPos,
       unsigned numArgs, llvm::SmallVectorImpl<Expr*>& args,
@@ -763,6 +836,8 @@ namespace clad {
       return nullptr;
     // Build function args.
     llvm::SmallVector<Expr*, 16U> NumDiffArgs;
+    if (!CUDAExecConfig)
+      targetFuncCall = BuildComplexStepTarget(targetFuncCall);
     NumDiffArgs.push_back(targetFuncCall);
     NumDiffArgs.push_back(targetArg);
     NumDiffArgs.push_back(ConstantFolder::synthesizeLiteral(m_Context.IntTy,
@@ -802,6 +877,58 @@ namespace clad {
     return newPVD;
   }
 
+  FunctionDecl* VisitorBase::BeginDerivedFunction(
+      const std::string& name, DeclContext* DC, QualType FnTy,
+      llvm::ArrayRef<llvm::StringRef> extraParams,
+      llvm::SmallVectorImpl<ParmVarDecl*>& params) {
+    const FunctionDecl* FD = m_DiffReq.Function;
+    IdentifierInfo* II = &m_Context.Idents.get(name);
+    DeclarationNameInfo nameInfo(II, noLoc);
+    m_Sema.CurContext = DC;
+    DeclWithContext result =
+        m_Builder.cloneFunction(FD, *this, DC, noLoc, nameInfo, FnTy);
+    FunctionDecl* derivedFD = result.first;
+
+    beginScope(Scope::FunctionPrototypeScope |
+               Scope::FunctionDeclarationScope | Scope::DeclScope);
+    m_Sema.PushFunctionScope();
+    m_Sema.PushDeclContext(getCurrentScope(), derivedFD);
+
+    for (const ParmVarDecl* PVD : FD->parameters())
+      params.push_back(CloneParmVarDecl(PVD, PVD->getIdentifier(),
+                                        /*pushOnScopeChains=*/true,
+                                        /*cloneDefaultArg=*/false));
+    llvm::ArrayRef<QualType> paramTypes =
+        cast<FunctionProtoType>(FnTy)->getParamTypes();
+    size_t firstExtraParam = paramTypes.size() - extraParams.size();
+    for (size_t i = 0, e = extraParams.size(); i < e; ++i) {
+      ParmVarDecl* PVD = utils::BuildParmVarDecl(
+          m_Sema, derivedFD, &m_Context.Idents.get(extraParams[i]),
+          paramTypes[firstExtraParam + i]);
+      m_Sema.PushOnScopeChains(PVD, getCurrentScope(),
+                               /*AddToContext=*/false);
+      params.push_back(PVD);
+    }
+    derivedFD->setParams(
+        clad_compat::makeArrayRef(params.data(), params.size()));
+
+    beginScope(Scope::FnScope | Scope::DeclScope);
+    m_DerivativeFnScope = getCurrentScope();
+    beginBlock();
+    return derivedFD;
+  }
+
+  DerivativeAndOverload
+  VisitorBase::EndDerivedFunction(FunctionDecl* derivedFD) {
+    derivedFD->setBody(endBlock());
+    endScope(); // Function body scope
+    m_Sema.PopFunctionScopeInfo();
+    m_Sema.PopDeclContext();
+    endScope(); // Function decl scope
+
+    return DerivativeAndOverload{derivedFD, /*OverloadFunctionDecl=*/nullptr};
+  }
+
   QualType VisitorBase::DetermineCladArrayValueType(clang::QualType T) {
     assert(isCladArrayType(T) && "Not a clad::array or clad::array_ref type");
     auto specialization =
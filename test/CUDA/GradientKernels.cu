@@ -214,6 +214,7 @@ __global__ void add_kernel_6(int *a, int *b) {
 }
 
 //CHECK: void add_kernel_6_grad(int *a, int *b, int *_d_a, int *_d_b) {
+//CHECK-NEXT:     int _acc0 = 0;
 //CHECK-NEXT:     int _d_index = 0;
 //CHECK-NEXT:     int index0 = threadIdx.x + blockIdx.x * blockDim.x;
 //CHECK-NEXT:     int _t0 = a[index0];
@@ -222,8 +223,9 @@ __global__ void add_kernel_6(int *a, int *b) {
 //CHECK-NEXT:         a[index0] = _t0;
 //CHECK-NEXT:         int _r_d0 = _d_a[index0];
 //CHECK-NEXT:         _d_a[index0] = 0;
-//CHECK-NEXT:         atomicAdd(_d_b, _r_d0);
+//CHECK-NEXT:         _acc0 += _r_d0;
 //CHECK-NEXT:     }
+//CHECK-NEXT:     clad::block_atomic_add(_d_b, _acc0);
 //CHECK-NEXT: }
 
 __global__ void add_kernel_7(double *a, double *b) {
@@ -233,6 +235,7 @@ __global__ void add_kernel_7(double *a, double *b) {
 }
 
 // CHECK: void add_kernel_7_grad(double *a, double *b, double *_d_a, double *_d_b) {
+// CHECK-NEXT:     double _acc0 = 0.;
 // CHECK-NEXT:     int _d_index = 0;
 // CHECK-NEXT:     int index0 = threadIdx.x + blockIdx.x * blockDim.x;
 // CHECK-NEXT:     double _t0 = a[2 * index0];
@@ -243,14 +246,15 @@ __global__ void add_kernel_7(double *a, double *b) {
 // CHECK-NEXT:         a[2 * index0 + 1] = _t1;
 // CHECK-NEXT:         double _r_d1 = _d_a[2 * index0 + 1];
 // CHECK-NEXT:         _d_a[2 * index0 + 1] = 0.;
-// CHECK-NEXT:         atomicAdd(&_d_b[0], _r_d1);
+// CHECK-NEXT:         _acc0 += _r_d1;
 // CHECK-NEXT:     }
 // CHECK-NEXT:     {
 // CHECK-NEXT:         a[2 * index0] = _t0;
 // CHECK-NEXT:         double _r_d0 = _d_a[2 * index0];
 // CHECK-NEXT:         _d_a[2 * index0] = 0.;
-// CHECK-NEXT:         atomicAdd(&_d_b[0], _r_d0);
+// CHECK-NEXT:         _acc0 += _r_d0;
 // CHECK-NEXT:     }
+// CHECK-NEXT:     clad::block_atomic_add(&_d_b[0], _acc0);
 // CHECK-NEXT: }
 
 __device__ double device_fn(const double in, double val) {
@@ -270,6 +274,7 @@ __global__ void kernel_with_device_call(double *out, const double *in, double va
 //CHECK-NEXT:}
 
 // CHECK: void kernel_with_device_call_grad_0_2(double *out, const double *in, double val, double *_d_out, double *_d_val) {
+//CHECK-NEXT:    double _acc0 = 0.;
 //CHECK-NEXT:    int _d_index = 0;
 //CHECK-NEXT:    int index0 = threadIdx.x;
 //CHECK-NEXT:    double _t0 = out[index0];
@@ -281,8 +286,9 @@ __global__ void kernel_with_device_call(double *out, const double *in, double va
 //CHECK-NEXT:        double _r0 = 0.;
 //CHECK-NEXT:        double _r1 = 0.;
 //CHECK-NEXT:        device_fn_pullback_1(in[index0], val, _r_d0, &_r0, &_r1);
-//CHECK-NEXT:        atomicAdd(_d_val, _r1);
+//CHECK-NEXT:        _acc0 += _r1;
 //CHECK-NEXT:    }
+//CHECK-NEXT:    clad::block_atomic_add(_d_val, _acc0);
 //CHECK-NEXT:}
 
 __device__ double device_fn_2(const double *in, double val) {
@@ -307,6 +313,7 @@ __global__ void dup_kernel_with_device_call_2(double *out, const double *in, dou
 //CHECK-NEXT:}
 
 // CHECK: void kernel_with_device_call_2_grad_0_2(double *out, const double *in, double val, double *_d_out, double *_d_val) {
+//CHECK-NEXT:    double _acc0 = 0.;
 //CHECK-NEXT:    int _d_index = 0;
 //CHECK-NEXT:    int index0 = threadIdx.x;
 //CHECK-NEXT:    double _t0 = out[index0];
@@ -317,8 +324,9 @@ __global__ void dup_kernel_with_device_call_2(double *out, const double *in, dou
 //CHECK-NEXT:        _d_out[index0] = 0.;
 //CHECK-NEXT:        double _r0 = 0.;
 //CHECK-NEXT:        device_fn_2_pullback_1(in, val, _r_d0, &_r0);
-//CHECK-NEXT:        atomicAdd(_d_val, _r0);
+//CHECK-NEXT:        _acc0 += _r0;
 //CHECK-NEXT:    }
+//CHECK-NEXT:    clad::block_atomic_add(_d_val, _acc0);
 //CHECK-NEXT:}
 
 // CHECK: __attribute__((device)) void device_fn_2_pullback_0(const double *in, double val, double _d_y, double *_d_in, double *_d_val) {
@@ -432,6 +440,7 @@ __global__ void fn1(double *out, const double *in, double val) {
 }
 
 // CHECK: void fn1_grad_0_2(double *out, const double *in, double val, double *_d_out, double *_d_val) {
+// CHECK-NEXT:     double _acc0 = 0.;
 // CHECK-NEXT:     int _d_index = 0;
 // CHECK-NEXT:     int index0 = threadIdx.x + blockIdx.x * blockDim.x;
 // CHECK-NEXT:     double _d_temp = 0.;
@@ -447,7 +456,24 @@ __global__ void fn1(double *out, const double *in, double val) {
 // CHECK-NEXT:         device_fn_pullback_1(in[index0], temp, _r_d0, &_r0, &_r1);
 // CHECK-NEXT:         _d_temp += _r1;
 // CHECK-NEXT:     }
-// CHECK-NEXT:     atomicAdd(_d_val, _d_temp);
+// CHECK-NEXT:     _acc0 += _d_temp;
+// CHECK-NEXT:     clad::block_atomic_add(_d_val, _acc0);
+// CHECK-NEXT: }
+
+__global__ void scale_strided(double *out, const double *in, double *val, int N) {
+  int index = threadIdx.x + blockIdx.x * blockDim.x;
+  for (int i = index; i < N; i += blockDim.x * gridDim.x)
+    out[i] = in[i] * *val;
+}
+
+// Every iteration updates `*_d_val`, which the thread accumulates privately
+// and the block reduces before a single atomicAdd.
+
+// CHECK: void scale_strided_grad_0_2(double *out, const double *in, double *val, int N, double *_d_out, double *_d_val) {
+// CHECK: double _acc0 = 0.;
+// CHECK: _acc0 += in[i] * {{.*}};
+// CHECK-NOT: atomicAdd(_d_val, in[i]
+// CHECK: clad::block_atomic_add(_d_val, _acc0);
 // CHECK-NEXT: }
 
 __global__ void kernel_call(double *a, double *b) {
@@ -712,6 +738,7 @@ __global__ void indices_lin_comb(int *out, int *in) {
 }
 
 // CHECK: void indices_lin_comb_grad(int *out, int *in, int *_d_out, int *_d_in) {
+// CHECK-NEXT:     int _acc0 = 0;
 // CHECK-NEXT:     int _d_index = 0;
 // CHECK-NEXT:     int index0 = threadIdx.x + blockIdx.x * blockDim.x;
 // CHECK-NEXT:     int _t0 = out[index0];
@@ -735,7 +762,7 @@ __global__ void indices_lin_comb(int *out, int *in) {
 // CHECK-NEXT:     {
 // CHECK-NEXT:         out[index0] = _t5;
 // CHECK-NEXT:         int _r_d4 = _d_out[index0];
-// CHECK-NEXT:         atomicAdd(&_d_in[1 + 1], _r_d4);
+// CHECK-NEXT:         _acc0 += _r_d4;
 // CHECK-NEXT:     }
 // CHECK-NEXT:     {
 // CHECK-NEXT:         out[index0] = _t3;
@@ -757,6 +784,7 @@ __global__ void indices_lin_comb(int *out, int *in) {
 // CHECK-NEXT:         int _r_d0 = _d_out[index0];
 // CHECK-NEXT:         _d_in[2 * index0] += _r_d0;
 // CHECK-NEXT:     }
+// CHECK-NEXT:     clad::block_atomic_add(&_d_in[1 + 1], _acc0);
 // CHECK-NEXT: }
 
 __device__ void device_injective_index(int *a) {
@@ -1118,6 +1146,13 @@ int main(void) {
 
   INIT(dummy_in_double, dummy_out_double, val, d_in_double, d_out_double, d_val);
 
+  auto privatized = clad::gradient(scale_strided, "out, val");
+  privatized.execute_kernel(dim3(1), dim3(5, 1, 1), dummy_out_double, dummy_in_double, val, 10, d_out_double, d_val);
+  cudaMemcpy(res, d_val, sizeof(double), cudaMemcpyDeviceToHost);
+  printf("%0.2f\n", *res); // CHECK-EXEC: 250.00
+
+  INIT(dummy_in_double, dummy_out_double, val, d_in_double, d_out_double, d_val);
+
   auto test_kernel_call = clad::gradient(fn);
   test_kernel_call.execute(dummy_out_double, dummy_in_double, d_out_double, d_in_double);
   cudaMemcpy(res, d_in_double, sizeof(double), cudaMemcpyDeviceToHost);
@@ -38,10 +38,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cstdlib>  // for getenv
 #include <iostream> // for std::cerr
+#include <map>
 #include <memory>
-#include <set>
 
 using namespace clang;
 
@@ -52,7 +53,9 @@ void InitTimers();
     /// Keeps track if we encountered #pragma clad on/off.
     // FIXME: Figure out how to make it a member of CladPlugin.
     std::vector<clang::SourceRange> CladEnabledRange;
-    std::set<clang::SourceLocation> CladLoopCheckpoints;
+    /// Maps the locations of #pragma clad checkpoint loop to their number of
+    /// snapshots, 0 if none were given.
+    std::map<clang::SourceLocation, unsigned> CladLoopCheckpoints;
 
     // Define a pragma handler for #pragma clad
     class CladPragmaHandler : public PragmaHandler {
@@ -101,7 +104,34 @@ void InitTimers();
                         "expected 'loop' after 'checkpoint' in #pragma clad"));
             return;
           }
-          CladLoopCheckpoints.insert(PragmaTok.getLocation());
+          SourceLocation LoopLoc = PragmaTok.getLocation();
+          // Handle the optional snapshots(N) clause
+          PP.Lex(PragmaTok);
+          uint64_t Snapshots = 0;
+          if (PragmaTok.isNot(tok::eod)) {
+            bool Valid = PragmaTok.is(tok::identifier) &&
+                         PragmaTok.getIdentifierInfo()->isStr("snapshots");
+            if (Valid) {
+              PP.Lex(PragmaTok);
+              Valid = PragmaTok.is(tok::l_paren);
+            }
+            if (Valid) {
+              PP.Lex(PragmaTok);
+              Valid = PragmaTok.is(tok::numeric_constant) &&
+                      PP.parseSimpleIntegerLiteral(PragmaTok, Snapshots) &&
+                      Snapshots > 0 && Snapshots <= UINT_MAX &&
+                      PragmaTok.is(tok::r_paren);
+            }
+            if (!Valid) {
+              PP.Diag(PragmaTok.getLocation(),
+                      PP.getDiagnostics().getCustomDiagID(
+                          DiagnosticsEngine::Error,
+                          "expected 'snapshots(N)' with a positive N after "
+                          "'loop' in #pragma clad"));
+              return;
+            }
+          }
+          CladLoopCheckpoints[LoopLoc] = Snapshots;
           return;
         }
         // Diagnose unknown clad pragma option
@@ -247,13 +277,16 @@ void InitTimers();
       auto it = CladLoopCheckpoints.upper_bound(begin);
       auto e = CladLoopCheckpoints.end();
 
-      for (; it != e && SM.isBeforeInTranslationUnit(*it, end); ++it)
-        request.m_CladLoopCheckpoints.emplace(*it, false);
+      for (; it != e && SM.isBeforeInTranslationUnit(it->first, end); ++it) {
+        LoopCheckpoint CP;
+        CP.Snapshots = it->second;
+        request.m_CladLoopCheckpoints.emplace(it->first, CP);
+      }
     }
 
     static void diagnoseUnusedPragma(Sema& S, DiffRequest& request) {
       for (const auto& pair : request.m_CladLoopCheckpoints) {
-        if (!pair.second) {
+        if (!pair.second.Used) {
           unsigned diagID = S.Diags.getCustomDiagID(
               DiagnosticsEngine::Error,
               "'#pragma clad checkpoint loop' is only allowed before a loop");
@@ -227,4 +227,90 @@ TEST(ParallelFor, FunctorSimplestCases) {
       parallel_for_functor_simplest_case_mdpol_space_and_anon, 0);
   for (double x = 3; x <= 5; x += 1)
     EXPECT_NEAR(df4.execute(x), 12, eps);
-}
\ No newline at end of file
+}
+
+template <typename View> struct Square {
+  View res;
+  View a;
+
+  Square(View _res, View _a) : res(_res), a(_a) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const { res(i) = a(i) * a(i); }
+};
+
+double parallel_for_functor_square_rangepol(double x) {
+  Kokkos::View<double[5], Kokkos::HostSpace> a("a");
+  Kokkos::View<double[5], Kokkos::HostSpace> res("res");
+  Kokkos::deep_copy(a, x);
+
+  Square<Kokkos::View<double[5], Kokkos::HostSpace>> f(res, a);
+
+  f(0); // FIXME: this is a workaround to put Square::operator() into the
+        // differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_for(
+      "square", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(1, 5),
+      f);
+  // Overwrite with another parallel_for (not named)
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(1, 5), f);
+
+  double sum = 0;
+  for (int i = 0; i < 5; ++i)
+    sum += res(i);
+  return sum;
+}
+
+TEST(ParallelFor, FunctorSimplestCasesReverse) {
+  const double eps = 1e-8;
+
+  // The squares of 5 cells holding x, the first one set by the workaround call.
+  auto df = clad::gradient(parallel_for_functor_square_rangepol);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df.execute(x, &dx);
+    EXPECT_NEAR(dx, 10 * x, eps);
+  }
+}
+
+template <typename View> struct Scale {
+  View res;
+  double x;
+
+  Scale(View _res, double _x) : res(_res), x(_x) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const { res(i) = x * i; }
+};
+
+// Every iteration updates the adjoint of the scalar member `x`.
+double parallel_for_functor_scalar_member(double x) {
+  Kokkos::View<double[1000], Kokkos::HostSpace> res("res");
+
+  Scale<Kokkos::View<double[1000], Kokkos::HostSpace>> f(res, x);
+
+  f(0); // FIXME: this is a workaround to put Scale::operator() into the
+        // differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_for(
+      "scale", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, 1000),
+      f);
+
+  double sum = 0;
+  for (int i = 0; i < 1000; ++i)
+    sum += res(i);
+  return sum;
+}
+
+TEST(ParallelFor, FunctorScalarMemberReverse) {
+  const double eps = 1e-8;
+
+  // The sum of x * i over [0, 1000).
+  auto df = clad::gradient(parallel_for_functor_scalar_member);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df.execute(x, &dx);
+    EXPECT_NEAR(dx, 499500, eps);
+  }
+}
@@ -179,4 +179,145 @@ TEST(ParallelReduce, FunctorSimplestCases) {
   auto df3 = clad::differentiate(parallel_MD_polynomial_reduce, 0);
   for (double x = 3; x <= 5; x += 1)
     EXPECT_NEAR(df3.execute(x), 100, eps);
-}
\ No newline at end of file
+}
+template <typename View> struct CellEnergy {
+  View c;
+
+  CellEnergy(View _c) : c(_c) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int& i, double& energy) const {
+    energy += c(i) * c(i);
+  }
+};
+
+double parallel_energy_reduce_intpol(double x) {
+  Kokkos::View<double[5], Kokkos::HostSpace> c("c");
+  Kokkos::deep_copy(c, x);
+
+  CellEnergy<Kokkos::View<double[5], Kokkos::HostSpace>> f(c);
+  double r = 0;
+
+  f(0, r); // FIXME: this is a workaround to put CellEnergy::operator() into
+           // the differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_reduce("energy", 5, f, r);
+
+  return r;
+}
+
+double parallel_energy_reduce_rangepol(double x) {
+  Kokkos::View<double[5], Kokkos::HostSpace> c("c");
+  Kokkos::deep_copy(c, x);
+
+  CellEnergy<Kokkos::View<double[5], Kokkos::HostSpace>> f(c);
+  double r = 0;
+
+  f(0, r); // FIXME: this is a workaround to put CellEnergy::operator() into
+           // the differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_reduce(
+      "energy", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(1, 5),
+      f, r);
+
+  return r;
+}
+
+template <typename View> struct CellEnergy2D {
+  View c;
+
+  CellEnergy2D(View _c) : c(_c) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int& i, const int& j, double& energy) const {
+    energy += c(i, j) * c(i, j);
+  }
+};
+
+double parallel_MD_energy_reduce(double x) {
+  Kokkos::View<double[5][5], Kokkos::HostSpace> c("c");
+  Kokkos::deep_copy(c, x);
+
+  CellEnergy2D<Kokkos::View<double[5][5], Kokkos::HostSpace>> f(c);
+  double r = 0;
+
+  f(0, 0, r); // FIXME: this is a workaround to put CellEnergy2D::operator()
+              // into the differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_reduce(
+      "energy",
+      Kokkos::MDRangePolicy<Kokkos::DefaultHostExecutionSpace,
+                            Kokkos::Rank<2>>({1, 1}, {5, 5}),
+      f, r);
+
+  return r;
+}
+
+TEST(ParallelReduce, FunctorSimplestCasesReverse) {
+  const double eps = 1e-8;
+
+  // The energy of 5 cells holding x.
+  auto df1 = clad::gradient(parallel_energy_reduce_intpol);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df1.execute(x, &dx);
+    EXPECT_NEAR(dx, 10 * x, eps);
+  }
+
+  // The energy of the cells [1, 5).
+  auto df2 = clad::gradient(parallel_energy_reduce_rangepol);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df2.execute(x, &dx);
+    EXPECT_NEAR(dx, 8 * x, eps);
+  }
+
+  // The energy of the cells [1, 5) x [1, 5).
+  auto df3 = clad::gradient(parallel_MD_energy_reduce);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df3.execute(x, &dx);
+    EXPECT_NEAR(dx, 32 * x, eps);
+  }
+}
+
+template <typename View> struct ScaledEnergy {
+  View c;
+  double scale;
+
+  ScaledEnergy(View _c, double _scale) : c(_c), scale(_scale) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int& i, double& energy) const {
+    energy += scale * c(i) * c(i);
+  }
+};
+
+// Every iteration updates the adjoint of the scalar member `scale`.
+double parallel_scaled_energy_reduce(double x) {
+  Kokkos::View<double[1000], Kokkos::HostSpace> c("c");
+  Kokkos::deep_copy(c, 2);
+
+  ScaledEnergy<Kokkos::View<double[1000], Kokkos::HostSpace>> f(c, x);
+  double r = 0;
+
+  f(0, r); // FIXME: this is a workaround to put ScaledEnergy::operator() into
+           // the differentiation plan. This needs to be solved in clad.
+
+  Kokkos::parallel_reduce(
+      "energy",
+      Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, 1000), f, r);
+
+  return r;
+}
+
+TEST(ParallelReduce, FunctorScalarMemberReverse) {
+  const double eps = 1e-8;
+
+  auto df = clad::gradient(parallel_scaled_energy_reduce);
+  for (double x = 3; x <= 5; x += 1) {
+    double dx = 0;
+    df.execute(x, &dx);
+    EXPECT_NEAR(dx, 4000, eps);
+  }
+}